@@ -51,15 +51,15 @@ int main()
 
         while(totalbytes < 1024)
         {          
-            uint8_t buffer[16];
-            size_t size = EchosounderReadData(snrctx, buffer, 16);
+            EchosounderDataView view;
+            size_t size = EchosounderPeekData(snrctx, &view);
 
             totalbytes += size;
 
-            for (int i = 0; i < size; i++)
-            {
-                putchar(buffer[i]);
-            }            
+            fwrite(view.first, 1, view.first_size, stdout);
+            fwrite(view.second, 1, view.second_size, stdout);
+
+            EchosounderConsumeData(snrctx, size);
         }
 
         printf("\nStop Echosounder\n");
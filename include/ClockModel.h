@@ -0,0 +1,88 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(CLOCKMODEL_H)
+#define CLOCKMODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "EchosounderNmea.h"
+
+/**
+    @class ClockModel
+
+    Relation between the host monotonic clock and the device UTC clock, estimated from ZDA
+    sentences: device time = host time + offset + drift * (host time - reference). Samples
+    are decimated to one per interval and a sliding window of them is fitted by least
+    squares, so the fit spans minutes and the 10 ms resolution of ZDA averages out. Offset
+    includes the transmission delay of the sentence.
+ */
+
+class ClockModel
+{
+public:
+
+    ClockModel();
+
+    /**
+    *   @brief Get host monotonic time used for all timestamps of the library
+    */
+    static int64_t MonotonicUs();
+
+    /**
+    *   @brief Convert UTC time and date of ZDA sentence to microseconds since the epoch
+    *   @return false - fields are out of range
+    */
+    static bool ZdaToUtcUs(const EchosounderNmeaZDA &Zda, int64_t &UtcUs);
+
+    /**
+    *   @brief Add ZDA sample received at HostUs, samples closer than the decimation interval are skipped
+    */
+    void AddSample(int64_t HostUs, int64_t DeviceUs);
+
+    /**
+    *   @brief Forget all samples, called when the device clock is set
+    */
+    void Reset();
+
+    /**
+    *   @brief Convert host monotonic time to device UTC time
+    *   @return false - no samples yet
+    */
+    bool ToDevice(int64_t HostUs, int64_t &DeviceUs) const;
+
+    /**
+    *   @brief Convert device UTC time to host monotonic time
+    *   @return false - no samples yet
+    */
+    bool ToHost(int64_t DeviceUs, int64_t &HostUs) const;
+
+    /**
+    *   @return false - no samples yet
+    */
+    bool GetState(EchosounderClockState &State) const;
+
+private:
+
+    struct Sample
+    {
+        int64_t host_us;
+        int64_t device_us;
+    };
+
+    mutable std::mutex mutex_;
+    std::deque<Sample> samples_;
+
+    /**
+    *   Fit of the window: offset at reference_us_ and drift
+    */
+    int64_t reference_us_;
+    double offset_us_;
+    double drift_;
+    double residual_us_;
+
+    void Fit();
+};
+
+#endif // CLOCKMODEL_H
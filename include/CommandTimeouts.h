@@ -0,0 +1,72 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(COMMANDTIMEOUTS_H)
+#define COMMANDTIMEOUTS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "EchosounderCommands.h"
+#include "EchosounderCommandTable.h"
+
+/**
+    @class CommandTimeouts
+
+    Timeout profile, one entry per command id. Defaults are estimated from the expected size of
+    the response and the baudrate: setting commands answer with a short "OK" while #info prints
+    a line per supported command, which takes seconds at low baudrates. Any entry can be
+    overridden at runtime, overridden entries are kept when the baudrate changes.
+ */
+
+class CommandTimeouts
+{
+public:
+
+    CommandTimeouts(const EchosounderCommandTable &CommandList);
+
+    /**
+    *   @brief Estimate time needed to receive a response of given size
+    *   @param Baudrate - port baudrate, 0 - not known, the slowest baudrate is assumed
+    *   @return milliseconds including processing time of the echosounder
+    */
+    static uint32_t Estimate(std::size_t ResponseBytes, uint32_t Baudrate);
+
+    /**
+    *   @brief Recalculate default timeouts for given baudrate
+    */
+    void SetBaudrate(uint32_t Baudrate);
+
+    /**
+    *   @brief Update expected response size of the command with the measured one
+    */
+    void SetResponseSize(EchosounderCommandIds Command, std::size_t ResponseBytes);
+
+    /**
+    *   @brief Override timeouts of the command, zero fields are set to the default
+    */
+    void Set(EchosounderCommandIds Command, const EchosounderTimeout &Timeout);
+
+    /**
+    *   @brief Return the command to the default timeouts
+    */
+    void Reset(EchosounderCommandIds Command);
+
+    /**
+    *   @brief Get timeouts of the command
+    */
+    const EchosounderTimeout &Get(EchosounderCommandIds Command) const;
+
+private:
+
+    void Update(std::size_t Index);
+
+    std::size_t response_bytes_[EchosounderCommandCount];
+
+    /**
+    *   Timeouts set by the user, zero fields use the default
+    */
+    EchosounderTimeout overrides_[EchosounderCommandCount];
+    EchosounderTimeout timeouts_[EchosounderCommandCount];
+    uint32_t baudrate_;
+};
+
+#endif // COMMANDTIMEOUTS_H
@@ -8,62 +8,70 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <regex>
 #include <map>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 
 #include "serial/serial.h"
+#include "ITransport.h"
 #include "EchosounderCommands.h"
-
-namespace
-{
-    std::map<int, EchosounderCommandList> SingleSonarCommands =
-    {
-        { EchosounderCommandIds::IdInfo,            { "#info",       "",      ""}},
-        { EchosounderCommandIds::IdRange,           { "#range",      "50000", " - #range[ ]{0,}\\[[ ]{0,}([0-9]{1,}) mm[ ]{0,}\\].*"}},
-        { EchosounderCommandIds::IdInterval,        { "#interval",   "0.1",   " - #interval[ ]{0,}\\[[ ]{0,}(([0-9]*[.])?[0-9]+) sec[ ]{0,}\\].*"}},
-        { EchosounderCommandIds::IdTxLength,        { "#txlength",   "50",    " - #txlength[ ]{0,}\\[[ ]{0,}([0-9]{1,}) uks[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdGain,            { "#gain",       "0.0",   " - #gain[ ]{0,}\\[[ ]{0,}([+-]?([0-9]*[.])?[0-9]+) dB[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdTVGMode,         { "#tvgmode",    "1",     " - #tvgmode[ ]{0,}\\[[ ]{0,}([0-4]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdTVGAbs,          { "#tvgabs",     "0.140", " - #tvgabs[ ]{0,}\\[[ ]{0,}([+-]?([0-9]*[.])?[0-9]+) dB\\/m[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdTVGSprd,         { "#tvgsprd",    "15.0",  " - #tvgsprd[ ]{0,}\\[[ ]{0,}([+-]?([0-9]*[.])?[0-9]+)[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdSound,           { "#sound",      "1500",  " - #sound[ ]{0,}\\[[ ]{0,}([0-9]{1,}) mps[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdDeadzone,        { "#deadzone",   "300",   " - #deadzone[ ]{0,}\\[[ ]{0,}([0-9]{1,}) mm[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdThreshold,       { "#threshold",  "10",    " - #threshold[ ]{0,}\\[[ ]{0,}([0-9]{1,}) %[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdOffset,          { "#offset",     "0",     " - #offset[ ]{0,}\\[[ ]{0,}([0-9]{1,}) mm[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdMedianFlt,       { "#medianflt",  "2",     " - #medianflt[ ]{0,}\\[[ ]{0,}([0-9]{1,3})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdSMAFlt,          { "#movavgflt",  "1",     " - #movavgflt[ ]{0,}\\[[ ]{0,}([0-9]{1,3})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdOutrate,         { "#nmearate",   "0.0",   " - #outrate[ ]{0,}\\[[ ]{0,}([+-]?([0-9]*[.])?[0-9]+) sec[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEADBT,         { "#nmeadbt",    "1",     " - #nmeadbt[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEADPT,         { "#nmeadpt",    "1",     " - #nmeadpt[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEADPTOffset,   { "#nmeadptoff", "0.0",   " - #nmeadptoff[ ]{0,}\\[[ ]{0,}([+-]?([0-9]*[.])?[0-9]+) m[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEADPTZero,     { "#nmeadpzero", "1",     " - #nmeadpzero[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEAMTW,         { "#nmeamtw",    "1",     " - #nmeamtw[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdAltprec,         { "#altprec",    "3",     " - #altprec[ ]{0,}\\[[ ]{0,}([1-4]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEAXDR,         { "#nmeaxdr",    "1",     " - #nmeaxdr[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEAEMA,         { "#nmeaema",    "1",     " - #nmeaema[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdNMEAZDA,         { "#nmeazda",    "0",     " - #nmeazda[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdOutput,          { "#output",     "3",     " - #output[ ]{0,}\\[[ ]{0,}([0-9]{1,})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdTime,            { "#time",       "0",     " - #time[ ]{0,}\\[[ ]{0,}([0-9]{1,})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdSyncExtern,      { "#syncextern", "0",     " - #syncextern[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdSyncExternMode,  { "#syncextmod", "1",     " - #syncextmod[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdSyncOutPolarity, { "#syncoutpol", "1",     " - #syncoutpol[ ]{0,}\\[[ ]{0,}([01]{1})[ ]{0,}\\].*" }},
-        { EchosounderCommandIds::IdVersion,         { "#version",    "",      " S\\/W Ver: ([0-9]{1,}[.][0-9]{1,}) .*" }},
-        { EchosounderCommandIds::IdGo,              { "#go",         "",      "" }}
-    };
-}
+#include "EchosounderCommandTable.h"
+#include "ResponseMatcher.h"
+#include "RingBuffer.h"
+#include "SpscQueue.h"
+#include "NmeaParser.h"
+#include "InfoParser.h"
+#include "SettingsStore.h"
+#include "EchosounderDetector.h"
+#include "CommandTimeouts.h"
+#include "ClockModel.h"
+#include "RecordingWriter.h"
 
 /**
     @class SingleSonar
 
     SingleSonar is used for access to Single Frequency Echosounder.
+
+    Commands may be called from any thread, they are serialized by the port lock. Data is read
+    by one thread: in streaming mode it does not wait for commands, output received while a
+    command stops the echosounder is put to the streaming buffer. GetValue() and IsRunning()
+    never wait for the port.
  */
 
 class Echosounder : public ISonar
 {    
+public:
+
     /**
-    *   Serial port class used by echosounder
+    *   One item of a settings transaction
     */
-    std::shared_ptr<serial::Serial>serial_port_;
+    struct SettingValue
+    {
+        EchosounderCommandIds command;
+        std::string value;
+
+        /**
+        *   1 - value is set, 2 - invalid command or command is not supported, 3 - invalid argument, -2 - timeout occured, 0 - not sent
+        */
+        int result;
+    };
+
+    /**
+    *   Called on the command thread with the result of an asynchronous command
+    */
+    typedef std::function<void(int)> Completion;
+
+private:
+
+    /**
+    *   Transport used by echosounder
+    */
+    std::shared_ptr<ITransport> transport_;
 
     /**
     *   Data return by the unit after host issued command to it
@@ -71,29 +79,305 @@ class Echosounder : public ISonar
     std::string command_result_;
 
     /**
-    *   #info command result line by line
+    *   Bytes received from the serial port, [rx_begin_, rx_end_) are not processed yet
+    */
+    std::vector<uint8_t> rx_buffer_;
+    std::size_t rx_begin_;
+    std::size_t rx_end_;
+
+    /**
+    *   Matcher for command responses and command prompt
+    */
+    ResponseMatcher response_matcher_;
+
+    /**
+    *   Parser for #info command result
+    */
+    InfoParser info_parser_;
+
+    /**
+    *   This table contains all available command for the echosounder
+    */
+    const EchosounderCommandTable &echosounder_commands_;
+
+    /**
+    *   This store contains all current settings of the echosounder
+    */
+    SettingsStore echosounder_settings_;
+
+    /**
+    *   Response and prompt timeouts of every command
+    */
+    CommandTimeouts command_timeouts_;
+
+    /**
+    *   Owner of the port: held by every command and by direct reads of the transport, so commands from
+    *   different threads are serialized and never share the response matcher. Recursive because commands
+    *   are built from other commands.
+    */
+    mutable std::recursive_mutex port_mutex_;
+
+    /**
+    *   Copy of echosounder_settings_ published after every change, read by GetValue() without the port lock
     */
-    std::vector<std::string> info_lines_;
+    std::shared_ptr<const SettingsStore> settings_view_;
 
     /**
-    *   This map contains all available command for the echosounder
+    *   Deadline of the current high-level operation, no wait goes beyond it
     */
-    std::map<int, EchosounderCommandList>& echosounder_commands_;
+    std::chrono::steady_clock::time_point deadline_;
 
     /**
-    *   This map contains all current settings of the echosounder
+    *   Time to wait for data in ReadData() and PeekData() of the C API
     */
-    std::map<EchosounderCommandIds_t, std::string> echosounder_settings_;
+    std::atomic<int64_t> read_timeout_ms_;
+
+    /**
+    *   Set when a response or prompt was not received in time, its late bytes are discarded before the next command
+    */
+    bool stale_input_;
 
     /**
     *   Current running status of the echosounder
     */
-    bool is_running_;
+    std::atomic<bool> is_running_;
 
     /**
     *   Current detected status of the echosounder
     */
-    bool is_detected_;
+    std::atomic<bool> is_detected_;
+
+    /**
+    *   Result of the last successful detection
+    */
+    EchosounderDetectInfo detect_info_;
+
+    /**
+    *   Streaming mode: reader thread drains the transport into stream_buffer_. A new buffer is
+    *   published by std::atomic_store and the data path takes it by std::atomic_load, so the
+    *   buffer a reader is draining stays alive when streaming is restarted from another thread.
+    *   peek_buffer_ keeps the buffer of the view returned by PeekData() until ConsumeData().
+    *   Outside streaming mode PeekData() moves received bytes into stream_buffer_ as well.
+    */
+    std::shared_ptr<RingBuffer> stream_buffer_;
+    std::shared_ptr<RingBuffer> peek_buffer_;
+    std::thread reader_thread_;
+    std::atomic<bool> reader_stop_;
+    std::atomic<bool> is_streaming_;
+    int streaming_pause_depth_;
+
+    /**
+    *   Duration of the last Stop() in microseconds, -1 if it failed
+    */
+    std::atomic<int64_t> stop_latency_us_;
+
+    /**
+    *   Number of bytes dropped because stream_buffer_ was full
+    */
+    std::atomic<uint64_t> overrun_bytes_;
+
+    /**
+    *   Used to wake up ReadData() waiting for the reader thread
+    */
+    std::mutex stream_mutex_;
+    std::condition_variable stream_ready_;
+
+    /**
+    *   Parser for NMEA output, fed with all data passed to the user. Records wait in nmea_records_ until read.
+    */
+    NmeaParser nmea_parser_;
+    SpscQueue<EchosounderNmeaRecord> nmea_records_;
+    std::atomic<uint64_t> nmea_dropped_;
+
+    /**
+    *   Stops the reader thread while command path uses the transport, restarts it on destruction
+    */
+    class StreamingPause
+    {
+        Echosounder &echosounder_;
+
+    public:
+        StreamingPause(Echosounder &Owner);
+        ~StreamingPause();
+    };
+
+    /**
+    *   Asynchronous commands, executed one by one on command_thread_ (or by ProcessIO() in event-driven mode)
+    *   in the order they were queued
+    */
+    enum AsyncKind
+    {
+        AsyncSetValue = 0,
+        AsyncGetSettings,
+        AsyncStart,
+        AsyncStop,
+        AsyncSetTime
+    };
+
+    struct AsyncCommand
+    {
+        AsyncKind kind;
+        EchosounderCommandIds command;
+        std::string value;
+        std::shared_ptr<std::promise<int>> result;
+        Completion done;
+    };
+
+    std::deque<AsyncCommand> command_queue_;
+    std::mutex command_mutex_;
+    std::condition_variable command_ready_;
+    std::thread command_thread_;
+    bool command_stop_;
+
+    /**
+    *   Set by StopCommandThread(), commands queued after it are cancelled at once
+    */
+    bool command_closed_;
+
+    std::future<int> Enqueue(AsyncKind Kind, EchosounderCommandIds Command, const std::string &Value, Completion Done);
+    int RunCommand(const AsyncCommand &Item);
+    void Complete(AsyncCommand &Item, int Result);
+    void CommandThread();
+
+    /**
+    *   One exchange of an asynchronous command in event-driven mode: text is sent, then bytes are fed
+    *   to response_matcher_ until one of tokens is found. Only the main step decides the command result.
+    *   Bytes before the token of a routed step are echosounder output and go to the streaming buffer.
+    */
+    struct IoStep
+    {
+        std::string text;
+        uint32_t tokens;
+        int64_t timeout_ms;
+        int attempts;
+        bool main;
+        bool route;
+    };
+
+    /**
+    *   Event-driven mode state, owned by the thread calling ProcessIO()
+    */
+    bool io_mode_;
+    bool io_streaming_;
+    bool io_active_;
+    int io_result_;
+    std::deque<IoStep> io_steps_;
+    std::chrono::steady_clock::time_point io_deadline_;
+    std::chrono::steady_clock::time_point io_begin_;
+    std::function<void()> io_wakeup_;
+
+    /**
+    *   Command text not yet accepted by the port, [io_output_sent_, size) is pending
+    */
+    std::string io_output_;
+    std::size_t io_output_sent_;
+
+    /**
+    *   Host monotonic time of the last read into rx_buffer_, in microseconds
+    */
+    int64_t rx_time_us_;
+
+    /**
+    *   Device time is set again when it differs from the host UTC by more than time_sync_bound_us_, 0 - never
+    */
+    std::atomic<int64_t> time_sync_bound_us_;
+    std::atomic<bool> time_sync_pending_;
+
+    /**
+    *   Host monotonic time the device time was last set at, 0 - never; automatic setting waits a hold-off after it
+    */
+    std::atomic<int64_t> time_sync_last_us_;
+    ClockModel clock_model_;
+
+    /**
+    *   Recording of received data, nullptr - not recording. Taken by std::atomic_load on the parsing
+    *   path, so recording can be started and stopped while data is read.
+    */
+    std::shared_ptr<RecordingWriter> recorder_;
+
+    /**
+    *   @brief Queue entry to the recording if recording is active
+    */
+    void RecordEntry(EchosounderRecordingEntryType Type, int64_t TimeUs, const void *Data, std::size_t Size);
+
+    /**
+    *   @brief Get text of the published settings for the recording, lines of "<id> <command> <value>\n"
+    */
+    std::string GetSettingsSnapshot() const;
+
+    void PushStream(const uint8_t *Data, std::size_t Size, int64_t TimeUs);
+    void BeginOperation();
+    void BeginStep();
+    void ConsumeStep();
+    void ApplyResult(int Result);
+    void StepTimeout();
+    void FinishOperation(int Result);
+    void SendOutput();
+
+    /**
+    *   Limits deadline_ for the lifetime of the scope, nested scopes keep the earliest deadline
+    */
+    class DeadlineScope
+    {
+        Echosounder &echosounder_;
+        std::chrono::steady_clock::time_point previous_;
+
+    public:
+        DeadlineScope(Echosounder &Owner, std::chrono::steady_clock::time_point Deadline);
+        ~DeadlineScope();
+    };
+
+    /**
+     *   @brief Get deadline of a wait, timeoutms from now but not later than deadline_
+     */
+    std::chrono::steady_clock::time_point Until(int64_t timeoutms) const;
+
+    /**
+     *   @brief Write command line, the port must take it within its transfer time and the operation deadline
+     *   @return false - the line was not written whole
+     */
+    bool WriteCommand(const std::string &Text);
+
+    /**
+     *   @brief Start echosounder again after a command if it was running and deadline_ is not expired
+     */
+    void Resume(bool wasrunning);
+
+    /**
+     *   @brief Drop received data if the last command timed out, so its late response is not taken for the next one
+     */
+    void DiscardStaleInput();
+
+    void ParseData(const uint8_t *Data, std::size_t Size, int64_t TimeUs);
+
+    /**
+    *   @brief Copy the record just completed by nmea_parser_ and stamp it with host and device time.
+    *   ZDA records also feed clock_model_.
+    */
+    EchosounderNmeaRecord StampRecord(int64_t TimeUs);
+
+    /**
+    *   @brief Queue setting of the device time if the device clock went beyond time_sync_bound_us_
+    */
+    void CheckTimeSync();
+
+    /**
+    *   @brief Make current echosounder_settings_ visible to GetValue(), called with the port lock held
+    */
+    void PublishSettings();
+
+    /**
+     *   @brief Parse output of a triggered ping into Ping, records which do not fit go to nmea_records_
+     */
+    void ParsePing(const uint8_t *Data, std::size_t Size, int64_t TimeUs, EchosounderPing &Ping);
+
+    /**
+     *   @brief Get time the unit needs to ping at the current range and print the result
+     */
+    int64_t PingTimeoutMs() const;
+    void ReaderThread();
+    void StartReaderThread();
+    void StopReaderThread();
 
     /**
      *   @brief Send command to the echosounder
@@ -104,19 +388,44 @@ class Echosounder : public ISonar
 
     /**
      *   @brief Receive responce for command sent to the echosounder
+     *   @param Command - command sent, selects the response timeout
      *   @return 1 - command successfuly execute, 2 - invalid argument, 3 - invalid command, -2 - timeout occured
      */
-    int SendCommandResponseCheck();
+    int SendCommandResponseCheck(EchosounderCommandIds Command);
 
     /**
      *   @brief Waiting until echosounder send back "command prompt" character
      *   @param timeoutms - timeout in milliseconds
+     *   @param RouteData - bytes before the prompt are echosounder output and go to the streaming buffer
      *   @return 1 - command prompt received, -2 - timeout occured
      */
-    int WaitCommandPrompt(int64_t timeoutms) const;
+    int WaitCommandPrompt(int64_t timeoutms, bool RouteData = false);
 
+    /**
+     *   @brief Read next block of data from the transport into rx_buffer_ if all received data is processed
+     *   @param deadline - time until which to wait for data
+     *   @return true - unprocessed data is available, false - deadline expired
+     */
+    bool ReceiveData(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     *   @brief Parse #info command result in command_result_ to echosounder_settings_
+     */
     void GetAllValues();
-    void SetAllValues();
+
+    /**
+     *   @brief Interrupt running echosounder with a single carriage return and wait for the command prompt,
+     *   data received before the prompt is discarded
+     *   @return true - command prompt received
+     */
+    bool BreakIn();
+
+    /**
+     *   @brief Send values which differ from the ones last confirmed by the echosounder
+     *   @param Items - filled with sent values and their results
+     *   @return true - all values are set
+     */
+    bool SetChangedValues(std::vector<SettingValue> &Items);
 
     /**
      *   @brief Send #info command and parse it to echosounder_settings_
@@ -124,34 +433,330 @@ class Echosounder : public ISonar
      */
     int GetSonarInfo();
 
+    /**
+     *   @brief Implementation of SetValue(), GetSettings(), Start() and Stop() which keeps the result code
+     *   @return 1 - command successfuly execute, 2 - invalid command, 3 - invalid argument, -2 - timeout occured,
+     *   -1 - echosounder is attached to an event loop
+     */
+    int SetValueCommand(EchosounderCommandIds Command, const std::string &SonarValue);
+    int GetSettingsCommand();
+    int StartCommand();
+    int StopCommand();
+
+protected:
+
+    /**
+    *   @brief Pass record parsed from the received data to the reader, called on the thread which parses
+    *   the data (reader thread in streaming mode). Default puts it to the record queue.
+    */
+    virtual void DispatchRecord(const EchosounderNmeaRecord &Record);
+
+    /**
+    *   @brief Stop the command thread for good, queued commands are cancelled and later ones are refused.
+    *   Derived classes call StopStreaming() and then it in their destructor, so no thread calls DispatchRecord()
+    *   or runs a command (e.g. queued by CheckTimeSync() on the reader thread) on a partly destroyed object.
+    */
+    void StopCommandThread();
+
+    /**
+    *   @brief Detect echosounder and read its settings, done by constructors which are not given a detection result
+    */
+    void DetectAndGetInfo();
+
 public:
 
     /**
-        Constructor
+        Constructor, detects echosounder on the transport
     */
-    Echosounder(std::shared_ptr<serial::Serial> SerialPort, std::map<int, EchosounderCommandList>& CommandList = SingleSonarCommands);
+    Echosounder(std::shared_ptr<ITransport> Transport, const EchosounderCommandTable &CommandList = SingleEchosounderCommands);
+
+    /**
+        Constructor, detection is not done
+        @param Detected - result of EchosounderDetector which has found the echosounder on this transport,
+        nullptr - transport has no echosounder to talk to (e.g. ReplayTransport), it is taken as not detected
+    */
+    Echosounder(std::shared_ptr<ITransport> Transport, const EchosounderDetectInfo *Detected, const EchosounderCommandTable &CommandList = SingleEchosounderCommands);
+    Echosounder(std::shared_ptr<serial::Serial> SerialPort, const EchosounderCommandTable &CommandList = SingleEchosounderCommands);
+
+    virtual ~Echosounder();
 
     /**
     *   @brief Set echosounder's value   
     */
     bool SetValue(EchosounderCommandIds Command, const std::string &SonarValue);
 
+    /**
+    *   @brief Change echosounder's value locally, it is sent by SetSettings() or ApplySettings().
+    *   Value is dirty until it is sent, GetSettings() replaces staged values with the ones reported by the echosounder.
+    *   @return true - command is supported
+    */
+    bool StageValue(EchosounderCommandIds Command, const std::string &SonarValue);
+
+    /**
+    *   @brief Send staged values which differ from the last confirmed ones in one transaction
+    *   @param Verify - re-read #info once at the end and check that all sent values are reported back
+    *   @return true - all values are set (and verified)
+    */
+    bool ApplySettings(bool Verify);
+
+    /**
+    *   @brief Set several echosounder's values in one transaction. Acquisition is stopped once,
+    *   commands are sent back-to-back without waiting for the prompt and acquisition is resumed
+    *   with a single #go if it was running. Result of every item is stored in its result field.
+    *   @return number of values set successfully
+    */
+    std::size_t SetValues(std::vector<SettingValue> &Items);
+
+    /**
+    *   @brief Checking whether the echosounder model has given command
+    */
+    bool IsCommandSupported(EchosounderCommandIds Command) const;
+
     /**
     *   @brief Get echosounder's value. Value is stored internally in the class.
-    *   @return std::string reference to Value
+    *   Cached values are read without waiting for a command in progress on another thread.
+    *   @return copy of Value
     */  
-    const std::string &GetValue(EchosounderCommandIds command);
+    std::string GetValue(EchosounderCommandIds command);
 
     /**
-    *   @brief Set current time to echosounder
+    *   @brief Get echosounder's value as number, parsed when the value was received
+    *   @return true - value is known and numeric, false - Value is not changed
+    */
+    bool GetValue(EchosounderCommandIds Command, long &Value) const;
+    bool GetValue(EchosounderCommandIds Command, float &Value) const;
+
+    /**
+    *   @brief Set current time to echosounder. Echosounder takes whole seconds, so the command is sent
+    *   to arrive at the beginning of the next second if deadline_ allows, otherwise the nearest second is set.
+    *   The wait is done without the port lock, except for the time needed to stop the echosounder.
     */  
     void SetCurrentTime();
 
     /**
-    *   @brief Get serial port used for access to echosounder.
-    *   @return std::shared_ptr<serial::Serial> reference
+    *   @brief Set current time again when device time estimated from ZDA records differs from
+    *   the host UTC by more than BoundUs. Requires $SDZDA output. 0 - disabled (default)
+    *   Bound is at least 50 ms and the time is not set again automatically within 60 s.
+    */
+    void SetTimeSyncBound(int64_t BoundUs);
+
+    /**
+    *   @brief Get relation of the device clock to the host monotonic clock
+    *   @return true - State is filled, false - no ZDA record received yet
+    */
+    bool GetClockState(EchosounderClockState &State) const;
+
+    /**
+    *   @brief Convert host monotonic time (ClockModel::MonotonicUs()) to device UTC time and back, microseconds
+    *   @return false - no ZDA record received yet, result is not changed
+    */
+    bool ToDeviceTime(int64_t HostUs, int64_t &DeviceUs) const;
+    bool ToHostTime(int64_t DeviceUs, int64_t &HostUs) const;
+
+    /**
+    *   @brief Get transport used for access to echosounder.
+    *   @return std::shared_ptr<ITransport> reference
+    */
+    std::shared_ptr<ITransport> &GetTransport();
+
+    /**
+    *   @brief Read raw data from the echosounder. Data already received while waiting for command response is returned first.
+    *   @param timeoutms - time to wait for data if nothing is received yet
+    *   @return number of bytes read
+    */
+    std::size_t ReadData(uint8_t *Buffer, std::size_t Size, int64_t timeoutms);
+
+    /**
+    *   @brief Get view of received data inside the stream buffer without copying it.
+    *   Waits for data up to timeoutms if nothing is received yet. View is valid until ConsumeData().
+    *   @return number of bytes in the view
+    */
+    std::size_t PeekData(DataView &View, int64_t timeoutms);
+
+    /**
+    *   @brief Release bytes obtained by PeekData()
+    */
+    void ConsumeData(std::size_t Size);
+
+    /**
+    *   @brief Take oldest NMEA record parsed from the received data
+    *   @return true - record is valid, false - no records
+    */
+    bool ReadRecord(EchosounderNmeaRecord &Record);
+
+    /**
+    *   @brief Get NMEA parser statistics
+    */
+    void GetNmeaStatistics(EchosounderNmeaStatistics &Statistics) const;
+
+    /**
+    *   @brief Start streaming mode. Dedicated thread drains the transport into a ring buffer of given size
+    *   and ReadData() copies data out of the ring. Reader thread is paused while commands are executed.
+    *   @return true - streaming started, false - streaming is already active
+    */
+    bool StartStreaming(std::size_t BufferSize);
+
+    /**
+    *   @brief Stop streaming mode. Data left in the ring buffer can still be read by ReadData().
+    */
+    void StopStreaming();
+
+    /**
+    *   @brief Checking whether streaming mode is active
+    */
+    bool IsStreaming() const;
+
+    /**
+    *   @brief Get number of bytes dropped since streaming start because ring buffer was full
+    */
+    uint64_t GetOverrunBytes() const;
+
+    /**
+    *   @brief Record received data, parsed records and settings snapshots into memory-mapped segment files
+    *   <Path>.000000.esr, <Path>.000001.esr, ... A dedicated thread writes the files, the thread reading
+    *   data only queues entries and never waits for the disk. Read back by RecordingReader.
+    *   @param SegmentSize - size of segment files in bytes, 0 - 64 MiB
+    *   @return false - already recording or the first segment can not be created
+    */
+    bool StartRecording(const std::string &Path, std::size_t SegmentSize);
+
+    /**
+    *   @brief Write queued entries and close the recording
+    */
+    void StopRecording();
+
+    /**
+    *   @return false - not recording
+    */
+    bool GetRecordingStatistics(EchosounderRecordingStatistics &Statistics) const;
+
+    /**
+    *   @brief Get duration of the last Stop() of running echosounder
+    *   @return microseconds, -1 - last stop failed, 0 - echosounder has not been stopped yet
+    */
+    int64_t GetStopLatency() const;
+
+    /**
+    *   @brief Queue command to the command thread and return at once. Commands are executed in the order
+    *   they were queued, Done (if set) is called on the command thread right after the future is ready.
+    *   Result: 1 - command successfuly execute, 2 - invalid command, 3 - invalid argument, -2 - timeout occured,
+    *   0 - cancelled because the echosounder was closed. Synchronous commands and ReadData() outside of
+    *   streaming mode must not be used while asynchronous commands are pending.
+    */
+    std::future<int> SetValueAsync(EchosounderCommandIds Command, const std::string &SonarValue, Completion Done = Completion());
+    std::future<int> GetSettingsAsync(Completion Done = Completion());
+    std::future<int> StartAsync(Completion Done = Completion());
+    std::future<int> StopAsync(Completion Done = Completion());
+
+    /**
+    *   @brief Get number of queued asynchronous commands including the one being executed
+    */
+    std::size_t GetPendingCommands();
+
+    /**
+    *   @brief Get file descriptor of the transport for poll()/epoll()
+    *   @return descriptor, -1 - transport has no descriptor
+    */
+    int GetFd() const;
+
+    /**
+    *   @brief Switch to event-driven mode: asynchronous commands and incoming data are handled by ProcessIO()
+    *   called from an external event loop instead of command and reader threads. Received data goes to the
+    *   streaming buffer of BufferSize bytes and is read by ReadData()/ReadRecord() as in streaming mode.
+    *   Synchronous commands (SetValue(), SetValues(), GetSettings(), ApplySettings(), Start(), Stop(), Detect(),
+    *   Trigger()) fail until DetachIO(), the port belongs to ProcessIO().
+    *   @param Wakeup - called (under the command lock) when a command is queued, the loop must call ProcessIO() soon
+    *   @return true - switched, false - already attached or the transport has no descriptor
+    */
+    bool AttachIO(std::function<void()> Wakeup, std::size_t BufferSize);
+
+    /**
+    *   @brief Leave event-driven mode, a command in progress completes with -2, queued ones go to the command thread.
+    *   Must not be called concurrently with ProcessIO().
+    */
+    void DetachIO();
+
+    /**
+    *   @brief Send pending command bytes and read available data without blocking, advance the active
+    *   asynchronous command. Called by the event loop when the descriptor is readable (or writable while
+    *   WantsWrite()), after Wakeup and when GetIoDeadline() expires.
+    */
+    void ProcessIO();
+
+    /**
+    *   @brief Port hung up or failed in event-driven mode: the active asynchronous command and all queued
+    *   ones complete with -2. Called by the event loop instead of ProcessIO() until DetachIO().
+    */
+    void FailIO();
+
+    /**
+    *   @brief Get time when ProcessIO() must be called even without input, max if no command is active
     */
-    std::shared_ptr<serial::Serial> &GetSerialPort();
+    std::chrono::steady_clock::time_point GetIoDeadline() const;
+
+    /**
+    *   @brief Check whether command bytes wait for the port, the loop must then call ProcessIO() when it is writable
+    */
+    bool WantsWrite() const;
+
+    /**
+    *   @brief Switch echosounder to single ping mode (#pingonce 1), acquisition is then done by Trigger()
+    *   @return true - single ping mode is on, false - not supported by the echosounder or failed
+    */
+    bool ArmTrigger();
+
+    /**
+    *   @brief Switch echosounder back to continuous mode (#pingonce 0)
+    *   @return true - continuous mode is on
+    */
+    bool DisarmTrigger();
+
+    /**
+    *   @brief Checking whether single ping mode is on
+    */
+    bool IsTriggerArmed() const;
+
+    /**
+    *   @brief Fire a single ping and wait for its output, the echosounder returns to the command prompt after it.
+    *   Records of the ping are returned in Ping together with the time from the trigger to the end of the output.
+    *   @return 1 - ping is done, 2 - single ping mode is not armed, -2 - timeout occured,
+    *   -1 - echosounder is attached to an event loop
+    */
+    int Trigger(EchosounderPing &Ping);
+
+    /**
+    *   @brief Same as the operations without Deadline, but no wait goes beyond Deadline. If time runs out,
+    *   the operation fails and the echosounder is left stopped.
+    *   @return true - operation succeeded
+    */
+    bool SetValue(EchosounderCommandIds Command, const std::string &SonarValue, std::chrono::steady_clock::time_point Deadline);
+    std::size_t SetValues(std::vector<SettingValue> &Items, std::chrono::steady_clock::time_point Deadline);
+    bool ApplySettings(bool Verify, std::chrono::steady_clock::time_point Deadline);
+    bool GetSettings(std::chrono::steady_clock::time_point Deadline);
+    bool Start(std::chrono::steady_clock::time_point Deadline);
+    bool Stop(std::chrono::steady_clock::time_point Deadline);
+
+    /**
+    *   @brief Override response and prompt timeouts of the command, zero fields keep the default.
+    *   Defaults are estimated from the response size and the baudrate.
+    */
+    void SetCommandTimeout(EchosounderCommandIds Command, const EchosounderTimeout &Timeout);
+
+    /**
+    *   @brief Return the command to the default timeouts
+    */
+    void ResetCommandTimeout(EchosounderCommandIds Command);
+
+    /**
+    *   @brief Get current response and prompt timeouts of the command
+    */
+    EchosounderTimeout GetCommandTimeout(EchosounderCommandIds Command) const;
+
+    /**
+    *   @brief Set time to wait for data used by the C API read functions
+    */
+    void SetReadTimeout(int64_t timeoutms);
+    int64_t GetReadTimeout() const;
 
     virtual void GetSettings() override;
     virtual void SetSettings() override;
@@ -160,6 +765,17 @@ public:
 
     virtual bool Detect() override;
 
+    /**
+    *   @brief Detect echosounder trying given baudrates in order, transport is left at the baudrate found
+    *   @return true - echosounder is detected
+    */
+    bool Detect(const std::vector<uint32_t> &Baudrates);
+
+    /**
+    *   @brief Get result of the last successful detection: baudrate, model and firmware version
+    */
+    const EchosounderDetectInfo &GetDetectInfo() const;
+
     virtual bool IsRunning() override;
     virtual bool IsDetected() override;
 };
@@ -7,9 +7,11 @@
 #include <stdbool.h>
 
 #include "EchosounderCommands.h"
+#include "EchosounderNmea.h"
 
 #define SERIALPORT_TIMEOUT_MS 100U
 #define VALUE_TEXT_SIZE 64U
+#define PORT_PATH_SIZE 128U
 
 #if defined( __WIN32__ ) || defined( WIN32 ) || defined( _WIN32 ) || defined( _WIN64 ) 
 
@@ -46,8 +48,64 @@ typedef struct echosoundervalue_t EchosounderValue;
 typedef struct echosoundervalue_t *pEchosounderValue;
 typedef const struct echosoundervalue_t *pcEchosounderValue;
 
+struct echosoundersetting_t
+{
+    EchosounderCommandIds_t command;
+    EchosounderValue value;
+    int result;
+};
+
+typedef struct echosoundersetting_t EchosounderSetting;
+typedef struct echosoundersetting_t *pEchosounderSetting;
+
+struct echosounderport_t
+{
+    char port[PORT_PATH_SIZE];
+    EchosounderDetectInfo_t info;
+};
+
+typedef struct echosounderport_t EchosounderPort;
+typedef struct echosounderport_t *pEchosounderPort;
+
+struct echosounderdataview_t
+{
+    const uint8_t *first;
+    size_t first_size;
+    const uint8_t *second;
+    size_t second_size;
+};
+
+typedef struct echosounderdataview_t EchosounderDataView;
+typedef struct echosounderdataview_t *pEchosounderDataView;
+
+/**
+ * Connection handle. Commands may be issued from several threads, they are executed one at a time.
+ * Data (EchosounderReadData, EchosounderPeekData, EchosounderConsumeData) is read by one thread;
+ * with EchosounderStartStreaming it is not held up by commands running on other threads.
+ */
 typedef void *pSnrCtx;
+
+/**
+ * @brief   Completion callback of asynchronous commands, called on the command thread of the echosounder
+ *
+ * @param[in]  snrctx       handle the command was queued to, must not be closed from the callback
+ * @param[in]  result       1 - command successfuly execute, 2 - invalid command, 3 - invalid argument,
+ *                          -2 - timeout occured, 0 - cancelled because the echosounder was closed
+ * @param[in]  userdata     pointer given when the command was queued
+ */
+typedef void (*EchosounderCompletion)(pSnrCtx snrctx, int result, void *userdata);
+
+/**
+ * @brief   Called when an asynchronous command is queued to an echosounder in event-driven mode,
+ *          the event loop must call EchosounderProcessIO soon. Must not queue commands itself.
+ *
+ * @param[in]  snrctx       handle the command was queued to
+ * @param[in]  userdata     pointer given to EchosounderAttachIO
+ */
+typedef void (*EchosounderWakeup)(pSnrCtx snrctx, void *userdata);
 typedef void *hEchosounder; 
+typedef void *pSnrReactor;
+typedef void *pSnrRecording;
 
 /**
  * @brief   Initiate connection to single frequency echosounder
@@ -75,6 +133,65 @@ DLL_EXPORT pSnrCtx SingleEchosounderOpen(const char *portpath, uint32_t baudrate
  */
 DLL_EXPORT pSnrCtx DualEchosounderOpen(const char* portpath, uint32_t baudrate);
 
+/**
+ * @brief   Find echosounder on serial port without opening it
+ *
+ * @note    Baudrates are tried in the given order, detection stops at the first one the echosounder answers.
+ *          Model is detected by #getf, firmware version by #version. Echosounder is stopped after this.
+ *
+ * @param[in]  portpath     path to serial port
+ * @param[in]  baudrates    baudrates to try
+ * @param[in]  count        number of baudrates
+ * @param[out] info         baudrate, model and firmware version of the echosounder
+ *
+ * @return                  0  - echosounder is found
+ * @return                  -1 - echosounder is not found or port can not be opened
+ */
+DLL_EXPORT int EchosounderProbe(const char *portpath, const uint32_t *baudrates, size_t count, EchosounderDetectInfo_t *info);
+
+/**
+ * @brief   Find echosounder on serial port and open it as single or dual frequency echosounder
+ *
+ * @note    Same as EchosounderProbe followed by (Single|Dual)EchosounderOpen at the found baudrate,
+ *          but the port is opened and the echosounder is detected once.
+ *
+ * @param[in]  portpath     path to serial port
+ * @param[in]  baudrates    baudrates to try
+ * @param[in]  count        number of baudrates
+ * @param[out] info         baudrate, model and firmware version of the echosounder, can be NULL
+ *
+ * @return                  Valid handle to futher using to manage the echosounder
+ * @return                  NULL in case of failure
+ */
+DLL_EXPORT pSnrCtx EchosounderOpen(const char *portpath, const uint32_t *baudrates, size_t count, EchosounderDetectInfo_t *info);
+
+/**
+ * @brief   Get result of the last successful detection
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] info         baudrate (0 if the baudrate given at open was used), model and firmware version
+ */
+DLL_EXPORT void EchosounderGetDetectInfo(pSnrCtx snrctx, EchosounderDetectInfo_t *info);
+
+/**
+ * @brief   Find echosounders on several serial ports at once
+ *
+ * @note    Ports are probed concurrently like EchosounderProbe does it for one port, so discovery takes
+ *          about as long as the slowest port. Found echosounders are stopped, ports are closed after this.
+ *
+ * @param[in]  portpaths    paths to serial ports, NULL - all serial ports present on the host
+ * @param[in]  portcount    number of paths in portpaths
+ * @param[in]  baudrates    baudrates to try on every port
+ * @param[in]  count        number of baudrates
+ * @param[in]  threads      maximum number of ports probed at the same time, 0 - one thread per port
+ * @param[out] units        found echosounders in the order of ports
+ * @param[in]  size         number of items in units
+ *
+ * @return                  number of echosounders found, only first size of them are stored to units
+ */
+DLL_EXPORT size_t EchosounderDiscover(const char *const *portpaths, size_t portcount, const uint32_t *baudrates, size_t count,
+                                      size_t threads, pEchosounderPort units, size_t size);
+
 /**
  * @brief   Finalize connection to the echosounder
  *
@@ -95,6 +212,129 @@ DLL_EXPORT void EchosounderClose(pSnrCtx snrctx);
  */
 DLL_EXPORT size_t EchosounderReadData(pSnrCtx snrctx, uint8_t *buffer, size_t size);
 
+/**
+ * @brief   Get view of received data inside the library receive buffer without copying it
+ *
+ * @note    Data is returned as two spans when it wraps around the end of the buffer (second_size > 0).
+ *          View stays valid until EchosounderConsumeData, commands sent meanwhile do not change it.
+ *          Waits for data up to the read timeout (EchosounderSetReadTimeout) if nothing is received yet.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] view         spans of received data
+ *
+ * @return                  total number of bytes in the view
+ */
+DLL_EXPORT size_t EchosounderPeekData(pSnrCtx snrctx, pEchosounderDataView view);
+
+/**
+ * @brief   Release data obtained by EchosounderPeekData
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  size         number of bytes processed, from the beginning of the view
+ */
+DLL_EXPORT void EchosounderConsumeData(pSnrCtx snrctx, size_t size);
+
+/**
+ * @brief   Take oldest NMEA record parsed from the received data
+ *
+ * @note    Records are parsed from all data passed through EchosounderReadData/EchosounderConsumeData,
+ *          in streaming mode from all data received by the reader thread.
+ *          Sentences with invalid checksum are dropped.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] record       parsed record
+ *
+ * @return                  0  - record is valid
+ * @return                  -1 - no records
+ */
+DLL_EXPORT int EchosounderReadRecord(pSnrCtx snrctx, EchosounderNmeaRecord_t *record);
+
+/**
+ * @brief   Get NMEA parser statistics
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] statistics   parser counters
+ */
+DLL_EXPORT void EchosounderGetNmeaStatistics(pSnrCtx snrctx, EchosounderNmeaStatistics_t *statistics);
+
+/**
+ * @brief   Separate high and low frequency output of a dual frequency echosounder
+ *
+ * @note    Records with SH/SL talker go to a bounded queue per channel and/or to a queue of high/low pairs
+ *          of the same ping cycle instead of EchosounderReadRecord. Common sentences stay there.
+ *
+ * @param[in]  snrctx       Connection handle obtained by DualEchosounderOpen function.
+ * @param[in]  records      true - fill channel queues read by DualEchosounderReadChannelRecord
+ * @param[in]  pairs        true - fill pair queue read by DualEchosounderReadChannelPair
+ *
+ * @return                  0  - output is set
+ * @return                  -1 - not a dual frequency echosounder
+ */
+DLL_EXPORT int DualEchosounderSetChannelOutput(pSnrCtx snrctx, bool records, bool pairs);
+
+/**
+ * @brief   Take oldest record of the channel, every channel may be read by its own thread
+ *
+ * @param[in]  snrctx       Connection handle obtained by DualEchosounderOpen function.
+ * @param[in]  channel      ChannelHigh or ChannelLow
+ * @param[out] record       record, host_time_us is the time it was received
+ *
+ * @return                  0  - record is valid
+ * @return                  -1 - no records or not a dual frequency echosounder
+ */
+DLL_EXPORT int DualEchosounderReadChannelRecord(pSnrCtx snrctx, EchosounderChannel_t channel, EchosounderNmeaRecord_t *record);
+
+/**
+ * @brief   Take oldest pair of high and low frequency records of the same sentence type and ping cycle
+ *
+ * @param[in]  snrctx       Connection handle obtained by DualEchosounderOpen function.
+ * @param[out] pair         aligned records
+ *
+ * @return                  0  - pair is valid
+ * @return                  -1 - no pairs or not a dual frequency echosounder
+ */
+DLL_EXPORT int DualEchosounderReadChannelPair(pSnrCtx snrctx, EchosounderChannelPair_t *pair);
+
+/**
+ * @brief   Get channel counters
+ *
+ * @return                  0  - statistics are valid
+ * @return                  -1 - not a dual frequency echosounder
+ */
+DLL_EXPORT int DualEchosounderGetChannelStatistics(pSnrCtx snrctx, EchosounderChannelStatistics_t *statistics);
+
+/**
+ * @brief   Start streaming mode
+ *
+ * @note    Dedicated thread drains the serial port into a ring buffer, EchosounderReadData copies data out of it.
+ *          Bytes which do not fit into the ring buffer are dropped and counted by EchosounderGetOverrunCount.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  buffersize   ring buffer size in bytes, rounded up to power of two
+ *
+ * @return                  0  - streaming started
+ * @return                  -1 - streaming is already active
+ */
+DLL_EXPORT int EchosounderStartStreaming(pSnrCtx snrctx, size_t buffersize);
+
+/**
+ * @brief   Stop streaming mode
+ *
+ * @note    Data left in the ring buffer can still be read by EchosounderReadData
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ */
+DLL_EXPORT void EchosounderStopStreaming(pSnrCtx snrctx);
+
+/**
+ * @brief   Get number of bytes dropped since streaming start because the ring buffer was full
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  number of dropped bytes
+ */
+DLL_EXPORT uint64_t EchosounderGetOverrunCount(pSnrCtx snrctx);
+
 /**
  * @brief   Get value for the given parameter (command)
  *
@@ -109,6 +349,34 @@ DLL_EXPORT size_t EchosounderReadData(pSnrCtx snrctx, uint8_t *buffer, size_t si
  */
 DLL_EXPORT int EchosounderGetValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pEchosounderValue value);
 
+/**
+ * @brief   Get value for the given parameter (command) as integer
+ *
+ * @note    Value is parsed once when it is received from the echosounder, decimal values are truncated
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      parameter for which value should be obtained
+ * @param[out] value        value of given command
+ *
+ * @return                  0  - value is valid
+ * @return                  -1 - value is unknown or not numeric
+ */
+DLL_EXPORT int EchosounderGetLongValue(pSnrCtx snrctx, EchosounderCommandIds_t command, long *value);
+
+/**
+ * @brief   Get value for the given parameter (command) as float
+ *
+ * @note    Value is parsed once when it is received from the echosounder
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      parameter for which value should be obtained
+ * @param[out] value        value of given command
+ *
+ * @return                  0  - value is valid
+ * @return                  -1 - value is unknown or not numeric
+ */
+DLL_EXPORT int EchosounderGetFloatValue(pSnrCtx snrctx, EchosounderCommandIds_t command, float *value);
+
 /**
  * @brief   Set value for the given parameter (command)
  *
@@ -123,6 +391,271 @@ DLL_EXPORT int EchosounderGetValue(pSnrCtx snrctx, EchosounderCommandIds_t comma
  */
 DLL_EXPORT int EchosounderSetValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value);
 
+/**
+ * @brief   Change value for the given parameter (command) without sending it
+ *
+ * @note    Staged values are sent by EchosounderApplySettings, only if they differ from the
+ *          value last reported by the echosounder
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      parameter for which value should be staged
+ * @param[in]  value        new value of given command
+ *
+ * @return                  0  - value is staged
+ * @return                  -1 - command is not supported
+ */
+DLL_EXPORT int EchosounderStageValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value);
+
+/**
+ * @brief   Send staged values which differ from the echosounder settings
+ *
+ * @note    Running echosounder is stopped once and started again after all values are sent
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  verify       read settings back once at the end and compare them with the sent values
+ *
+ * @return                  0  - all values are set (and verified)
+ * @return                  -1 - at least one value failed
+ */
+DLL_EXPORT int EchosounderApplySettings(pSnrCtx snrctx, bool verify);
+
+/**
+ * @brief   Queue setting of value for the given parameter (command) and return at once
+ *
+ * @note    Asynchronous commands are executed one by one on the command thread of the echosounder
+ *          in the order they were queued, each echosounder has its own command thread.
+ *          Synchronous commands and EchosounderReadData outside of streaming mode must not be used
+ *          while asynchronous commands are pending.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      parameter for which command should be set
+ * @param[in]  value        value of given command, copied before return
+ * @param[in]  completion   called with the result when command is finished, can be NULL
+ * @param[in]  userdata     passed to completion
+ *
+ * @return                  0  - command is queued
+ * @return                  -1 - command can not be queued
+ */
+DLL_EXPORT int EchosounderSetValueAsync(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value,
+                                        EchosounderCompletion completion, void *userdata);
+
+/**
+ * @brief   Queue reading of all settings from the echosounder (#info) and return at once
+ *
+ * @note    See EchosounderSetValueAsync.
+ *
+ * @return                  0  - command is queued
+ * @return                  -1 - command can not be queued
+ */
+DLL_EXPORT int EchosounderGetSettingsAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata);
+
+/**
+ * @brief   Queue start of the echosounder and return at once
+ *
+ * @note    See EchosounderSetValueAsync.
+ *
+ * @return                  0  - command is queued
+ * @return                  -1 - command can not be queued
+ */
+DLL_EXPORT int EchosounderStartAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata);
+
+/**
+ * @brief   Queue stop of the echosounder and return at once
+ *
+ * @note    See EchosounderSetValueAsync.
+ *
+ * @return                  0  - command is queued
+ * @return                  -1 - command can not be queued
+ */
+DLL_EXPORT int EchosounderStopAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata);
+
+/**
+ * @brief   Get number of queued asynchronous commands including the one being executed
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ */
+DLL_EXPORT size_t EchosounderGetPendingCommands(pSnrCtx snrctx);
+
+/**
+ * @brief   Switch echosounder to event-driven mode for an external event loop (libuv, asio, epoll...)
+ *
+ * @note    Command and reader threads are stopped. The loop watches the descriptor from EchosounderGetFd
+ *          for reading, and for writing while EchosounderWantsWrite is true, and calls EchosounderProcessIO
+ *          when it is ready, after the wakeup callback and when EchosounderGetIoTimeout expires.
+ *          Asynchronous commands complete inside EchosounderProcessIO, received data is read by
+ *          EchosounderReadData/EchosounderReadRecord. Synchronous commands fail (return -1 or false)
+ *          until EchosounderDetachIO.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  buffersize   Size of the buffer for received data in bytes
+ * @param[in]  wakeup       Called when a command is queued, may be NULL if commands are queued on the loop thread
+ * @param[in]  userdata     Passed to wakeup
+ *
+ * @return                  0  - switched
+ * @return                  -1 - already in event-driven mode or the port has no descriptor
+ */
+DLL_EXPORT int EchosounderAttachIO(pSnrCtx snrctx, size_t buffersize, EchosounderWakeup wakeup, void *userdata);
+
+/**
+ * @brief   Leave event-driven mode, command in progress completes with -2, queued ones go on in the threaded mode
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ */
+DLL_EXPORT void EchosounderDetachIO(pSnrCtx snrctx);
+
+/**
+ * @brief   Get descriptor of the port to watch in the event loop
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  descriptor, -1 - the port can not be polled (Windows)
+ */
+DLL_EXPORT int EchosounderGetFd(pSnrCtx snrctx);
+
+/**
+ * @brief   Check whether command bytes wait for the port to become writable
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ */
+DLL_EXPORT bool EchosounderWantsWrite(pSnrCtx snrctx);
+
+/**
+ * @brief   Send pending command bytes, read received data and advance the active command, never blocks
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  0  - processed
+ * @return                  -1 - port failure
+ */
+DLL_EXPORT int EchosounderProcessIO(pSnrCtx snrctx);
+
+/**
+ * @brief   Get time until EchosounderProcessIO must be called even if the port is not ready
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  milliseconds (rounded up), -1 - no command is active
+ */
+DLL_EXPORT int32_t EchosounderGetIoTimeout(pSnrCtx snrctx);
+
+/**
+ * @brief   Create reactor which serves many echosounders from one epoll thread (Linux only)
+ *
+ * @note    Registered echosounders have no command and reader threads: asynchronous commands
+ *          and incoming data are handled by the reactor thread, completion callbacks are called there.
+ *
+ * @return                  Reactor handle, NULL - reactor can not be created or is not supported on the platform
+ */
+DLL_EXPORT pSnrReactor EchosounderReactorCreate(void);
+
+/**
+ * @brief   Unregister remaining echosounders and destroy reactor
+ *
+ * @param[in]  reactor      Reactor handle obtained by EchosounderReactorCreate function.
+ */
+DLL_EXPORT void EchosounderReactorDestroy(pSnrReactor reactor);
+
+/**
+ * @brief   Serve echosounder by the reactor
+ *
+ * @note    Only asynchronous commands, EchosounderReadData, EchosounderPeekData, EchosounderConsumeData and
+ *          EchosounderReadRecord may be used while registered, synchronous commands fail.
+ *          Echosounder must be unregistered before EchosounderClose.
+ *
+ * @param[in]  reactor      Reactor handle obtained by EchosounderReactorCreate function.
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  buffersize   Size of the buffer for received data in bytes
+ *
+ * @return                  0  - registered
+ * @return                  -1 - already registered or the port can not be polled
+ */
+DLL_EXPORT int EchosounderReactorRegister(pSnrReactor reactor, pSnrCtx snrctx, size_t buffersize);
+
+/**
+ * @brief   Stop serving echosounder by the reactor, queued commands go on in the threaded mode
+ *
+ * @note    Command in progress completes with -2. Must not be called from a completion callback.
+ *
+ * @return                  0  - unregistered
+ * @return                  -1 - echosounder is not registered
+ */
+DLL_EXPORT int EchosounderReactorUnregister(pSnrReactor reactor, pSnrCtx snrctx);
+
+/**
+ * @brief   Set values for several parameters (commands) in one transaction
+ *
+ * @note    Running echosounder is stopped once, all commands are sent back-to-back and
+ *          the echosounder is started again once. Result of each item is stored in its result field:
+ *          1 - value is set, 2 - invalid or not supported command, 3 - invalid argument,
+ *          -2 - timeout, 0 - not sent because of an earlier timeout.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in,out] settings  parameters and values to set
+ * @param[in]  count        number of items in settings
+ *
+ * @return                  number of values set successfully
+ */
+DLL_EXPORT size_t EchosounderSetValues(pSnrCtx snrctx, pEchosounderSetting settings, size_t count);
+
+/**
+ * @brief   Same as EchosounderSetValue, EchosounderSetValues, EchosounderApplySettings, EchosounderStart and
+ *          EchosounderStop, but the whole operation is bounded by timeoutms
+ *
+ * @note    Every wait of the operation is cut to the deadline. If time runs out, the operation fails
+ *          and the echosounder is left stopped.
+ *
+ * @param[in]  timeoutms    time limit of the whole operation in milliseconds
+ *
+ * @return                  0  - operation succeeded (EchosounderSetValuesWithin: number of values set)
+ * @return                  -1 - operation failed or ran out of time
+ */
+DLL_EXPORT int EchosounderSetValueWithin(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value, uint32_t timeoutms);
+DLL_EXPORT size_t EchosounderSetValuesWithin(pSnrCtx snrctx, pEchosounderSetting settings, size_t count, uint32_t timeoutms);
+DLL_EXPORT int EchosounderApplySettingsWithin(pSnrCtx snrctx, bool verify, uint32_t timeoutms);
+DLL_EXPORT int EchosounderStartWithin(pSnrCtx snrctx, uint32_t timeoutms);
+DLL_EXPORT int EchosounderStopWithin(pSnrCtx snrctx, uint32_t timeoutms);
+
+/**
+ * @brief   Read all settings from the echosounder (#info) within timeoutms
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  timeoutms    time limit of the whole operation in milliseconds
+ *
+ * @return                  0  - settings are read
+ * @return                  -1 - operation failed or ran out of time
+ */
+DLL_EXPORT int EchosounderGetSettingsWithin(pSnrCtx snrctx, uint32_t timeoutms);
+
+/**
+ * @brief   Override response and prompt timeouts of the command
+ *
+ * @note    Defaults are estimated from the expected response size and the baudrate, e.g. a few hundred
+ *          milliseconds for setting commands and much longer for #info at low baudrates.
+ *          Zero fields of timeout keep the default.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      command which timeouts are changed
+ * @param[in]  timeout      new timeouts, NULL - return to the defaults
+ */
+DLL_EXPORT void EchosounderSetCommandTimeout(pSnrCtx snrctx, EchosounderCommandIds_t command, const EchosounderTimeout_t *timeout);
+
+/**
+ * @brief   Get current response and prompt timeouts of the command
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  command      command which timeouts are read
+ * @param[out] timeout      current timeouts
+ */
+DLL_EXPORT void EchosounderGetCommandTimeout(pSnrCtx snrctx, EchosounderCommandIds_t command, EchosounderTimeout_t *timeout);
+
+/**
+ * @brief   Set time EchosounderReadData and EchosounderPeekData wait for data, SERIALPORT_TIMEOUT_MS by default
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  timeoutms    timeout in milliseconds
+ */
+DLL_EXPORT void EchosounderSetReadTimeout(pSnrCtx snrctx, uint32_t timeoutms);
+
 /**
  * @brief   Convert value read from echosounder to long 
  *
@@ -206,6 +739,54 @@ DLL_EXPORT void EchosounderStart(pSnrCtx snrctx);
  */
 DLL_EXPORT void EchosounderStop(pSnrCtx snrctx);
 
+/**
+ * @brief   Get duration of the last EchosounderStop of running echosounder
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  stop latency in microseconds
+ * @return                  0  - echosounder has not been stopped yet
+ * @return                  -1 - last stop failed
+ */
+DLL_EXPORT int64_t EchosounderGetStopLatency(pSnrCtx snrctx);
+
+/**
+ * @brief   Switch echosounder to single ping mode (#pingonce 1)
+ *
+ * @note    In single ping mode acquisition is done by EchosounderTrigger, one ping per call.
+ *          Running echosounder is stopped.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  0  - single ping mode is on
+ * @return                  -1 - not supported by the echosounder or failed
+ */
+DLL_EXPORT int EchosounderArmTrigger(pSnrCtx snrctx);
+
+/**
+ * @brief   Switch echosounder back to continuous mode (#pingonce 0)
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ *
+ * @return                  0  - continuous mode is on
+ * @return                  -1 - failed
+ */
+DLL_EXPORT int EchosounderDisarmTrigger(pSnrCtx snrctx);
+
+/**
+ * @brief   Fire a single ping and wait for its output
+ *
+ * @note    Echosounder must be armed by EchosounderArmTrigger. The call returns when the echosounder is back
+ *          at the command prompt, so pings can be fired back-to-back at the highest rate the link allows.
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] ping         records of the ping and time from the trigger to the end of the ping output
+ *
+ * @return                  0  - ping is done
+ * @return                  -1 - not armed or timeout occured
+ */
+DLL_EXPORT int EchosounderTrigger(pSnrCtx snrctx, EchosounderPing_t *ping);
+
 /**
  * @brief   Checking the running state of the echosounder
  *
@@ -246,11 +827,168 @@ DLL_EXPORT bool EchosounderDetect(pSnrCtx snrctx);
  * @brief   Set current time to the echosounder (UTC). It use current time from host PC.
  *
  * @note    It can be neccessary for sync NMEA output with GPS output
+ * @note    Echosounder takes whole seconds, so the command is delayed up to 1 s to arrive
+ *          at the beginning of the next second
  *
  * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
  */
 DLL_EXPORT void EchosounderSetCurrentTime(pSnrCtx snrctx);
 
+/**
+ * @brief   Set current time again when the echosounder clock differs from the host UTC by more than bound_us
+ *
+ * @note    Echosounder clock is estimated from $SDZDA records, so ZDA output must be enabled
+ * @note    Setting the time stops the data for a while, so it is not repeated within 60 s
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  bound_us     allowed difference in microseconds, at least 50000, 0 - disabled (default)
+ */
+DLL_EXPORT void EchosounderSetTimeSyncBound(pSnrCtx snrctx, uint32_t bound_us);
+
+/**
+ * @brief   Get host monotonic time in microseconds, the clock of host_time_us in NMEA records
+ */
+DLL_EXPORT int64_t EchosounderGetMonotonicTime(void);
+
+/**
+ * @brief   Get relation of the echosounder clock to the host monotonic clock, estimated from $SDZDA records
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[out] state        offset, drift and fit residual of the echosounder clock
+ *
+ * @return                  0  - state is valid
+ * @return                  -1 - no ZDA record received yet
+ */
+DLL_EXPORT int EchosounderGetClockState(pSnrCtx snrctx, EchosounderClockState_t *state);
+
+/**
+ * @brief   Convert host monotonic time to echosounder UTC time, microseconds since the epoch
+ *
+ * @return                  0  - device_us is valid
+ * @return                  -1 - no ZDA record received yet
+ */
+DLL_EXPORT int EchosounderHostToDeviceTime(pSnrCtx snrctx, int64_t host_us, int64_t *device_us);
+
+/**
+ * @brief   Convert echosounder UTC time to host monotonic time, microseconds
+ *
+ * @return                  0  - host_us is valid
+ * @return                  -1 - no ZDA record received yet
+ */
+DLL_EXPORT int EchosounderDeviceToHostTime(pSnrCtx snrctx, int64_t device_us, int64_t *host_us);
+
+/**
+ * @brief   Start recording of received data, parsed records and settings snapshots
+ *
+ * @note    Data is written to memory-mapped segment files <path>.000000.esr, <path>.000001.esr, ...
+ *          by a dedicated thread, reading data never waits for the disk. Entries are recorded when
+ *          the data is read (EchosounderReadData, EchosounderConsumeData or streaming).
+ *
+ * @param[in]  snrctx       Connection handle obtained by (Single|Dual)EchosounderOpen function.
+ * @param[in]  path         path of the recording without the segment suffix
+ * @param[in]  segment_size size of segment files in bytes, 0 - 64 MiB
+ *
+ * @return                  0  - recording started
+ * @return                  -1 - already recording or the first segment can not be created
+ */
+DLL_EXPORT int EchosounderStartRecording(pSnrCtx snrctx, const char *path, size_t segment_size);
+
+/**
+ * @brief   Write queued entries and close the recording
+ */
+DLL_EXPORT void EchosounderStopRecording(pSnrCtx snrctx);
+
+/**
+ * @brief   Get recording counters
+ *
+ * @return                  0  - statistics are valid
+ * @return                  -1 - not recording
+ */
+DLL_EXPORT int EchosounderGetRecordingStatistics(pSnrCtx snrctx, EchosounderRecordingStatistics_t *statistics);
+
+/**
+ * @brief   Open recording for reading, positioned at the first entry
+ *
+ * @param[in]  path         path given to EchosounderStartRecording
+ *
+ * @return                  Valid handle, NULL in case of failure
+ */
+DLL_EXPORT pSnrRecording EchosounderRecordingOpen(const char *path);
+
+DLL_EXPORT void EchosounderRecordingClose(pSnrRecording recording);
+
+/**
+ * @brief   Get time of the first and the last entry of the recording
+ *
+ * @return                  0  - times are valid
+ * @return                  -1 - recording is empty
+ */
+DLL_EXPORT int EchosounderRecordingGetTimeRange(pSnrRecording recording, int64_t *begin_us, int64_t *end_us);
+
+/**
+ * @brief   Go to the first entry at or after time_us, in O(log n) of the recording size
+ *
+ * @return                  0  - entry is found
+ * @return                  -1 - no entry at or after time_us
+ */
+DLL_EXPORT int EchosounderRecordingSeek(pSnrRecording recording, int64_t time_us);
+
+/**
+ * @brief   Read entry at the current position and advance
+ *
+ * @param[out] entry        data points into the recording and stays valid until EchosounderRecordingClose
+ *
+ * @return                  0  - entry is valid
+ * @return                  -1 - end of the recording
+ */
+DLL_EXPORT int EchosounderRecordingRead(pSnrRecording recording, EchosounderRecordingEntry_t *entry);
+
+/**
+ * @brief   Get echosounder setting in effect at the current position of the recording
+ *
+ * @return                  0  - value is valid
+ * @return                  -1 - value is not recorded
+ */
+DLL_EXPORT int EchosounderRecordingGetValue(pSnrRecording recording, EchosounderCommandIds_t command, pEchosounderValue value);
+
+/**
+ * @brief   Open single frequency echosounder which plays back a recording instead of a port
+ *
+ * @note    Recorded data goes through the parsing path again and is read by EchosounderReadData,
+ *          EchosounderStartStreaming and EchosounderReadRecord. Commands are not answered, the
+ *          echosounder is not detected. With speed 0 data should be read by EchosounderReadData
+ *          without streaming, streaming drops data which is not read in time like on a port.
+ *
+ * @param[in]  path         path given to EchosounderStartRecording
+ * @param[in]  speed        1.0 - recorded timing, 2.0 - twice as fast, 0 - as fast as possible
+ *
+ * @return                  Valid handle to futher using to read the data
+ * @return                  NULL in case of failure
+ */
+DLL_EXPORT pSnrCtx SingleEchosounderReplayOpen(const char *path, double speed);
+
+/**
+ * @brief   Open dual frequency echosounder which plays back a recording, see SingleEchosounderReplayOpen
+ */
+DLL_EXPORT pSnrCtx DualEchosounderReplayOpen(const char *path, double speed);
+
+/**
+ * @brief   Continue playing from the first data at or after time_us of the recording
+ *
+ * @return                  0  - data is found
+ * @return                  -1 - no data at or after time_us, or the handle does not play a recording
+ */
+DLL_EXPORT int EchosounderReplaySeek(pSnrCtx snrctx, int64_t time_us);
+
+/**
+ * @brief   Checking whether all data of the recording was played
+ *
+ * @return                  1  - all data was read from the transport
+ * @return                  0  - data is left
+ * @return                  -1 - the handle does not play a recording
+ */
+DLL_EXPORT int EchosounderReplayIsFinished(pSnrCtx snrctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,49 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(ECHOSOUNDERCOMMANDTABLE_H)
+#define ECHOSOUNDERCOMMANDTABLE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "EchosounderCommands.h"
+
+/**
+*   Number of command ids, tables have one entry per id
+*/
+const std::size_t EchosounderCommandCount = IdGetWorkFreq + 1;
+
+static_assert(EchosounderCommandCount <= 64, "capability mask has one bit per command id");
+
+/**
+    @struct EchosounderCommandTable
+
+    Commands of one echosounder model indexed by EchosounderCommandIds.
+    Commands the model does not have are { nullptr, nullptr, nullptr } and their bit in capabilities is clear.
+ */
+
+struct EchosounderCommandTable
+{
+    const EchosounderCommandList *commands;
+    uint64_t capabilities;
+
+    constexpr bool IsSupported(EchosounderCommandIds Command) const
+    {
+        return (static_cast<unsigned>(Command) < EchosounderCommandCount) && (0 != ((capabilities >> Command) & 1U));
+    }
+
+    /**
+    *   Entry of given command, valid for every id for which IsSupported() is true
+    */
+    const EchosounderCommandList &operator[](EchosounderCommandIds Command) const
+    {
+        return commands[Command];
+    }
+};
+
+/**
+*   Tables are constant initialized, nothing is built at static initialization time
+*/
+extern const EchosounderCommandTable SingleEchosounderCommands;
+extern const EchosounderCommandTable DualEchosounderCommands;
+
+#endif // ECHOSOUNDERCOMMANDTABLE_H
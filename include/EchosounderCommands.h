@@ -2,10 +2,15 @@
 #if !defined(SINGLESONARCOMMANDS_H)
 #define SINGLESONARCOMMANDS_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define FIRMWARE_TEXT_SIZE 16U
+
 enum EchosounderCommandIds
 {
     IdInfo = 0, 
@@ -76,13 +81,53 @@ enum EchosounderCommandIds
 
 typedef enum EchosounderCommandIds EchosounderCommandIds_t;
 
+/*
+ *  Type of the value reported by #info for a command
+ */
+enum EchosounderValueType
+{
+    ValueNone = 0,  /* command has no value */
+    ValueInteger,   /* integer, e.g. range in mm */
+    ValueFloat,     /* decimal, e.g. gain in dB */
+    ValueFlag,      /* 0 or 1 */
+    ValueMode,      /* small integer selecting a mode */
+    ValueText       /* text, e.g. firmware version */
+};
+
+typedef enum EchosounderValueType EchosounderValueType_t;
+
 struct EchosounderCommandList
 {
     const char* command_text;
     const char* default_value;
-    const char* regex_match_text;
+    EchosounderValueType_t value_type;
+    const char* info_key;                   /* key of the #info line with the value: "#range", "S/W Ver", "(Active)" - line ending with it, "" - none */
+};
+
+/*
+ *  Result of echosounder detection
+ */
+struct EchosounderDetectInfo
+{
+    uint32_t baudrate;                      /* baudrate the echosounder answered at */
+    bool dual;                              /* true - dual frequency echosounder, it accepts #getf */
+    char firmware[FIRMWARE_TEXT_SIZE];      /* firmware version reported by #version, empty if unknown */
 };
 
+typedef struct EchosounderDetectInfo EchosounderDetectInfo_t;
+
+/*
+ *  Timeouts of a command: response ("OK", "Invalid ...") after the command is sent
+ *  and command prompt after the response
+ */
+struct EchosounderTimeout
+{
+    uint32_t response_ms;
+    uint32_t prompt_ms;
+};
+
+typedef struct EchosounderTimeout EchosounderTimeout_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,87 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(ECHOSOUNDERDETECTOR_H)
+#define ECHOSOUNDERDETECTOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ITransport.h"
+#include "ResponseMatcher.h"
+#include "EchosounderCommands.h"
+
+/**
+    @class EchosounderDetector
+
+    Finds the echosounder on a transport. Carriage returns are sent with growing waits
+    in between and detection goes on as soon as the command prompt arrives, so an idle or
+    running unit is found within a few milliseconds. Baudrates can be scanned, the model is
+    told apart by #getf (dual frequency units only) and firmware is read by #version.
+ */
+
+class EchosounderDetector
+{
+public:
+
+    EchosounderDetector(std::shared_ptr<ITransport> Transport);
+
+    /**
+    *   @brief Detect echosounder trying given baudrates in order, transport is left at the baudrate found
+    *   @param Baudrates - baudrates to try, empty - use current baudrate of the transport only
+    *   @param Info - filled with detection result, baudrate is the current one of the transport if Baudrates is empty
+    *   @return true - echosounder is detected, it is stopped and ready for commands
+    */
+    bool Detect(const std::vector<uint32_t> &Baudrates, EchosounderDetectInfo &Info);
+
+    /**
+    *   @brief Interrupt the echosounder until the command prompt arrives
+    *   @param BudgetMs - total time to wait for the prompt
+    *   @return true - command prompt received
+    */
+    bool Probe(int64_t BudgetMs);
+
+    /**
+    *   @brief Limit detection by an overall deadline, budgets and timeouts are cut to it
+    */
+    void SetDeadline(std::chrono::steady_clock::time_point Deadline);
+
+private:
+
+    std::shared_ptr<ITransport> transport_;
+
+    std::vector<uint8_t> rx_buffer_;
+    std::size_t rx_begin_;
+    std::size_t rx_end_;
+
+    ResponseMatcher response_matcher_;
+
+    std::chrono::steady_clock::time_point deadline_;
+
+    /**
+    *   @brief Wait for one of tokens in Mask
+    *   @param Received - if not nullptr, bytes up to and including the token are appended
+    *   @return matched token, -1 if deadline expired
+    */
+    int WaitToken(uint32_t Mask, std::chrono::steady_clock::time_point Deadline, std::string *Received);
+
+    /**
+    *   @brief Send command and wait for its response and the prompt after it
+    *   @return 1 - OK, 2 - invalid command, 3 - invalid argument, -2 - timeout occured
+    */
+    int Command(const char *Text, std::string &Response);
+
+    /**
+    *   @brief Get deadline of a wait, TimeoutMs from now but not later than deadline_
+    */
+    std::chrono::steady_clock::time_point Until(int64_t TimeoutMs) const;
+
+    /**
+    *   @brief Drop everything received so far
+    */
+    void DiscardInput();
+};
+
+#endif // ECHOSOUNDERDETECTOR_H
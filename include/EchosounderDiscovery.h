@@ -0,0 +1,59 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(ECHOSOUNDERDISCOVERY_H)
+#define ECHOSOUNDERDISCOVERY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ITransport.h"
+#include "EchosounderCommands.h"
+
+/**
+    @class EchosounderDiscovery
+
+    Finds echosounders on several serial ports at once. Every port is probed by
+    EchosounderDetector on one of a bounded number of worker threads, so discovery takes
+    about as long as the slowest port instead of the sum of all of them.
+ */
+
+class EchosounderDiscovery
+{
+public:
+
+    /**
+    *   Opens transport on the port at the baudrate, throws in case of failure
+    */
+    typedef std::function<std::shared_ptr<ITransport>(const std::string &, uint32_t)> TransportFactory;
+
+    struct Unit
+    {
+        std::string port;
+        EchosounderDetectInfo info;
+    };
+
+    EchosounderDiscovery(TransportFactory Factory);
+
+    /**
+    *   @brief Get serial ports present on the host
+    */
+    static std::vector<std::string> ListPorts();
+
+    /**
+    *   @brief Probe ports concurrently
+    *   @param Ports - ports to probe
+    *   @param Baudrates - baudrates to try on every port, must not be empty
+    *   @param Threads - maximum number of ports probed at the same time, 0 - one thread per port
+    *   @return detected echosounders in the order of Ports
+    */
+    std::vector<Unit> Discover(const std::vector<std::string> &Ports, const std::vector<uint32_t> &Baudrates, std::size_t Threads);
+
+private:
+
+    TransportFactory factory_;
+};
+
+#endif // ECHOSOUNDERDISCOVERY_H
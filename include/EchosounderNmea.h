@@ -0,0 +1,223 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(ECHOSOUNDERNMEA_H)
+#define ECHOSOUNDERNMEA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMEA_XDR_MAX_MEASUREMENTS 4U
+#define NMEA_XDR_NAME_SIZE 8U
+#define NMEA_EMA_MAX_VALUES 8U
+#define PING_RECORDS_SIZE 16U
+
+/*
+ *  Sentence types produced by the echosounder, enabled by #nmeadbt, #nmeadpt, #nmeamtw, #nmeaxdr, #nmeaema, #nmeazda.
+ *  Numeric fields which are empty in the sentence are set to NaN.
+ */
+enum EchosounderNmeaSentence
+{
+    NmeaNone = 0,
+    NmeaDBT,
+    NmeaDPT,
+    NmeaMTW,
+    NmeaXDR,
+    NmeaEMA,
+    NmeaZDA
+};
+
+typedef enum EchosounderNmeaSentence EchosounderNmeaSentence_t;
+
+/* Depth below transducer */
+struct EchosounderNmeaDBT
+{
+    float depth_ft;
+    float depth_m;
+    float depth_fathoms;
+};
+
+/* Depth of water and transducer offset */
+struct EchosounderNmeaDPT
+{
+    float depth_m;
+    float offset_m;
+    float max_range_m;
+};
+
+/* Water temperature */
+struct EchosounderNmeaMTW
+{
+    float temperature_c;
+};
+
+/* Transducer measurement: type, value, unit and name, e.g. A,1.5,D,PTCH */
+struct EchosounderNmeaXDRMeasurement
+{
+    char type;
+    char unit;
+    float value;
+    char name[NMEA_XDR_NAME_SIZE];
+};
+
+struct EchosounderNmeaXDR
+{
+    int count;
+    struct EchosounderNmeaXDRMeasurement measurements[NMEA_XDR_MAX_MEASUREMENTS];
+};
+
+/* Echo values, numeric fields in the order they are sent */
+struct EchosounderNmeaEMA
+{
+    int count;
+    float values[NMEA_EMA_MAX_VALUES];
+};
+
+/* UTC time and date */
+struct EchosounderNmeaZDA
+{
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint32_t microsecond;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    int8_t zone_hours;
+    int8_t zone_minutes;
+};
+
+struct EchosounderNmeaRecord
+{
+    EchosounderNmeaSentence_t sentence;
+    char talker[3];
+    int64_t host_time_us;   /* host monotonic clock when the bytes ending the sentence were read from the port */
+    int64_t utc_time_us;    /* host_time_us converted to device UTC by the clock model, 0 until the first ZDA */
+
+    union
+    {
+        struct EchosounderNmeaDBT dbt;
+        struct EchosounderNmeaDPT dpt;
+        struct EchosounderNmeaMTW mtw;
+        struct EchosounderNmeaXDR xdr;
+        struct EchosounderNmeaEMA ema;
+        struct EchosounderNmeaZDA zda;
+    } data;
+};
+
+typedef struct EchosounderNmeaRecord EchosounderNmeaRecord_t;
+
+/*
+ *  Result of a single triggered ping (#pingonce mode)
+ */
+struct EchosounderPing
+{
+    int64_t latency_us;                                 /* from sending the trigger to the end of the ping output, -1 if failed */
+    size_t count;                                       /* number of records */
+    EchosounderNmeaRecord_t records[PING_RECORDS_SIZE]; /* records of the ping, further ones go to the record queue */
+};
+
+typedef struct EchosounderPing EchosounderPing_t;
+
+struct EchosounderNmeaStatistics
+{
+    uint64_t sentences;         /* sentences parsed into records */
+    uint64_t checksum_errors;   /* sentences dropped because of checksum mismatch */
+    uint64_t malformed;         /* sentences dropped because of missing checksum, bad fields or overlong body */
+    uint64_t unsupported;       /* valid sentences of types not listed in EchosounderNmeaSentence */
+    uint64_t dropped;           /* records dropped because record queue was full */
+};
+
+typedef struct EchosounderNmeaStatistics EchosounderNmeaStatistics_t;
+
+/*
+ *  Relation of the device UTC clock (ZDA) to the host monotonic clock:
+ *  device_us = host_us + offset_us + drift_ppm * 1e-6 * (host_us - reference_us)
+ */
+struct EchosounderClockState
+{
+    int64_t offset_us;          /* device minus host time at reference_us, includes transmission delay */
+    int64_t reference_us;       /* host time of the newest sample */
+    double drift_ppm;           /* device clock rate relative to the host clock */
+    double residual_us;         /* RMS error of the fit */
+    size_t samples;             /* samples in the window */
+};
+
+typedef struct EchosounderClockState EchosounderClockState_t;
+
+/*
+ *  Frequency channels of a dual frequency echosounder, told apart by the talker of the sentence (SH, SL)
+ */
+enum EchosounderChannel
+{
+    ChannelHigh = 0,
+    ChannelLow,
+    ChannelCount
+};
+
+typedef enum EchosounderChannel EchosounderChannel_t;
+
+/*
+ *  High and low frequency records of the same sentence type from one ping cycle,
+ *  receive times are host_time_us of the records
+ */
+struct EchosounderChannelPair
+{
+    EchosounderNmeaRecord_t high;
+    EchosounderNmeaRecord_t low;
+};
+
+typedef struct EchosounderChannelPair EchosounderChannelPair_t;
+
+struct EchosounderChannelStatistics
+{
+    uint64_t records[ChannelCount];     /* records of every channel */
+    uint64_t dropped[ChannelCount];     /* records dropped because the channel queue was full */
+    uint64_t pairs;                     /* aligned pairs */
+    uint64_t pairs_dropped;             /* pairs dropped because the pair queue was full */
+    uint64_t unmatched;                 /* records without the other channel in the same cycle */
+};
+
+typedef struct EchosounderChannelStatistics EchosounderChannelStatistics_t;
+
+/*
+ *  Entries of a recording: raw bytes received from the echosounder, records parsed from them
+ *  and snapshots of the echosounder settings, written at the start of every segment and after changes
+ */
+enum EchosounderRecordingEntryType
+{
+    RecordingData = 1,
+    RecordingRecord,
+    RecordingSettings
+};
+
+typedef enum EchosounderRecordingEntryType EchosounderRecordingEntryType_t;
+
+struct EchosounderRecordingEntry
+{
+    EchosounderRecordingEntryType_t type;
+    int64_t time_us;                    /* host clock at receipt, shifted to UTC when the recording was started */
+    const uint8_t *data;                /* raw bytes, EchosounderNmeaRecord_t or settings text; valid until the recording is closed */
+    size_t size;
+};
+
+typedef struct EchosounderRecordingEntry EchosounderRecordingEntry_t;
+
+struct EchosounderRecordingStatistics
+{
+    uint64_t entries;                   /* entries written to segments */
+    uint64_t bytes;                     /* bytes of segments in use */
+    uint64_t dropped;                   /* entries dropped because the recording buffer was full or writing failed */
+    uint32_t segments;                  /* segment files created */
+    uint32_t failed;                    /* 1 - segment could not be created, recording stopped */
+};
+
+typedef struct EchosounderRecordingStatistics EchosounderRecordingStatistics_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !ECHOSOUNDERNMEA_H
@@ -0,0 +1,93 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(ECHOSOUNDERREACTOR_H)
+#define ECHOSOUNDERREACTOR_H
+
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <set>
+
+#include "Echosounder.h"
+
+/**
+    @class EchosounderReactor
+
+    Serves many echosounders from one thread. Descriptors of registered echosounders are
+    watched by epoll, incoming data and asynchronous commands are handled by
+    Echosounder::ProcessIO(), so no command or reader thread is needed per unit.
+    Completion callbacks of asynchronous commands are called on the reactor thread.
+    A port which hangs up or fails is no longer watched, its commands complete with -2
+    until the echosounder is unregistered. Linux only.
+ */
+
+class EchosounderReactor
+{
+public:
+
+    /**
+    *   @brief Create epoll instance and start the reactor thread, throws std::runtime_error in case of failure
+    */
+    EchosounderReactor();
+
+    /**
+    *   @brief Unregister remaining echosounders and stop the reactor thread
+    */
+    ~EchosounderReactor();
+
+    EchosounderReactor(const EchosounderReactor &) = delete;
+    EchosounderReactor &operator=(const EchosounderReactor &) = delete;
+
+    /**
+    *   @brief Switch echosounder to event-driven mode and serve it by the reactor thread
+    *   @param BufferSize - size of the streaming buffer read by ReadData()
+    *   @return true - registered, false - already registered or the transport can not be polled
+    */
+    bool Register(Echosounder &Device, std::size_t BufferSize);
+
+    /**
+    *   @brief Stop serving echosounder and return it to the threaded mode. Waits until the reactor
+    *   thread leaves the echosounder, so must not be called from a completion callback.
+    *   @return true - unregistered, false - echosounder is not registered
+    */
+    bool Unregister(Echosounder &Device);
+
+private:
+
+    struct Entry
+    {
+        Echosounder *device;
+        bool polled;
+        bool writing;
+        bool failed;
+    };
+
+    int epoll_fd_;
+    int wake_fd_;
+    std::thread thread_;
+
+    /**
+    *   Changes requested by Register()/Unregister(), applied by the reactor thread
+    */
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<Echosounder *> added_;
+    std::vector<Echosounder *> removed_;
+    std::set<Echosounder *> registered_;
+    bool stop_;
+
+    /**
+    *   Served echosounders, owned by the reactor thread
+    */
+    std::vector<Entry> entries_;
+
+    void Wake();
+    void ApplyChanges();
+    int GetTimeoutMs() const;
+    void Fail(Entry &Item);
+    void Process(Entry &Item);
+    void Run();
+};
+
+#endif // ECHOSOUNDERREACTOR_H
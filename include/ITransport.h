@@ -0,0 +1,75 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <string>
+
+/**
+ *  @class ITransport
+ *  Interface class for the byte stream used to talk to the echosounder
+ */
+
+class ITransport
+{
+public:
+
+    virtual ~ITransport();
+
+    /**
+    *   @brief Read bytes which are already received, never blocks
+    *   @return number of bytes read
+    */
+    virtual std::size_t Read(uint8_t *Buffer, std::size_t Size) = 0;
+
+    /**
+    *   @brief Write all given bytes, waiting for the port to take them until deadline
+    *   @return number of bytes written, less than Size - deadline expired or port failed
+    */
+    virtual std::size_t Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline) = 0;
+
+    /**
+    *   @brief Write as many bytes as the port accepts without blocking, used by event loops.
+    *   Default implementation makes one attempt by Write() with deadline of now.
+    *   @return number of bytes written, 0 - port is not writable now
+    */
+    virtual std::size_t WriteSome(const uint8_t *Data, std::size_t Size);
+
+    /**
+    *   @brief Block until data can be read or deadline expires
+    *   @return true - data can be read, false - deadline expired
+    */
+    virtual bool WaitReadable(std::chrono::steady_clock::time_point Deadline) = 0;
+
+    /**
+    *   @brief Interrupt waiting. While interrupted, WaitReadable() returns false immediately,
+    *   including a wait already in progress on another thread.
+    */
+    virtual void SetInterrupted(bool Interrupted) = 0;
+
+    /**
+    *   @brief Wait until all written bytes are transmitted
+    */
+    virtual void Flush() = 0;
+
+    /**
+    *   @brief Change baudrate of the port, used to scan for echosounder speed
+    *   @return true - baudrate is changed, false - baudrate is not supported by the transport
+    */
+    virtual bool SetBaudrate(uint32_t Baudrate);
+
+    /**
+    *   @brief Get baudrate of the port, used to estimate command timeouts
+    *   @return baudrate, 0 - not known
+    */
+    virtual uint32_t GetBaudrate() const;
+
+    /**
+    *   @brief Get descriptor which becomes readable when data arrives, used by event loops
+    *   @return descriptor, -1 - transport can not be polled
+    */
+    virtual int GetFd() const;
+
+    std::size_t Write(const std::string &Data, std::chrono::steady_clock::time_point Deadline);
+};
@@ -0,0 +1,64 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(INFOPARSER_H)
+#define INFOPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "EchosounderCommands.h"
+#include "EchosounderCommandTable.h"
+#include "SettingsStore.h"
+
+/**
+    @class InfoParser
+
+    Single pass parser for the #info response. Lines look like
+    " - #range [ 50000 mm ] Range" or " S/W Ver: 1.05 ...", the key of every line
+    is looked up in a table built once from the command list, so each line costs one
+    binary search instead of matching it against every command.
+ */
+
+class InfoParser
+{
+public:
+
+    /**
+    *   @brief Build key lookup for given command list, key is info_key of the command
+    */
+    InfoParser(const EchosounderCommandTable &CommandList);
+
+    /**
+    *   @brief Parse #info response and store values of all known keys into Settings
+    *   @return number of values found
+    */
+    std::size_t Parse(const std::string &Info, SettingsStore &Settings) const;
+
+private:
+
+    struct Key
+    {
+        std::string name;
+        EchosounderCommandIds_t id;
+
+        bool operator<(const Key &Other) const
+        {
+            return name < Other.name;
+        }
+    };
+
+    /**
+    *   Keys sorted by name
+    */
+    std::vector<Key> keys_;
+
+    /**
+    *   Command which value is the frequency of the line ending with "(Active)", if command list has one
+    */
+    bool has_active_;
+    EchosounderCommandIds_t active_id_;
+
+    const Key *Find(const char *Name, std::size_t Length) const;
+};
+
+#endif // INFOPARSER_H
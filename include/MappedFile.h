@@ -0,0 +1,67 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(MAPPEDFILE_H)
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+    @class MappedFile
+
+    File mapped into memory as a whole, writable files are created with fixed size and
+    shrunk to the used size when closed. Writes are plain memory copies, the system
+    writes pages back to the file in the background.
+ */
+
+class MappedFile
+{
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+    *   @brief Create file of Size bytes (replacing existing one) and map it for writing
+    *   @return false - file can not be created or mapped
+    */
+    bool Create(const std::string &Path, std::size_t Size);
+
+    /**
+    *   @brief Map existing file for reading, the file may still be written by another mapping
+    *   @return false - file does not exist, is empty or can not be mapped
+    */
+    bool Open(const std::string &Path);
+
+    /**
+    *   @brief Start writing modified pages back to the file, does not wait for completion
+    */
+    void Sync();
+
+    /**
+    *   @brief Unmap the file, a created file is shrunk to UsedSize bytes
+    */
+    void Close(std::size_t UsedSize = 0);
+
+    bool IsOpen() const;
+    uint8_t *Data() const;
+    std::size_t Size() const;
+
+private:
+
+    uint8_t *data_;
+    std::size_t size_;
+    bool writable_;
+
+#if defined(_WIN32)
+    void *file_;
+    void *mapping_;
+#else
+    int fd_;
+#endif
+};
+
+#endif // MAPPEDFILE_H
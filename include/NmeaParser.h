@@ -0,0 +1,82 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(NMEAPARSER_H)
+#define NMEAPARSER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+#include "EchosounderNmea.h"
+
+/**
+    @class NmeaParser
+
+    Incremental NMEA 0183 parser for the sentences sent by the echosounder.
+    Bytes can be fed in any chunks, a sentence split across reads is completed on a later Feed().
+    Sentence is reported as soon as its checksum is received, nothing is allocated per sentence.
+ */
+
+class NmeaParser
+{
+public:
+
+    /**
+    *   Maximum sentence length without "$" and checksum, NMEA 0183 limits whole sentence to 82 characters
+    */
+    static const std::size_t MaxBodySize = 82U;
+
+    NmeaParser();
+
+    /**
+    *   @brief Feed received bytes, stops right after a sentence is complete
+    *   @param Complete - set to true if a record is complete, it can be obtained by GetRecord()
+    *   @return number of bytes consumed
+    */
+    std::size_t Feed(const uint8_t *Data, std::size_t Size, bool &Complete);
+
+    /**
+    *   @brief Get last completed record
+    */
+    const EchosounderNmeaRecord &GetRecord() const;
+
+    /**
+    *   @brief Get parser statistics, can be called from any thread. dropped is always 0.
+    */
+    void GetStatistics(EchosounderNmeaStatistics &Statistics) const;
+
+    /**
+    *   @brief Drop partially received sentence
+    */
+    void Reset();
+
+private:
+
+    enum State
+    {
+        StateIdle,
+        StateBody,
+        StateChecksumHigh,
+        StateChecksumLow
+    };
+
+    State state_;
+    char body_[MaxBodySize + 1];
+    std::size_t body_size_;
+    uint8_t checksum_;
+    uint8_t received_checksum_;
+
+    EchosounderNmeaRecord record_;
+
+    std::atomic<uint64_t> sentences_;
+    std::atomic<uint64_t> checksum_errors_;
+    std::atomic<uint64_t> malformed_;
+    std::atomic<uint64_t> unsupported_;
+
+    /**
+    *   @brief Parse body_ into record_
+    *   @return 1 - record parsed, 0 - unsupported sentence, -1 - malformed sentence
+    */
+    int ParseBody();
+};
+
+#endif // NMEAPARSER_H
@@ -0,0 +1,64 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(POSIXTRANSPORT_H)
+#define POSIXTRANSPORT_H
+
+#include <string>
+
+#include "ITransport.h"
+
+/**
+    @class PosixTransport
+
+    Transport over a POSIX tty opened in raw non-blocking mode.
+    Waiting for data blocks in poll() on the port descriptor, so an idle port costs no CPU
+    and a waiting thread wakes up as soon as data arrives.
+ */
+
+class PosixTransport : public ITransport
+{
+    /**
+    *   Port file descriptor
+    */
+    int fd_;
+
+    /**
+    *   Current baudrate of the port
+    */
+    uint32_t baudrate_;
+
+    /**
+    *   Pipe used to wake up poll() in WaitReadable(), readable while interrupted
+    */
+    int interrupt_fds_[2];
+
+    void ClosePipe();
+
+public:
+
+    /**
+        Constructor, opens the port. Throws std::runtime_error in case of failure.
+    */
+    PosixTransport(const std::string &PortPath, uint32_t Baudrate);
+    virtual ~PosixTransport();
+
+    PosixTransport(const PosixTransport &) = delete;
+    PosixTransport &operator=(const PosixTransport &) = delete;
+
+    /**
+    *   @brief Get port file descriptor
+    */
+    virtual int GetFd() const override;
+
+    using ITransport::Write;
+
+    virtual std::size_t Read(uint8_t *Buffer, std::size_t Size) override;
+    virtual std::size_t Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline) override;
+    virtual std::size_t WriteSome(const uint8_t *Data, std::size_t Size) override;
+    virtual bool WaitReadable(std::chrono::steady_clock::time_point Deadline) override;
+    virtual void SetInterrupted(bool Interrupted) override;
+    virtual void Flush() override;
+    virtual bool SetBaudrate(uint32_t Baudrate) override;
+    virtual uint32_t GetBaudrate() const override;
+};
+
+#endif // POSIXTRANSPORT_H
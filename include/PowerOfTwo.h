@@ -0,0 +1,23 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(POWEROFTWO_H)
+#define POWEROFTWO_H
+
+#include <cstddef>
+
+/**
+*   @brief Smallest power of two not less than Value, capacities of the lock-free rings are rounded to it
+*   so positions wrap by a mask
+*/
+inline std::size_t RoundUpToPowerOfTwo(std::size_t Value)
+{
+    std::size_t result = 1;
+
+    while (result < Value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+#endif // POWEROFTWO_H
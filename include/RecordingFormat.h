@@ -0,0 +1,75 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(RECORDINGFORMAT_H)
+#define RECORDINGFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+ *  Recording is a sequence of segment files <path>.000000.esr, <path>.000001.esr, ...
+ *  Segment layout: header (RECORDING_HEADER_SIZE bytes), sparse index of index_capacity
+ *  entries, then data: entries of RecordingEntryHeader followed by payload padded to 8 bytes.
+ *  Entries are only appended; data_size and index_count are updated after the entry is
+ *  complete, so a segment which is still written (or was not closed) is read up to them.
+ *  Numbers are stored in host byte order. Record entries hold EchosounderNmeaRecord as it is
+ *  in memory, settings entries hold text lines "<command id> <command text> <value>\n".
+ */
+
+#define RECORDING_MAGIC "ESRECSEG"
+#define RECORDING_VERSION 1U
+#define RECORDING_HEADER_SIZE 4096U
+#define RECORDING_ALIGNMENT 8U
+
+struct RecordingSegmentHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t segment;               // number of the segment in the recording
+    uint32_t record_size;           // sizeof(EchosounderNmeaRecord) of the writer
+    uint32_t closed;                // 1 - segment was closed by the writer
+    uint64_t index_offset;          // offsets from the start of the file
+    uint64_t index_capacity;
+    uint64_t data_offset;
+    uint64_t data_capacity;
+    int64_t utc_offset_us;          // host UTC minus host monotonic clock when the recording was started
+    int64_t begin_time_us;          // time of the first entry, 0 - segment is empty
+    int64_t end_time_us;            // time of the last entry
+    uint64_t index_count;           // committed index entries
+    uint64_t data_size;             // committed data bytes
+};
+
+/*
+ *  Index entry is added when RECORDING_INDEX_INTERVAL_US passed since the previous one,
+ *  offsets are relative to data_offset
+ */
+struct RecordingIndexEntry
+{
+    int64_t time_us;
+    uint64_t offset;                // first entry at or after time_us
+    uint64_t settings_offset;       // last settings entry before offset
+    uint64_t reserved;
+};
+
+struct RecordingEntryHeader
+{
+    uint32_t size;                  // payload bytes without padding
+    uint32_t type;                  // EchosounderRecordingEntryType
+    int64_t time_us;
+};
+
+inline std::size_t RecordingEntrySize(std::size_t PayloadSize)
+{
+    return sizeof(RecordingEntryHeader) + ((PayloadSize + RECORDING_ALIGNMENT - 1) & ~std::size_t(RECORDING_ALIGNMENT - 1));
+}
+
+inline std::string RecordingSegmentPath(const std::string &Path, uint32_t Segment)
+{
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), ".%06u.esr", static_cast<unsigned int>(Segment));
+
+    return Path + suffix;
+}
+
+#endif // RECORDINGFORMAT_H
@@ -0,0 +1,95 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(RECORDINGREADER_H)
+#define RECORDINGREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EchosounderCommands.h"
+#include "EchosounderNmea.h"
+#include "MappedFile.h"
+#include "RecordingFormat.h"
+
+/**
+    @class RecordingReader
+
+    Reads a recording written by RecordingWriter. All segments are mapped when the recording
+    is opened, entries are returned as pointers into the mapping without copying. Seek finds
+    the segment and then the index entry by binary search, and scans at most one index
+    interval from there. Segments still written by another process are read up to the last
+    complete entry; segments created after Open() are not seen.
+ */
+
+class RecordingReader
+{
+public:
+
+    RecordingReader();
+
+    RecordingReader(const RecordingReader &) = delete;
+    RecordingReader &operator=(const RecordingReader &) = delete;
+
+    /**
+    *   @brief Map segments <Path>.000000.esr, <Path>.000001.esr, ... and go to the first entry
+    *   @return false - the first segment is missing or is not a recording of this library build
+    */
+    bool Open(const std::string &Path);
+
+    void Close();
+
+    /**
+    *   @brief Get time of the first and the last entry
+    *   @return false - recording is empty
+    */
+    bool GetTimeRange(int64_t &BeginUs, int64_t &EndUs) const;
+
+    /**
+    *   @brief Get host UTC minus host monotonic clock of the recording, converts host_time_us of records
+    */
+    int64_t GetUtcOffset() const;
+
+    /**
+    *   @brief Go to the first entry at or after TimeUs
+    *   @return false - there is no such entry, position is at the end
+    */
+    bool Seek(int64_t TimeUs);
+
+    /**
+    *   @brief Read entry at the current position and advance
+    *   @return false - end of the recording
+    */
+    bool Read(EchosounderRecordingEntry &Entry);
+
+    /**
+    *   @brief Get value from the settings snapshot in effect at the current position
+    *   @return false - value is not in the snapshot
+    */
+    bool GetValue(EchosounderCommandIds Command, std::string &Value) const;
+
+private:
+
+    struct Segment
+    {
+        std::unique_ptr<MappedFile> file;
+        const RecordingSegmentHeader *header;
+        const RecordingIndexEntry *index;
+        const uint8_t *data;
+    };
+
+    std::vector<Segment> segments_;
+
+    /**
+    *   Position: segment and offset in its data, settings entry in effect there (nullptr - none)
+    */
+    std::size_t segment_;
+    uint64_t offset_;
+    const RecordingEntryHeader *settings_;
+
+    static bool IsValid(const MappedFile &File);
+    const RecordingEntryHeader *EntryAt(const Segment &Item, uint64_t Offset) const;
+};
+
+#endif // RECORDINGREADER_H
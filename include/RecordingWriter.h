@@ -0,0 +1,115 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(RECORDINGWRITER_H)
+#define RECORDINGWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "EchosounderNmea.h"
+#include "MappedFile.h"
+#include "RecordingFormat.h"
+#include "RingBuffer.h"
+
+/**
+    @class RecordingWriter
+
+    Writes a recording (see RecordingFormat.h). The thread producing data only copies entries
+    into a lock-free ring and never waits; a writer thread moves them into memory-mapped
+    segment files, keeps the sparse time index and starts new segments with a settings snapshot.
+    Entries which do not fit into the ring are dropped and counted.
+ */
+
+class RecordingWriter
+{
+public:
+
+    /**
+    *   Returns text of current settings, called on the writer thread
+    */
+    typedef std::function<std::string()> SettingsSource;
+
+    /**
+    *   @param BufferSize - size of the ring between the producer and the writer thread, 0 - default
+    */
+    RecordingWriter(std::size_t BufferSize);
+
+    /**
+    *   @brief Write remaining entries and close the recording
+    */
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter &) = delete;
+    RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+    /**
+    *   @brief Create the first segment and start the writer thread
+    *   @param SegmentSize - size of segment files, 0 - default
+    *   @return false - already open or the segment can not be created
+    */
+    bool Open(const std::string &Path, std::size_t SegmentSize, SettingsSource Settings);
+
+    /**
+    *   @brief Write remaining entries, stop the writer thread and shrink the last segment
+    */
+    void Close();
+
+    /**
+    *   @brief Queue entry, producer side, never blocks
+    *   @param TimeUs - host monotonic time (ClockModel::MonotonicUs()) when the data was received
+    *   @return false - ring is full or recording failed, entry is dropped
+    */
+    bool Append(EchosounderRecordingEntryType Type, int64_t TimeUs, const void *Data, std::size_t Size);
+
+    /**
+    *   @brief Request a settings snapshot before the next entry, may be called from any thread
+    */
+    void SettingsChanged();
+
+    void GetStatistics(EchosounderRecordingStatistics &Statistics) const;
+
+private:
+
+    RingBuffer ring_;
+    std::string path_;
+    std::size_t segment_size_;
+    SettingsSource settings_;
+    int64_t utc_offset_us_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+
+    std::atomic<bool> settings_changed_;
+    std::atomic<bool> failed_;
+    std::atomic<uint64_t> entries_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint32_t> segments_;
+
+    /**
+    *   Current segment, owned by the writer thread after Open()
+    */
+    MappedFile file_;
+    RecordingSegmentHeader *header_;
+    RecordingIndexEntry *index_;
+    uint8_t *data_;
+    uint64_t settings_offset_;
+    int64_t next_index_us_;
+
+    bool OpenSegment(uint32_t Segment);
+    void CloseSegment();
+    bool Fits(std::size_t PayloadSize) const;
+    void WriteEntry(uint32_t Type, int64_t TimeUs, const uint8_t *Payload, std::size_t Size);
+    void WriteSettings(int64_t TimeUs, const std::string &Text);
+    bool WriteNext();
+    void WriterThread();
+};
+
+#endif // RECORDINGWRITER_H
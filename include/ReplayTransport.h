@@ -0,0 +1,94 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(REPLAYTRANSPORT_H)
+#define REPLAYTRANSPORT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include "ITransport.h"
+#include "RecordingReader.h"
+
+/**
+    @class ReplayTransport
+
+    Transport which plays back data entries of a recording (see Echosounder::StartRecording),
+    so the recorded output goes through the parsing path of the library again. After Play()
+    every entry becomes readable at its recorded time relative to the first one, divided by
+    the speed, or at once when the speed is 0. Timing is kept per recorded read, bytes of one
+    read arrive together. Written commands are discarded and never answered, so only data
+    reading, streaming and records are meaningful on a replayed echosounder, which is constructed
+    without detection (Detected is nullptr). Timing starts at Play().
+ */
+
+class ReplayTransport : public ITransport
+{
+public:
+
+    /**
+        Constructor, opens the recording. Throws std::runtime_error in case of failure.
+        @param Speed - 1.0 recorded timing, 2.0 twice as fast, 0 - as fast as possible
+    */
+    ReplayTransport(const std::string &Path, double Speed);
+    virtual ~ReplayTransport();
+
+    ReplayTransport(const ReplayTransport &) = delete;
+    ReplayTransport &operator=(const ReplayTransport &) = delete;
+
+    using ITransport::Write;
+
+    virtual std::size_t Read(uint8_t *Buffer, std::size_t Size) override;
+    virtual std::size_t Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline) override;
+    virtual bool WaitReadable(std::chrono::steady_clock::time_point Deadline) override;
+    virtual void SetInterrupted(bool Interrupted) override;
+    virtual void Flush() override;
+
+    /**
+    *   @brief Start playing, the first entry is readable at once
+    */
+    void Play();
+
+    /**
+    *   @brief Continue from the first data at or after TimeUs (recording time), timing starts again
+    *   @return false - no data at or after TimeUs, playing is finished
+    */
+    bool Seek(int64_t TimeUs);
+
+    /**
+    *   @brief Checking whether all data of the recording was read
+    */
+    bool IsFinished() const;
+
+    /**
+    *   @brief Get number of bytes read since the recording was opened
+    */
+    uint64_t GetBytes() const;
+
+private:
+
+    RecordingReader reader_;
+    double speed_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    bool interrupted_;
+
+    /**
+    *   Data entry being played and bytes of it already read, entry_.data is nullptr at the end
+    */
+    EchosounderRecordingEntry entry_;
+    std::size_t entry_read_;
+    uint64_t bytes_;
+
+    /**
+    *   Entry at origin_us_ of the recording is due at origin_
+    */
+    bool playing_;
+    std::chrono::steady_clock::time_point origin_;
+    int64_t origin_us_;
+
+    void NextEntry();
+    std::chrono::steady_clock::time_point DueTime() const;
+};
+
+#endif // REPLAYTRANSPORT_H
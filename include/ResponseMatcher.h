@@ -0,0 +1,79 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(RESPONSEMATCHER_H)
+#define RESPONSEMATCHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+    @class ResponseMatcher
+
+    Streaming matcher for the tokens the echosounder sends back after a command.
+    All tokens are compiled into a single automaton, so every received byte costs
+    one table lookup regardless of how many tokens are searched for. The matcher
+    keeps its state between Feed() calls, so tokens split across reads are found.
+ */
+
+class ResponseMatcher
+{
+public:
+
+    /**
+    *   Tokens recognized by the matcher
+    */
+    enum Token
+    {
+        TokenOk = 0,
+        TokenOkGo,
+        TokenInvalidCommand,
+        TokenInvalidArgument,
+        TokenPrompt,
+        TokenCount
+    };
+
+    /**
+    *   Token masks used to select which tokens Feed() reports
+    */
+    static const uint32_t ResponseTokens = (1U << TokenOk) | (1U << TokenOkGo) | (1U << TokenInvalidCommand) | (1U << TokenInvalidArgument);
+    static const uint32_t PromptTokens = (1U << TokenPrompt);
+
+    ResponseMatcher();
+
+    /**
+    *   @brief Forget all bytes fed so far
+    */
+    void Reset();
+
+    /**
+    *   @brief Feed received bytes into the matcher
+    *   @param data - received bytes
+    *   @param size - number of received bytes
+    *   @param mask - tokens to report, matches of other tokens are ignored
+    *   @param consumed - number of bytes consumed, bytes after the matched token are left to the caller
+    *   @return matched token or -1 if no token in mask was found in given bytes
+    */
+    int Feed(const uint8_t *data, std::size_t size, uint32_t mask, std::size_t &consumed);
+
+private:
+
+    /**
+    *   Automaton shared by all matchers, built on first use
+    */
+    struct Automaton
+    {
+        std::vector<uint8_t> transitions;
+        std::vector<int8_t> outputs;
+
+        Automaton();
+    };
+
+    static const Automaton &GetAutomaton();
+
+    /**
+    *   Current automaton state
+    */
+    uint8_t state_;
+};
+
+#endif // RESPONSEMATCHER_H
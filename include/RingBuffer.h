@@ -0,0 +1,85 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(RINGBUFFER_H)
+#define RINGBUFFER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <vector>
+
+/**
+*   Contiguous views of data inside a buffer, second part is used when data wraps around
+*/
+struct DataView
+{
+    const uint8_t *first;
+    std::size_t first_size;
+    const uint8_t *second;
+    std::size_t second_size;
+};
+
+/**
+    @class RingBuffer
+
+    Fixed-size lock-free byte ring for exactly one producer thread and one consumer thread.
+    Capacity is rounded up to a power of two.
+ */
+
+class RingBuffer
+{
+    /**
+    *   Storage, capacity is storage size
+    */
+    std::vector<uint8_t> storage_;
+
+    /**
+    *   storage_.size() - 1, used to wrap positions
+    */
+    std::size_t mask_;
+
+    /**
+    *   Free running positions, written only by producer (head_) or consumer (tail_)
+    */
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+
+public:
+
+    RingBuffer(std::size_t Capacity);
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    /**
+    *   @brief Append bytes, producer side
+    *   @return number of bytes written, less than Size if the ring is full
+    */
+    std::size_t Write(const uint8_t *Data, std::size_t Size);
+
+    /**
+    *   @brief Take bytes out, consumer side
+    *   @return number of bytes read
+    */
+    std::size_t Read(uint8_t *Buffer, std::size_t Size);
+
+    /**
+    *   @brief Get view of available bytes without copying them, consumer side.
+    *   Views stay valid until the bytes are consumed.
+    *   @return number of bytes available
+    */
+    std::size_t Peek(DataView &View) const;
+
+    /**
+    *   @brief Release bytes obtained by Peek(), consumer side
+    */
+    void Consume(std::size_t Size);
+
+    /**
+    *   @brief Number of bytes available for consumer
+    */
+    std::size_t Size() const;
+
+    std::size_t Capacity() const;
+};
+
+#endif // RINGBUFFER_H
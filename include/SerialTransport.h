@@ -0,0 +1,61 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(SERIALTRANSPORT_H)
+#define SERIALTRANSPORT_H
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+#include "serial/serial.h"
+#include "ITransport.h"
+
+/**
+    @class SerialTransport
+
+    Transport over serial::Serial, available on every platform supported by the serial library.
+ */
+
+class SerialTransport : public ITransport
+{
+    /**
+    *   Serial port class used by transport
+    */
+    std::shared_ptr<serial::Serial> serial_port_;
+
+    /**
+    *   Set by SetInterrupted(), checked between port waits
+    */
+    std::atomic<bool> interrupted_;
+
+    /**
+    *   Byte read while waiting for data on Windows, returned first by Read()
+    */
+    std::mutex pending_mutex_;
+    uint8_t pending_;
+    bool has_pending_;
+
+    bool HasPending();
+
+public:
+
+    SerialTransport(std::shared_ptr<serial::Serial> SerialPort);
+    virtual ~SerialTransport();
+
+    /**
+    *   @brief Get serial port used by the transport.
+    *   @return std::shared_ptr<serial::Serial> reference
+    */
+    std::shared_ptr<serial::Serial> &GetSerialPort();
+
+    using ITransport::Write;
+
+    virtual std::size_t Read(uint8_t *Buffer, std::size_t Size) override;
+    virtual std::size_t Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline) override;
+    virtual bool WaitReadable(std::chrono::steady_clock::time_point Deadline) override;
+    virtual void SetInterrupted(bool Interrupted) override;
+    virtual void Flush() override;
+    virtual bool SetBaudrate(uint32_t Baudrate) override;
+    virtual uint32_t GetBaudrate() const override;
+};
+
+#endif // SERIALTRANSPORT_H
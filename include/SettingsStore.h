@@ -0,0 +1,100 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(SETTINGSSTORE_H)
+#define SETTINGSSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "EchosounderCommands.h"
+#include "EchosounderCommandTable.h"
+
+/**
+    @class SettingsStore
+
+    Current settings of the echosounder, one entry per command id.
+    Value text is parsed once when it is stored, so numeric getters only copy the stored number.
+    Every entry also keeps the value last confirmed by the echosounder; values staged by the
+    user which differ from it are dirty until they are sent.
+ */
+
+class SettingsStore
+{
+public:
+
+    /**
+    *   @brief Create empty store, value types are taken from the command table
+    */
+    SettingsStore(const EchosounderCommandTable &CommandList);
+
+    /**
+    *   @brief Store value confirmed by the echosounder, entry is not dirty after this
+    *   @return true - text is valid for the value type of the command, false - only text is stored
+    */
+    bool Set(EchosounderCommandIds Command, const char *Text, std::size_t Length);
+    bool Set(EchosounderCommandIds Command, const std::string &Text);
+
+    /**
+    *   @brief Store value to be sent later, entry is dirty if value differs from the confirmed one
+    *   @return true - text is valid for the value type of the command, false - only text is stored
+    */
+    bool Stage(EchosounderCommandIds Command, const std::string &Text);
+
+    /**
+    *   @brief Get dirty entries, bit per command id
+    */
+    uint64_t GetDirty() const;
+
+    /**
+    *   @brief Check whether the stored value equals given text, numbers are compared by value
+    */
+    bool Matches(EchosounderCommandIds Command, const std::string &Text) const;
+
+    /**
+    *   @brief Get value text, empty if value is not known
+    */
+    const std::string &GetText(EchosounderCommandIds Command) const;
+
+    /**
+    *   @brief Get value as integer, decimal values are truncated
+    *   @return true - value is known and numeric
+    */
+    bool GetLong(EchosounderCommandIds Command, long &Value) const;
+
+    /**
+    *   @brief Get value as decimal
+    *   @return true - value is known and numeric
+    */
+    bool GetFloat(EchosounderCommandIds Command, float &Value) const;
+
+    /**
+    *   @brief Get value type of the command
+    */
+    EchosounderValueType GetType(EchosounderCommandIds Command) const;
+
+private:
+
+    struct Entry;
+
+    static bool Parse(Entry &Item, const char *Text, std::size_t Length);
+
+    struct Entry
+    {
+        EchosounderValueType type;
+        bool numeric;
+        long integer;
+        float number;
+        std::string text;
+        std::string confirmed;
+    };
+
+    Entry entries_[EchosounderCommandCount];
+    uint64_t dirty_;
+
+    /**
+    *   Returned for ids out of range
+    */
+    const std::string empty_;
+};
+
+#endif // SETTINGSSTORE_H
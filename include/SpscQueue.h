@@ -0,0 +1,85 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#if !defined(SPSCQUEUE_H)
+#define SPSCQUEUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <vector>
+
+#include "PowerOfTwo.h"
+
+/**
+    @class SpscQueue
+
+    Fixed-size lock-free queue of trivially copyable items for exactly one producer thread
+    and one consumer thread. Capacity is rounded up to a power of two.
+ */
+
+template <typename T>
+class SpscQueue
+{
+    std::vector<T> storage_;
+    std::size_t mask_;
+
+    std::atomic<std::size_t> head_;
+    std::atomic<std::size_t> tail_;
+
+public:
+
+    SpscQueue(std::size_t Capacity) :
+        storage_(RoundUpToPowerOfTwo(Capacity)),
+        mask_(storage_.size() - 1),
+        head_(0),
+        tail_(0)
+    {
+
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+    *   @brief Append item, producer side
+    *   @return false - queue is full, item is not added
+    */
+    bool Push(const T &Item)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if ((head - tail_.load(std::memory_order_acquire)) == storage_.size())
+        {
+            return false;
+        }
+
+        storage_[head & mask_] = Item;
+        head_.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+    *   @brief Take oldest item, consumer side
+    *   @return false - queue is empty
+    */
+    bool Pop(T &Item)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail == head_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        Item = storage_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    std::size_t Size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,174 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "ClockModel.h"
+
+#include <chrono>
+#include <cmath>
+
+#define CLOCK_WINDOW_SIZE 64U
+#define CLOCK_SAMPLE_INTERVAL_US 1000000LL
+
+namespace
+{
+    /**
+    *   Days since 1970-01-01 of the civil date, proleptic Gregorian calendar
+    */
+    int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day)
+    {
+        year -= (month <= 2) ? 1 : 0;
+
+        const int64_t era = ((year >= 0) ? year : year - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(year - era * 400);
+        const unsigned doy = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+        return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+}
+
+ClockModel::ClockModel() :
+    reference_us_(0),
+    offset_us_(0.0),
+    drift_(0.0),
+    residual_us_(0.0)
+{
+
+}
+
+int64_t ClockModel::MonotonicUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ClockModel::ZdaToUtcUs(const EchosounderNmeaZDA &Zda, int64_t &UtcUs)
+{
+    if ((Zda.month < 1) || (Zda.month > 12) || (Zda.day < 1) || (Zda.day > 31) ||
+        (Zda.hour > 23) || (Zda.minute > 59) || (Zda.second > 60) || (Zda.year < 1970))
+    {
+        return false;
+    }
+
+    const int64_t days = DaysFromCivil(Zda.year, Zda.month, Zda.day);
+    const int64_t seconds = days * 86400 + Zda.hour * 3600 + Zda.minute * 60 + Zda.second;
+
+    UtcUs = seconds * 1000000LL + Zda.microsecond;
+
+    return true;
+}
+
+void ClockModel::AddSample(int64_t HostUs, int64_t DeviceUs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if ((false == samples_.empty()) && ((HostUs - samples_.back().host_us) < CLOCK_SAMPLE_INTERVAL_US))
+    {
+        return;
+    }
+
+    const Sample sample = { HostUs, DeviceUs };
+    samples_.push_back(sample);
+
+    if (samples_.size() > CLOCK_WINDOW_SIZE)
+    {
+        samples_.pop_front();
+    }
+
+    Fit();
+}
+
+void ClockModel::Reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    samples_.clear();
+    reference_us_ = 0;
+    offset_us_ = 0.0;
+    drift_ = 0.0;
+    residual_us_ = 0.0;
+}
+
+void ClockModel::Fit()
+{
+    // Difference device - host is fitted against host time relative to the newest sample, keeps doubles exact
+    reference_us_ = samples_.back().host_us;
+
+    const double count = static_cast<double>(samples_.size());
+    double sumx = 0.0;
+    double sumy = 0.0;
+
+    for (const Sample &sample : samples_)
+    {
+        sumx += static_cast<double>(sample.host_us - reference_us_);
+        sumy += static_cast<double>(sample.device_us - sample.host_us);
+    }
+
+    const double meanx = sumx / count;
+    const double meany = sumy / count;
+    double sxx = 0.0;
+    double sxy = 0.0;
+
+    for (const Sample &sample : samples_)
+    {
+        const double dx = static_cast<double>(sample.host_us - reference_us_) - meanx;
+        sxx += dx * dx;
+        sxy += dx * (static_cast<double>(sample.device_us - sample.host_us) - meany);
+    }
+
+    // One sample gives the offset only
+    drift_ = (sxx > 0.0) ? (sxy / sxx) : 0.0;
+    offset_us_ = meany - drift_ * meanx;
+
+    double sumsq = 0.0;
+
+    for (const Sample &sample : samples_)
+    {
+        const double x = static_cast<double>(sample.host_us - reference_us_);
+        const double error = static_cast<double>(sample.device_us - sample.host_us) - (offset_us_ + drift_ * x);
+        sumsq += error * error;
+    }
+
+    residual_us_ = std::sqrt(sumsq / count);
+}
+
+bool ClockModel::ToDevice(int64_t HostUs, int64_t &DeviceUs) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (true == samples_.empty())
+    {
+        return false;
+    }
+
+    const double x = static_cast<double>(HostUs - reference_us_);
+    DeviceUs = HostUs + static_cast<int64_t>(std::llround(offset_us_ + drift_ * x));
+
+    return true;
+}
+
+bool ClockModel::ToHost(int64_t DeviceUs, int64_t &HostUs) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (true == samples_.empty())
+    {
+        return false;
+    }
+
+    // device = host + offset + drift * (host - reference), solved for host
+    const double d = static_cast<double>(DeviceUs - reference_us_);
+    HostUs = reference_us_ + static_cast<int64_t>(std::llround((d - offset_us_) / (1.0 + drift_)));
+
+    return true;
+}
+
+bool ClockModel::GetState(EchosounderClockState &State) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    State.samples = samples_.size();
+    State.offset_us = static_cast<int64_t>(std::llround(offset_us_));
+    State.drift_ppm = drift_ * 1e6;
+    State.residual_us = residual_us_;
+    State.reference_us = reference_us_;
+
+    return (false == samples_.empty());
+}
@@ -0,0 +1,101 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "CommandTimeouts.h"
+
+#define COMMAND_LATENCY_MS 200U
+#define SLOWEST_BAUDRATE 9600U
+#define BITS_PER_BYTE 10U
+#define TRANSFER_MARGIN 2U
+#define PROMPT_BYTES 8U
+#define SHORT_RESPONSE_BYTES 64U
+#define LONG_RESPONSE_BYTES 256U
+#define INFO_LINE_BYTES 64U
+
+CommandTimeouts::CommandTimeouts(const EchosounderCommandTable &CommandList) :
+    baudrate_(0)
+{
+    std::size_t supported = 0;
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        if (false != CommandList.IsSupported(static_cast<EchosounderCommandIds>(i)))
+        {
+            supported++;
+        }
+    }
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        response_bytes_[i] = SHORT_RESPONSE_BYTES;
+        overrides_[i].response_ms = 0;
+        overrides_[i].prompt_ms = 0;
+    }
+
+    // #info prints a line per command, #version and #getf print a few lines
+    response_bytes_[IdInfo] = LONG_RESPONSE_BYTES + supported * INFO_LINE_BYTES;
+    response_bytes_[IdVersion] = LONG_RESPONSE_BYTES;
+    response_bytes_[IdGetWorkFreq] = LONG_RESPONSE_BYTES;
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        Update(i);
+    }
+}
+
+uint32_t CommandTimeouts::Estimate(std::size_t ResponseBytes, uint32_t Baudrate)
+{
+    const uint64_t baudrate = (0 != Baudrate) ? Baudrate : SLOWEST_BAUDRATE;
+    const uint64_t bits = static_cast<uint64_t>(ResponseBytes) * BITS_PER_BYTE * TRANSFER_MARGIN;
+
+    return COMMAND_LATENCY_MS + static_cast<uint32_t>((bits * 1000U + baudrate - 1) / baudrate);
+}
+
+void CommandTimeouts::Update(std::size_t Index)
+{
+    timeouts_[Index].response_ms = (0 != overrides_[Index].response_ms) ?
+        overrides_[Index].response_ms : Estimate(response_bytes_[Index], baudrate_);
+    timeouts_[Index].prompt_ms = (0 != overrides_[Index].prompt_ms) ?
+        overrides_[Index].prompt_ms : Estimate(PROMPT_BYTES, baudrate_);
+}
+
+void CommandTimeouts::SetBaudrate(uint32_t Baudrate)
+{
+    baudrate_ = Baudrate;
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        Update(i);
+    }
+}
+
+void CommandTimeouts::SetResponseSize(EchosounderCommandIds Command, std::size_t ResponseBytes)
+{
+    if (static_cast<unsigned>(Command) < EchosounderCommandCount)
+    {
+        response_bytes_[Command] = ResponseBytes;
+        Update(Command);
+    }
+}
+
+void CommandTimeouts::Set(EchosounderCommandIds Command, const EchosounderTimeout &Timeout)
+{
+    if (static_cast<unsigned>(Command) < EchosounderCommandCount)
+    {
+        overrides_[Command] = Timeout;
+        Update(Command);
+    }
+}
+
+void CommandTimeouts::Reset(EchosounderCommandIds Command)
+{
+    if (static_cast<unsigned>(Command) < EchosounderCommandCount)
+    {
+        overrides_[Command].response_ms = 0;
+        overrides_[Command].prompt_ms = 0;
+        Update(Command);
+    }
+}
+
+const EchosounderTimeout &CommandTimeouts::Get(EchosounderCommandIds Command) const
+{
+    return timeouts_[(static_cast<unsigned>(Command) < EchosounderCommandCount) ? Command : IdInfo];
+}
@@ -1,13 +1,155 @@
 // Copyright (c) EofE Ultrasonics Co., Ltd., 2024
 #include "DualEchosounder.h"
+#include "SerialTransport.h"
 
-DualEchosounder::DualEchosounder(std::shared_ptr<serial::Serial> SerialPort, std::map<int, EchosounderCommandList>& CommandList) :
-    Echosounder(SerialPort, CommandList)
+#define CHANNEL_RECORDS_SIZE 512U
+#define CHANNEL_PAIRS_SIZE 256U
+
+DualEchosounder::DualEchosounder(std::shared_ptr<ITransport> Transport, const EchosounderCommandTable &CommandList) :
+    DualEchosounder(Transport, nullptr, CommandList)
+{
+    DetectAndGetInfo();
+}
+
+DualEchosounder::DualEchosounder(std::shared_ptr<ITransport> Transport, const EchosounderDetectInfo *Detected, const EchosounderCommandTable &CommandList) :
+    Echosounder(Transport, Detected, CommandList),
+    channel_records_enabled_(false),
+    channel_pairs_enabled_(false),
+    high_records_(CHANNEL_RECORDS_SIZE),
+    low_records_(CHANNEL_RECORDS_SIZE),
+    pairs_(CHANNEL_PAIRS_SIZE),
+    pending_(),
+    pair_count_(0),
+    pairs_dropped_(0),
+    unmatched_(0)
+{
+    for (int channel = 0; channel < ChannelCount; channel++)
+    {
+        records_[channel].store(0);
+        dropped_[channel].store(0);
+    }
+}
+
+DualEchosounder::DualEchosounder(std::shared_ptr<serial::Serial> SerialPort, const EchosounderCommandTable &CommandList) :
+    DualEchosounder(std::make_shared<SerialTransport>(SerialPort), CommandList)
 {
 
 }
 
 DualEchosounder::~DualEchosounder()
 {
+    StopStreaming();
+    StopCommandThread();
+}
+
+void DualEchosounder::SetChannelOutput(bool Records, bool Pairs)
+{
+    channel_records_enabled_.store(Records);
+    channel_pairs_enabled_.store(Pairs);
+}
+
+bool DualEchosounder::ReadChannelRecord(EchosounderChannel Channel, EchosounderNmeaRecord &Record)
+{
+    return Queue(Channel).Pop(Record);
+}
+
+bool DualEchosounder::ReadChannelPair(EchosounderChannelPair &Pair)
+{
+    return pairs_.Pop(Pair);
+}
+
+void DualEchosounder::GetChannelStatistics(EchosounderChannelStatistics &Statistics) const
+{
+    for (int channel = 0; channel < ChannelCount; channel++)
+    {
+        Statistics.records[channel] = records_[channel].load(std::memory_order_relaxed);
+        Statistics.dropped[channel] = dropped_[channel].load(std::memory_order_relaxed);
+    }
+
+    Statistics.pairs = pair_count_.load(std::memory_order_relaxed);
+    Statistics.pairs_dropped = pairs_dropped_.load(std::memory_order_relaxed);
+    Statistics.unmatched = unmatched_.load(std::memory_order_relaxed);
+}
+
+SpscQueue<EchosounderNmeaRecord> &DualEchosounder::Queue(EchosounderChannel Channel)
+{
+    return (ChannelLow == Channel) ? low_records_ : high_records_;
+}
+
+void DualEchosounder::DispatchRecord(const EchosounderNmeaRecord &Record)
+{
+    const bool records = channel_records_enabled_.load();
+    const bool pairs = channel_pairs_enabled_.load();
+
+    if ((false == records) && (false == pairs))
+    {
+        Echosounder::DispatchRecord(Record);
+        return;
+    }
+
+    EchosounderChannel channel = ChannelCount;
+
+    if (('S' == Record.talker[0]) && ('H' == Record.talker[1]))
+    {
+        channel = ChannelHigh;
+    }
+    else if (('S' == Record.talker[0]) && ('L' == Record.talker[1]))
+    {
+        channel = ChannelLow;
+    }
+
+    // Common sentences and output of a single channel mode
+    if (ChannelCount == channel)
+    {
+        Echosounder::DispatchRecord(Record);
+        return;
+    }
+
+    records_[channel].fetch_add(1, std::memory_order_relaxed);
+
+    if ((false != records) && (false == Queue(channel).Push(Record)))
+    {
+        dropped_[channel].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (false != pairs)
+    {
+        Pair(channel, Record);
+    }
+}
+
+void DualEchosounder::Pair(EchosounderChannel Channel, const EchosounderNmeaRecord &Record)
+{
+    PendingHigh &pending = pending_[Record.sentence];
+
+    // Echosounder prints the high channel of a cycle before the low one
+    if (ChannelHigh == Channel)
+    {
+        if (false != pending.valid)
+        {
+            unmatched_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        pending.valid = true;
+        pending.record = Record;
+        return;
+    }
+
+    if (false == pending.valid)
+    {
+        unmatched_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    EchosounderChannelPair pair;
+    pair.high = pending.record;
+    pair.low = Record;
+    pending.valid = false;
+
+    pair_count_.fetch_add(1, std::memory_order_relaxed);
 
+    if (false == pairs_.Push(pair))
+    {
+        pairs_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
 }
@@ -1,364 +1,2184 @@
 // Copyright (c) EofE Ultrasonics Co., Ltd., 2024
 #include "Echosounder.h"
+#include "SerialTransport.h"
 
 #include <iostream>
+#include <algorithm>
 #include <initializer_list>
 #include <chrono>
-#include <deque>
 #include <iterator>
 #include <vector>
+#include <deque>
 #include <map>
+#include <cstdlib>
+
+#define RECEIVE_BUFFER_SIZE 512U
+#define NMEA_RECORDS_SIZE 1024U
+#define SETTINGS_PIPELINE_DEPTH 4U
+#define STOP_ATTEMPTS 3
+#define STOP_PROMPT_TIMEOUT_MS 100
+#define PROMPT_SIZE std::size_t(1) // ">"
+#define READ_TIMEOUT_MS 100
+#define PING_OUTPUT_BYTES 512U
+#define SOUND_SPEED_MIN_MPS 1300
+#define DEFAULT_BAUDRATE 9600U
+#define ZDA_SENTENCE_BYTES 38LL
+#define TIME_SYNC_MIN_SAMPLES 4U
+#define TIME_SYNC_MIN_BOUND_US 50000LL
+#define TIME_SYNC_HOLDOFF_US 60000000LL
+
+Echosounder::Echosounder(std::shared_ptr<serial::Serial> SerialPort, const EchosounderCommandTable &CommandList) :
+    Echosounder(std::make_shared<SerialTransport>(SerialPort), CommandList)
+{
+
+}
+
+Echosounder::Echosounder(std::shared_ptr<ITransport> Transport, const EchosounderCommandTable &CommandList) :
+    Echosounder(Transport, nullptr, CommandList)
+{
+    DetectAndGetInfo();
+}
 
-Echosounder::Echosounder(std::shared_ptr<serial::Serial> SerialPort, std::map<int, EchosounderCommandList>& CommandList) :
-    serial_port_(SerialPort),
+Echosounder::Echosounder(std::shared_ptr<ITransport> Transport, const EchosounderDetectInfo *Detected, const EchosounderCommandTable &CommandList) :
+    transport_(Transport),
+    rx_buffer_(RECEIVE_BUFFER_SIZE),
+    rx_begin_(0),
+    rx_end_(0),
+    info_parser_(CommandList),
+    echosounder_commands_(CommandList),
+    echosounder_settings_(CommandList),
+    command_timeouts_(CommandList),
+    deadline_(std::chrono::steady_clock::time_point::max()),
+    read_timeout_ms_(READ_TIMEOUT_MS),
+    stale_input_(false),
     is_running_(false),
-    echosounder_commands_(CommandList)
+    is_detected_(false),
+    detect_info_(),
+    reader_stop_(false),
+    is_streaming_(false),
+    streaming_pause_depth_(0),
+    stop_latency_us_(0),
+    overrun_bytes_(0),
+    nmea_records_(NMEA_RECORDS_SIZE),
+    nmea_dropped_(0),
+    command_stop_(false),
+    command_closed_(false),
+    io_mode_(false),
+    io_streaming_(false),
+    io_active_(false),
+    io_result_(0),
+    io_output_sent_(0),
+    rx_time_us_(0),
+    time_sync_bound_us_(0),
+    time_sync_pending_(false),
+    time_sync_last_us_(0)
 {
-    is_detected_ = Detect();
+    PublishSettings();
+    command_timeouts_.SetBaudrate(transport_->GetBaudrate());
 
-    if (false != is_detected_)
+    if (nullptr != Detected)
     {
+        // Detector has left the echosounder stopped and the transport at its baudrate
+        detect_info_ = *Detected;
+        is_detected_ = true;
         GetSonarInfo();
     }
 }
 
-int Echosounder::SendCommandResponseCheck()
+Echosounder::~Echosounder()
 {
-    int result = 0;
+    // Reader thread queues commands, so it is stopped before the command thread
+    StopStreaming();
+    StopCommandThread();
+    StopRecording();
+}
 
-    std::deque<uint8_t>magicidbuffer = { '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0' };
-    const uint8_t invalidargtoken[]  = { 'I', 'n', 'v', 'a', 'l', 'i', 'd', ' ', 'a', 'r', 'g', 'u', 'm', 'e', 'n', 't', '\r', '\n'};
-    const uint8_t invalidcmdtoken[]  = { 'I', 'n', 'v', 'a', 'l', 'i', 'd', ' ', 'c', 'o', 'm', 'm', 'a', 'n', 'd', '\r', '\n' };
-    const uint8_t okgotoken[]        = { 'O', 'K', ' ', 'g', 'o', '\r', '\n' };
-    const uint8_t oktoken[]          = { 'O', 'K', '\r', '\n' };
+std::future<int> Echosounder::Enqueue(AsyncKind Kind, EchosounderCommandIds Command, const std::string &Value, Completion Done)
+{
+    AsyncCommand item;
+    item.kind = Kind;
+    item.command = Command;
+    item.value = Value;
+    item.result = std::make_shared<std::promise<int>>();
+    item.done = Done;
 
-    command_result_.clear();
-    const auto time_begin = std::chrono::steady_clock::now();
+    std::future<int> future = item.result->get_future();
 
-    for (;;)
     {
-        uint8_t ch;
-        std::size_t br = serial_port_->read(&ch, 1);
+        std::unique_lock<std::mutex> lock(command_mutex_);
 
-        if (br > 0)
+        // Echosounder is being destroyed, no thread is started for the command
+        if (false != command_closed_)
         {
-            magicidbuffer.pop_front();
-            magicidbuffer.push_back(ch);
+            lock.unlock();
+            Complete(item, 0);
+            return future;
+        }
 
-            command_result_.push_back(ch);
+        command_queue_.push_back(std::move(item));
 
-            if (std::equal(magicidbuffer.end() - sizeof(oktoken), magicidbuffer.end(), oktoken))
-            {
-                is_running_ = false;
-                result = 1;
-                break;
-            }
-            else if (std::equal(magicidbuffer.end() - sizeof(okgotoken), magicidbuffer.end(), okgotoken))
-            {
-                is_running_ = true;
-                result = 1;
-                break;
-            }
-            else if (std::equal(magicidbuffer.end() - sizeof(invalidcmdtoken), magicidbuffer.end(), invalidcmdtoken))
-            {
-                is_running_ = false;
-                result = 2;
-                break;
-            }
-            else if (std::equal(magicidbuffer.end() - sizeof(invalidargtoken), magicidbuffer.end(), invalidargtoken))
-            {
-                is_running_ = false;
-                result = 3;
-                break;
-            }
-            else
-            {
-                // do nothing
-            }
+        if (io_wakeup_)
+        {
+            // Event-driven mode, the command is started by ProcessIO()
+            io_wakeup_();
+            return future;
         }
 
-        const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - time_begin);
-
-        if (period.count() > 4000LL)
+        if (false == command_thread_.joinable())
         {
-            result = -2;
-            break;
+            command_stop_ = false;
+            command_thread_ = std::thread(&Echosounder::CommandThread, this);
         }
     }
 
-    return result;
+    command_ready_.notify_one();
+
+    return future;
+}
+
+int Echosounder::RunCommand(const AsyncCommand &Item)
+{
+    switch (Item.kind)
+    {
+        case AsyncSetValue:
+            return SetValueCommand(Item.command, Item.value);
+
+        case AsyncGetSettings:
+            return GetSettingsCommand();
+
+        case AsyncStart:
+            return StartCommand();
+
+        case AsyncStop:
+            return StopCommand();
+
+        case AsyncSetTime:
+            SetCurrentTime();
+            time_sync_pending_.store(false);
+            return 1;
+
+        default:
+            return 2;
+    }
 }
 
-int Echosounder::WaitCommandPrompt(int64_t timeoutms) const
+void Echosounder::Complete(AsyncCommand &Item, int Result)
 {
-    int result = 0;
+    Item.result->set_value(Result);
 
-    std::deque<uint8_t>magicidbuffer = { '0', '0', '0', '0', '0' };
-    const uint8_t prompttoken[] = { '>' };
+    if (Item.done)
+    {
+        Item.done(Result);
+    }
+}
 
-    const auto time_begin = std::chrono::steady_clock::now();
+void Echosounder::CommandThread()
+{
+    std::unique_lock<std::mutex> lock(command_mutex_);
 
     for (;;)
     {
-        uint8_t ch;
-        std::size_t br = serial_port_->read(&ch, 1);
+        command_ready_.wait(lock, [this]() { return (false != command_stop_) || (false == command_queue_.empty()); });
 
-        if (br > 0)
+        if (false != command_stop_)
         {
-            magicidbuffer.pop_front();
-            magicidbuffer.push_back(ch);
-
-            if (std::equal(magicidbuffer.end() - sizeof(prompttoken), magicidbuffer.end(), prompttoken))
-            {
-                result = 1;
-                break;
-            }
-            else
-            {
-                // do nothing
-            }
+            break;
         }
 
-        const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - time_begin);
+        // Item stays queued while it runs, so GetPendingCommands() counts it
+        AsyncCommand &item = command_queue_.front();
+        lock.unlock();
 
-        if (period.count() > timeoutms)
+        int result = -2;
+
+        try
         {
-            result = -2;
-            break;
+            result = RunCommand(item);
         }
+        catch (...)
+        {
+            // Transport failure is reported as timeout
+        }
+
+        Complete(item, result);
+
+        lock.lock();
+        command_queue_.pop_front();
     }
 
-    return result;
+    // Commands not started yet are cancelled, unless they are handed over to the event-driven mode
+    while ((false == command_queue_.empty()) && (!io_wakeup_))
+    {
+        AsyncCommand item = std::move(command_queue_.front());
+        command_queue_.pop_front();
+        lock.unlock();
+
+        Complete(item, 0);
+
+        lock.lock();
+    }
 }
 
-int Echosounder::SendCommand(EchosounderCommandIds Command)
+void Echosounder::StopCommandThread()
 {
-    int retvalue = 0;
-
-    bool wasrunning = is_running_;
-    if (false != is_running_)
     {
-        Stop();
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        command_stop_ = true;
+        command_closed_ = true;
     }
 
-    const std::string fullcommand = std::string(echosounder_commands_[Command].command_text) + '\r';
-    serial_port_->write(fullcommand);
-
-    retvalue = SendCommandResponseCheck();
-    WaitCommandPrompt(1000);
+    command_ready_.notify_one();
 
-    if (false != wasrunning)
+    if (false != command_thread_.joinable())
     {
-        Start();
+        command_thread_.join();
     }
+}
 
-    return retvalue;
+std::future<int> Echosounder::SetValueAsync(EchosounderCommandIds Command, const std::string &SonarValue, Completion Done)
+{
+    return Enqueue(AsyncSetValue, Command, SonarValue, Done);
 }
 
-bool Echosounder::SetValue(EchosounderCommandIds Command, const std::string &SonarValue)
+std::future<int> Echosounder::GetSettingsAsync(Completion Done)
+{
+    return Enqueue(AsyncGetSettings, IdInfo, std::string(), Done);
+}
+
+std::future<int> Echosounder::StartAsync(Completion Done)
+{
+    return Enqueue(AsyncStart, IdGo, std::string(), Done);
+}
+
+std::future<int> Echosounder::StopAsync(Completion Done)
+{
+    return Enqueue(AsyncStop, IdGo, std::string(), Done);
+}
+
+std::size_t Echosounder::GetPendingCommands()
 {
-    bool retvalue = false;
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    return command_queue_.size();
+}
+
+int Echosounder::GetFd() const
+{
+    return transport_->GetFd();
+}
 
-    const auto &command0 = echosounder_commands_[Command];
+bool Echosounder::AttachIO(std::function<void()> Wakeup, std::size_t BufferSize)
+{
+    if (transport_->GetFd() < 0)
+    {
+        return false;
+    }
 
-    if (nullptr != command0.command_text)
+    // Commands already queued are left for the state machine
     {
-        const auto command = std::string(command0.command_text);
+        std::lock_guard<std::mutex> lock(command_mutex_);
 
-        if (command.length() > 0)
+        if (io_wakeup_)
         {
+            return false;
+        }
 
-            bool wasrunning = is_running_;
-            if (false != is_running_)
-            {
-                Stop();
-            }
+        io_wakeup_ = (Wakeup) ? Wakeup : []() {};
+        command_stop_ = true;
+    }
 
-            const std::string fullcommand = command + ' ' + SonarValue + '\r';
-            serial_port_->write(fullcommand);
+    command_ready_.notify_one();
 
-            retvalue = (1 == SendCommandResponseCheck()) ? true : false;
+    // Command thread may wait for the port, so it is joined before the port is taken
+    if (false != command_thread_.joinable())
+    {
+        command_thread_.join();
+    }
 
-            if (false != retvalue)
-            {
-                echosounder_settings_[Command] = SonarValue;
-            }
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
 
-            WaitCommandPrompt(1000);
+    StopReaderThread();
 
-            if (false != wasrunning)
-            {
-                Start();
-            }
-        }
+    io_streaming_ = is_streaming_;
+
+    if ((false == is_streaming_) || (nullptr == stream_buffer_))
+    {
+        std::atomic_store(&stream_buffer_, std::make_shared<RingBuffer>(BufferSize));
+        overrun_bytes_.store(0);
     }
 
-    return retvalue;
+    // Data received by the command path after the last response goes first
+    if (rx_end_ > rx_begin_)
+    {
+        PushStream(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, rx_time_us_);
+    }
+
+    rx_begin_ = 0;
+    rx_end_ = 0;
+    is_streaming_ = true;
+    io_mode_ = true;
+    io_active_ = false;
+
+    return true;
 }
 
-const std::string &Echosounder::GetValue(EchosounderCommandIds Command)
+void Echosounder::DetachIO()
 {
-    return echosounder_settings_[Command];
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false == io_mode_)
+    {
+        return;
+    }
+
+    // Partly sent command line is completed, so the echosounder does not take it as a prefix of the next one
+    if (false != WantsWrite())
+    {
+        WriteCommand(io_output_.substr(io_output_sent_));
+    }
+
+    io_output_.clear();
+    io_output_sent_ = 0;
+
+    // Command interrupted in the middle has unknown outcome
+    if (false != io_active_)
+    {
+        stale_input_ = true;
+        FinishOperation(-2);
+    }
+
+    io_mode_ = false;
+    is_streaming_ = io_streaming_;
+
+    // Streaming started before AttachIO() goes on with the reader thread
+    if ((false != is_streaming_) && (0 == streaming_pause_depth_))
+    {
+        reader_stop_.store(false);
+        reader_thread_ = std::thread(&Echosounder::ReaderThread, this);
+    }
+
+    // Commands still queued go back to the command thread
+    std::lock_guard<std::mutex> commandlock(command_mutex_);
+
+    io_wakeup_ = nullptr;
+    command_stop_ = false;
+
+    if (false == command_queue_.empty())
+    {
+        command_thread_ = std::thread(&Echosounder::CommandThread, this);
+    }
 }
 
-void Echosounder::GetAllValues()
+void Echosounder::FailIO()
 {
-    for (auto it = echosounder_commands_.cbegin(); it != echosounder_commands_.cend(); it++)
+    if (false == io_mode_)
+    {
+        return;
+    }
+
+    io_output_.clear();
+    io_output_sent_ = 0;
+
+    if (false != io_active_)
+    {
+        stale_input_ = true;
+        FinishOperation(-2);
+    }
+
+    for (;;)
     {
-        const auto &regexstr = std::regex(it->second.regex_match_text);
+        AsyncCommand item;
 
-        for(auto &line : info_lines_)
         {
-            std::smatch match;
+            std::lock_guard<std::mutex> lock(command_mutex_);
 
-            if (false != std::regex_match(line, match, regexstr))
+            if (true == command_queue_.empty())
             {
-                echosounder_settings_[static_cast<EchosounderCommandIds_t>(it->first)] = match[1].str();
                 break;
             }
+
+            item = std::move(command_queue_.front());
+            command_queue_.pop_front();
+        }
+
+        // Device time is set again by a later check
+        if (AsyncSetTime == item.kind)
+        {
+            time_sync_pending_.store(false);
         }
+
+        Complete(item, -2);
     }
 }
 
-void Echosounder::SetAllValues()
+std::chrono::steady_clock::time_point Echosounder::GetIoDeadline() const
 {
-    for(auto it = echosounder_commands_.cbegin(); it != echosounder_commands_.cend(); it++)
-    {
-        SetValue(static_cast<EchosounderCommandIds_t>(it->first), echosounder_settings_[static_cast<EchosounderCommandIds_t>(it->first)]);
-    }
+    return (false != io_active_) ? io_deadline_ : std::chrono::steady_clock::time_point::max();
 }
 
-std::shared_ptr<serial::Serial> &Echosounder::GetSerialPort()
+bool Echosounder::WantsWrite() const
 {
-    return serial_port_;
+    return io_output_sent_ < io_output_.size();
 }
 
-int Echosounder::GetSonarInfo()
+void Echosounder::PushStream(const uint8_t *Data, std::size_t Size, int64_t TimeUs)
 {
-    int result = -1;
-    info_lines_ = {};
+    ParseData(Data, Size, TimeUs);
 
-    result = SendCommand(EchosounderCommandIds::IdInfo);
+    const std::size_t bw = stream_buffer_->Write(Data, Size);
 
-    if (1 == result)
+    if (bw < Size)
+    {
+        overrun_bytes_ += Size - bw;
+    }
+
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    stream_ready_.notify_one();
+}
+
+void Echosounder::BeginOperation()
+{
+    for (;;)
     {
-        auto istr = std::istringstream(command_result_);
-        std::string line;
+        AsyncCommand *item = nullptr;
 
-        while (std::getline(istr, line))
         {
-            line.erase(std::remove_if(line.begin(), line.end(),
-                                      [](char &echar)
+            std::lock_guard<std::mutex> lock(command_mutex_);
+
+            if (true == command_queue_.empty())
             {
-                if (('\r' == echar) || ('\n' == echar))
+                return;
+            }
+
+            item = &command_queue_.front();
+        }
+
+        // Event loop must not sleep until the second boundary, the nearest second is set at once
+        if (AsyncSetTime == item->kind)
+        {
+            const int64_t nowus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+            item->kind = AsyncSetValue;
+            item->value = std::to_string((nowus + 500000LL) / 1000000LL);
+            time_sync_pending_.store(false);
+            time_sync_last_us_.store(ClockModel::MonotonicUs());
+            clock_model_.Reset();
+        }
+
+        const IoStep breakin = { "\r", ResponseMatcher::PromptTokens, STOP_PROMPT_TIMEOUT_MS, STOP_ATTEMPTS, AsyncStop == item->kind, true };
+        const EchosounderTimeout &gotimeout = command_timeouts_.Get(IdGo);
+        const bool wasrunning = is_running_;
+        int result = -2;
+
+        io_steps_.clear();
+
+        switch (item->kind)
+        {
+            case AsyncStart:
+                if ((false != is_detected_) && (false == is_running_))
                 {
-                    return true;
+                    io_steps_.push_back({ std::string(echosounder_commands_[IdGo].command_text) + '\r', ResponseMatcher::ResponseTokens, gotimeout.response_ms, 1, true, false });
                 }
+                else
+                {
+                    result = (false != is_detected_) ? 1 : -2;
+                }
+                break;
 
-                return false;
+            case AsyncStop:
+                if ((false != is_detected_) && (false != is_running_))
+                {
+                    io_steps_.push_back(breakin);
+                }
+                else
+                {
+                    result = 1;
+                }
+                break;
 
-            }), line.end());
+            case AsyncSetValue:
+                if ((false != echosounder_commands_.IsSupported(item->command)) && ('\0' != echosounder_commands_[item->command].command_text[0]))
+                {
+                    const EchosounderTimeout &timeout = command_timeouts_.Get(item->command);
 
-            info_lines_.push_back(line);
-        }
+                    if (false != wasrunning)
+                    {
+                        io_steps_.push_back(breakin);
+                    }
 
-        GetAllValues();
-    }
+                    io_steps_.push_back({ std::string(echosounder_commands_[item->command].command_text) + ' ' + item->value + '\r', ResponseMatcher::ResponseTokens, timeout.response_ms, 1, true, false });
+                    io_steps_.push_back({ std::string(), ResponseMatcher::PromptTokens, timeout.prompt_ms, 1, false, false });
 
-    return result;
-}
+                    if (false != wasrunning)
+                    {
+                        io_steps_.push_back({ std::string(echosounder_commands_[IdGo].command_text) + '\r', ResponseMatcher::ResponseTokens, gotimeout.response_ms, 1, false, false });
+                    }
+                }
+                else
+                {
+                    result = 2;
+                }
+                break;
 
-void Echosounder::GetSettings()
-{
-    if (false != is_detected_)
-    {
-        if (false != is_running_)
+            case AsyncGetSettings:
+                if (false != is_detected_)
+                {
+                    const EchosounderTimeout &timeout = command_timeouts_.Get(IdInfo);
+
+                    if (false != wasrunning)
+                    {
+                        io_steps_.push_back(breakin);
+                    }
+
+                    io_steps_.push_back({ std::string(echosounder_commands_[IdInfo].command_text) + '\r', ResponseMatcher::ResponseTokens, timeout.response_ms, 1, true, false });
+                    io_steps_.push_back({ std::string(), ResponseMatcher::PromptTokens, timeout.prompt_ms, 1, false, false });
+                }
+                break;
+
+            default:
+                result = 2;
+                break;
+        }
+
+        if (false == io_steps_.empty())
         {
-            Stop();
+            DiscardStaleInput();
+            io_active_ = true;
+            io_result_ = -2;
+            io_begin_ = std::chrono::steady_clock::now();
+            BeginStep();
+            return;
         }
 
-        GetSonarInfo();
+        // Nothing to send, the command is complete at once
+        FinishOperation(result);
     }
 }
 
-void Echosounder::SetSettings()
+void Echosounder::BeginStep()
 {
-    if (false != is_detected_)
-    {
-        if (false != is_running_)
-        {
-            Stop();
-        }
+    const IoStep &step = io_steps_.front();
 
-        SetAllValues();
+    response_matcher_.Reset();
+
+    if (ResponseMatcher::ResponseTokens == step.tokens)
+    {
+        command_result_.clear();
     }
+
+    // Deadline goes first, so a failed write ends up as timeout of the step
+    io_deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(step.timeout_ms);
+
+    // Sent by ProcessIO() as the port accepts it
+    io_output_.append(step.text);
+    SendOutput();
 }
 
-void Echosounder::Start()
+void Echosounder::SendOutput()
 {
-    if (false != is_detected_)
+    while (io_output_sent_ < io_output_.size())
     {
-        if (false == is_running_)
+        const std::size_t bw = transport_->WriteSome(reinterpret_cast<const uint8_t *>(io_output_.data()) + io_output_sent_, io_output_.size() - io_output_sent_);
+
+        if (0 == bw)
         {
-            SendCommand(EchosounderCommandIds::IdGo);
+            return;
         }
+
+        io_output_sent_ += bw;
     }
+
+    io_output_.clear();
+    io_output_sent_ = 0;
 }
 
-void Echosounder::Stop()
+void Echosounder::FinishOperation(int Result)
 {
-    if (false != is_detected_)
+    AsyncCommand item;
+
     {
-        if (false != is_running_)
-        {
-            Detect();
-        }
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        item = std::move(command_queue_.front());
+        command_queue_.pop_front();
     }
+
+    io_steps_.clear();
+    io_active_ = false;
+
+    Complete(item, Result);
 }
 
-bool Echosounder::Detect()
+void Echosounder::ConsumeStep()
 {
-    bool result = false;
+    const IoStep &step = io_steps_.front();
+    std::size_t consumed = 0;
+    const int token = response_matcher_.Feed(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, step.tokens, consumed);
+
+    if (ResponseMatcher::ResponseTokens == step.tokens)
+    {
+        command_result_.append(reinterpret_cast<const char *>(&rx_buffer_[rx_begin_]), consumed);
+    }
 
-    for (int i = 0; i < 10; i++)
+    // Same as WaitCommandPrompt() of BreakIn(): pings printed before the break-in was noticed are data, the prompt is not
+    if (false != step.route)
     {
-        serial_port_->write("\r");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        serial_port_->write("\r");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        serial_port_->write("\r");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        serial_port_->write("\r");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        serial_port_->write("\r");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const std::size_t data = (ResponseMatcher::TokenPrompt == token) ? consumed - std::min(consumed, PROMPT_SIZE) : consumed;
 
-        if (1 == WaitCommandPrompt(500))
+        if (data > 0)
         {
-            serial_port_->flush();
-            serial_port_->write("#speed\r");
+            PushStream(&rx_buffer_[rx_begin_], data, rx_time_us_);
+        }
+    }
 
-            if (1 != SendCommandResponseCheck())
-            {
-                result = false;
-                break;
-            }
+    rx_begin_ += consumed;
 
-            WaitCommandPrompt(1000);
-            result = true;
-            break;
-        }
+    if (token < 0)
+    {
+        return;
     }
 
-    return result;
-}
+    int result = 1;
 
-void Echosounder::SetCurrentTime()
-{
+    switch (token)
+    {
+        case ResponseMatcher::TokenOkGo:
+            is_running_ = true;
+            break;
+
+        case ResponseMatcher::TokenInvalidCommand:
+            is_running_ = false;
+            result = 2;
+            break;
+
+        case ResponseMatcher::TokenInvalidArgument:
+            is_running_ = false;
+            result = 3;
+            break;
+
+        default:
+            // "OK" or the command prompt
+            is_running_ = false;
+            break;
+    }
+
+    if (false != step.main)
+    {
+        io_result_ = result;
+        ApplyResult(result);
+    }
+
+    io_steps_.pop_front();
+
+    if (false == io_steps_.empty())
+    {
+        BeginStep();
+    }
+    else
+    {
+        FinishOperation(io_result_);
+    }
+}
+
+void Echosounder::ApplyResult(int Result)
+{
+    AsyncCommand *item = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        item = &command_queue_.front();
+    }
+
+    if (1 != Result)
+    {
+        return;
+    }
+
+    switch (item->kind)
+    {
+        case AsyncSetValue:
+            echosounder_settings_.Set(item->command, item->value);
+            PublishSettings();
+            break;
+
+        case AsyncGetSettings:
+            command_timeouts_.SetResponseSize(IdInfo, command_result_.size());
+            GetAllValues();
+            break;
+
+        case AsyncStop:
+            stop_latency_us_.store(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - io_begin_).count());
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Echosounder::StepTimeout()
+{
+    IoStep &step = io_steps_.front();
+
+    if (step.attempts > 1)
+    {
+        step.attempts--;
+        BeginStep();
+        return;
+    }
+
+    // Late bytes of this command must not be taken for the next one
+    stale_input_ = true;
+
+    if (false != step.main)
+    {
+        io_result_ = -2;
+
+        if (ResponseMatcher::PromptTokens == step.tokens)
+        {
+            stop_latency_us_.store(-1);
+        }
+    }
+
+    FinishOperation(io_result_);
+}
+
+void Echosounder::ProcessIO()
+{
+    if (false == io_mode_)
+    {
+        return;
+    }
+
+    SendOutput();
+
+    if (false == io_active_)
+    {
+        BeginOperation();
+    }
+
+    for (;;)
+    {
+        if (rx_begin_ == rx_end_)
+        {
+            rx_begin_ = 0;
+            rx_end_ = transport_->Read(rx_buffer_.data(), rx_buffer_.size());
+            rx_time_us_ = ClockModel::MonotonicUs();
+
+            if (0 == rx_end_)
+            {
+                break;
+            }
+        }
+
+        if (false != io_active_)
+        {
+            ConsumeStep();
+
+            if (false == io_active_)
+            {
+                BeginOperation();
+            }
+        }
+        else
+        {
+            PushStream(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, rx_time_us_);
+            rx_begin_ = rx_end_;
+        }
+    }
+
+    if ((false != io_active_) && (std::chrono::steady_clock::now() >= io_deadline_))
+    {
+        StepTimeout();
+
+        if (false == io_active_)
+        {
+            BeginOperation();
+        }
+    }
+}
+
+Echosounder::StreamingPause::StreamingPause(Echosounder &Owner) :
+    echosounder_(Owner)
+{
+    if ((0 == echosounder_.streaming_pause_depth_++) && (false != echosounder_.is_streaming_))
+    {
+        echosounder_.StopReaderThread();
+    }
+}
+
+Echosounder::StreamingPause::~StreamingPause()
+{
+    // In event-driven mode the streaming buffer is filled by ProcessIO(), not by the reader thread
+    if ((0 == --echosounder_.streaming_pause_depth_) && (false != echosounder_.is_streaming_) && (false == echosounder_.io_mode_))
+    {
+        echosounder_.StartReaderThread();
+    }
+}
+
+void Echosounder::ParseData(const uint8_t *Data, std::size_t Size, int64_t TimeUs)
+{
+    RecordEntry(RecordingData, TimeUs, Data, Size);
+
+    while (Size > 0)
+    {
+        bool complete = false;
+        const std::size_t consumed = nmea_parser_.Feed(Data, Size, complete);
+
+        if (false != complete)
+        {
+            DispatchRecord(StampRecord(TimeUs));
+        }
+
+        Data += consumed;
+        Size -= consumed;
+    }
+}
+
+void Echosounder::DispatchRecord(const EchosounderNmeaRecord &Record)
+{
+    if (false == nmea_records_.Push(Record))
+    {
+        nmea_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+EchosounderNmeaRecord Echosounder::StampRecord(int64_t TimeUs)
+{
+    EchosounderNmeaRecord record = nmea_parser_.GetRecord();
+    int64_t utcus = 0;
+
+    if ((NmeaZDA == record.sentence) && (false != ClockModel::ZdaToUtcUs(record.data.zda, utcus)))
+    {
+        // ZDA time refers to the start of the sentence, not to the read which completed it
+        const uint32_t baudrate = (0 != transport_->GetBaudrate()) ? transport_->GetBaudrate() : DEFAULT_BAUDRATE;
+        clock_model_.AddSample(TimeUs - (ZDA_SENTENCE_BYTES * 10LL * 1000000LL) / baudrate, utcus);
+        CheckTimeSync();
+    }
+
+    record.host_time_us = TimeUs;
+    record.utc_time_us = (false != clock_model_.ToDevice(TimeUs, utcus)) ? utcus : 0;
+
+    RecordEntry(RecordingRecord, TimeUs, &record, sizeof(record));
+
+    return record;
+}
+
+void Echosounder::RecordEntry(EchosounderRecordingEntryType Type, int64_t TimeUs, const void *Data, std::size_t Size)
+{
+    if (0 == Size)
+    {
+        return;
+    }
+
+    const std::shared_ptr<RecordingWriter> recorder = std::atomic_load(&recorder_);
+
+    if (nullptr != recorder)
+    {
+        recorder->Append(Type, TimeUs, Data, Size);
+    }
+}
+
+void Echosounder::CheckTimeSync()
+{
+    const int64_t bound = time_sync_bound_us_.load();
+    const int64_t monotonicus = ClockModel::MonotonicUs();
+    const int64_t lastus = time_sync_last_us_.load();
+    EchosounderClockState state;
+
+    // Every setting stalls the data, so it is not repeated sooner than the hold-off
+    if ((bound <= 0) || (false != time_sync_pending_.load()) ||
+        ((0 != lastus) && ((monotonicus - lastus) < TIME_SYNC_HOLDOFF_US)) ||
+        (false == clock_model_.GetState(state)) || (state.samples < TIME_SYNC_MIN_SAMPLES))
+    {
+        return;
+    }
+
+    int64_t deviceus = 0;
+    clock_model_.ToDevice(monotonicus, deviceus);
+
+    const int64_t hostus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Commands can not be sent from the parsing thread, the command thread sets the clock
+    if (std::llabs(deviceus - hostus) > bound)
+    {
+        time_sync_pending_.store(true);
+        Enqueue(AsyncSetTime, EchosounderCommandIds::IdTime, std::string(), Completion());
+    }
+}
+
+void Echosounder::ParsePing(const uint8_t *Data, std::size_t Size, int64_t TimeUs, EchosounderPing &Ping)
+{
+    RecordEntry(RecordingData, TimeUs, Data, Size);
+
+    while (Size > 0)
+    {
+        bool complete = false;
+        const std::size_t consumed = nmea_parser_.Feed(Data, Size, complete);
+
+        if (false != complete)
+        {
+            const EchosounderNmeaRecord record = StampRecord(TimeUs);
+
+            if (Ping.count < PING_RECORDS_SIZE)
+            {
+                Ping.records[Ping.count++] = record;
+            }
+            else
+            {
+                DispatchRecord(record);
+            }
+        }
+
+        Data += consumed;
+        Size -= consumed;
+    }
+}
+
+bool Echosounder::ReadRecord(EchosounderNmeaRecord &Record)
+{
+    return nmea_records_.Pop(Record);
+}
+
+void Echosounder::GetNmeaStatistics(EchosounderNmeaStatistics &Statistics) const
+{
+    nmea_parser_.GetStatistics(Statistics);
+    Statistics.dropped = nmea_dropped_.load(std::memory_order_relaxed);
+}
+
+void Echosounder::ReaderThread()
+{
+    std::vector<uint8_t> chunk(RECEIVE_BUFFER_SIZE);
+
+    while (false == reader_stop_.load())
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1000);
+
+        if (false != transport_->WaitReadable(deadline))
+        {
+            const std::size_t br = transport_->Read(chunk.data(), chunk.size());
+            const int64_t now = ClockModel::MonotonicUs();
+
+            if (br > 0)
+            {
+                PushStream(chunk.data(), br, now);
+            }
+        }
+        else if ((false == reader_stop_.load()) && (std::chrono::steady_clock::now() < deadline))
+        {
+            // Port reports an error without data, do not spin on it
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+void Echosounder::StartReaderThread()
+{
+    // Data received by the command path after the last response goes first
+    if (rx_end_ > rx_begin_)
+    {
+        PushStream(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, rx_time_us_);
+        rx_begin_ = 0;
+        rx_end_ = 0;
+    }
+
+    reader_stop_.store(false);
+    reader_thread_ = std::thread(&Echosounder::ReaderThread, this);
+}
+
+void Echosounder::StopReaderThread()
+{
+    if (false != reader_thread_.joinable())
+    {
+        reader_stop_.store(true);
+        transport_->SetInterrupted(true);
+        reader_thread_.join();
+        transport_->SetInterrupted(false);
+    }
+}
+
+bool Echosounder::StartStreaming(std::size_t BufferSize)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false != is_streaming_)
+    {
+        return false;
+    }
+
+    std::atomic_store(&stream_buffer_, std::make_shared<RingBuffer>(BufferSize));
+    overrun_bytes_.store(0);
+    is_streaming_ = true;
+
+    if (0 == streaming_pause_depth_)
+    {
+        StartReaderThread();
+    }
+
+    return true;
+}
+
+void Echosounder::StopStreaming()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Streaming buffer is used by the event loop until DetachIO()
+    if ((false != is_streaming_) && (false == io_mode_))
+    {
+        StopReaderThread();
+        is_streaming_ = false;
+    }
+}
+
+bool Echosounder::IsStreaming() const
+{
+    return is_streaming_;
+}
+
+uint64_t Echosounder::GetOverrunBytes() const
+{
+    return overrun_bytes_.load();
+}
+
+bool Echosounder::ReceiveData(std::chrono::steady_clock::time_point deadline)
+{
+    while (rx_begin_ == rx_end_)
+    {
+        rx_begin_ = 0;
+        rx_end_ = 0;
+
+        if (false == transport_->WaitReadable(deadline))
+        {
+            return false;
+        }
+
+        rx_end_ = transport_->Read(rx_buffer_.data(), rx_buffer_.size());
+        rx_time_us_ = ClockModel::MonotonicUs();
+    }
+
+    return true;
+}
+
+int Echosounder::SendCommandResponseCheck(EchosounderCommandIds Command)
+{
+    int result = -2;
+
+    command_result_.clear();
+    response_matcher_.Reset();
+    const auto deadline = Until(command_timeouts_.Get(Command).response_ms);
+
+    while (false != ReceiveData(deadline))
+    {
+        std::size_t consumed = 0;
+        const int token = response_matcher_.Feed(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, ResponseMatcher::ResponseTokens, consumed);
+
+        command_result_.append(reinterpret_cast<const char *>(&rx_buffer_[rx_begin_]), consumed);
+        rx_begin_ += consumed;
+
+        if (ResponseMatcher::TokenOk == token)
+        {
+            is_running_ = false;
+            result = 1;
+            break;
+        }
+        else if (ResponseMatcher::TokenOkGo == token)
+        {
+            is_running_ = true;
+            result = 1;
+            break;
+        }
+        else if (ResponseMatcher::TokenInvalidCommand == token)
+        {
+            is_running_ = false;
+            result = 2;
+            break;
+        }
+        else if (ResponseMatcher::TokenInvalidArgument == token)
+        {
+            is_running_ = false;
+            result = 3;
+            break;
+        }
+        else
+        {
+            // do nothing
+        }
+    }
+
+    stale_input_ = stale_input_ || (-2 == result);
+
+    return result;
+}
+
+std::chrono::steady_clock::time_point Echosounder::Until(int64_t timeoutms) const
+{
+    return std::min(deadline_, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms));
+}
+
+bool Echosounder::WriteCommand(const std::string &Text)
+{
+    const auto deadline = Until(CommandTimeouts::Estimate(Text.size(), transport_->GetBaudrate()));
+
+    return Text.size() == transport_->Write(Text, deadline);
+}
+
+void Echosounder::DiscardStaleInput()
+{
+    if (false != stale_input_)
+    {
+        rx_begin_ = 0;
+        rx_end_ = 0;
+
+        while (transport_->Read(rx_buffer_.data(), rx_buffer_.size()) > 0)
+        {
+        }
+
+        stale_input_ = false;
+    }
+}
+
+void Echosounder::Resume(bool wasrunning)
+{
+    // Echosounder is left stopped if the operation ran out of time
+    if ((false != wasrunning) && (std::chrono::steady_clock::now() < deadline_))
+    {
+        Start();
+    }
+}
+
+Echosounder::DeadlineScope::DeadlineScope(Echosounder &Owner, std::chrono::steady_clock::time_point Deadline) :
+    echosounder_(Owner),
+    previous_(Owner.deadline_)
+{
+    echosounder_.deadline_ = std::min(previous_, Deadline);
+}
+
+Echosounder::DeadlineScope::~DeadlineScope()
+{
+    echosounder_.deadline_ = previous_;
+}
+
+bool Echosounder::SetValue(EchosounderCommandIds Command, const std::string &SonarValue, std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return SetValue(Command, SonarValue);
+}
+
+std::size_t Echosounder::SetValues(std::vector<SettingValue> &Items, std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return SetValues(Items);
+}
+
+bool Echosounder::ApplySettings(bool Verify, std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return ApplySettings(Verify);
+}
+
+bool Echosounder::GetSettings(std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return (1 == GetSettingsCommand()) ? true : false;
+}
+
+bool Echosounder::Start(std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return (1 == StartCommand()) ? true : false;
+}
+
+bool Echosounder::Stop(std::chrono::steady_clock::time_point Deadline)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    DeadlineScope scope(*this, Deadline);
+    return (1 == StopCommand()) ? true : false;
+}
+
+void Echosounder::SetCommandTimeout(EchosounderCommandIds Command, const EchosounderTimeout &Timeout)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    command_timeouts_.Set(Command, Timeout);
+}
+
+void Echosounder::ResetCommandTimeout(EchosounderCommandIds Command)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    command_timeouts_.Reset(Command);
+}
+
+EchosounderTimeout Echosounder::GetCommandTimeout(EchosounderCommandIds Command) const
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    return command_timeouts_.Get(Command);
+}
+
+void Echosounder::SetReadTimeout(int64_t timeoutms)
+{
+    read_timeout_ms_ = timeoutms;
+}
+
+int64_t Echosounder::GetReadTimeout() const
+{
+    return read_timeout_ms_;
+}
+
+int Echosounder::WaitCommandPrompt(int64_t timeoutms, bool RouteData)
+{
+    int result = -2;
+
+    response_matcher_.Reset();
+    const auto deadline = Until(timeoutms);
+
+    while (false != ReceiveData(deadline))
+    {
+        std::size_t consumed = 0;
+        const int token = response_matcher_.Feed(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, ResponseMatcher::PromptTokens, consumed);
+
+        // Pings printed before the unit noticed the break-in belong to the data path, the prompt does not
+        if ((false != RouteData) && (false != is_streaming_))
+        {
+            const std::size_t data = (ResponseMatcher::TokenPrompt == token) ? consumed - std::min(consumed, PROMPT_SIZE) : consumed;
+
+            if (data > 0)
+            {
+                PushStream(&rx_buffer_[rx_begin_], data, rx_time_us_);
+            }
+        }
+
+        rx_begin_ += consumed;
+
+        if (ResponseMatcher::TokenPrompt == token)
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    stale_input_ = stale_input_ || (-2 == result);
+
+    return result;
+}
+
+int Echosounder::SendCommand(EchosounderCommandIds Command)
+{
+    int retvalue = 0;
+
+    if (false == echosounder_commands_.IsSupported(Command))
+    {
+        return 2;
+    }
+
+    StreamingPause pause(*this);
+
+    bool wasrunning = is_running_;
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    DiscardStaleInput();
+
+    const std::string fullcommand = std::string(echosounder_commands_[Command].command_text) + '\r';
+
+    if (false == WriteCommand(fullcommand))
+    {
+        retvalue = -2;
+    }
+    else
+    {
+        retvalue = SendCommandResponseCheck(Command);
+
+        // "OK go" is followed by data, not by the prompt
+        if (false == is_running_)
+        {
+            WaitCommandPrompt(command_timeouts_.Get(Command).prompt_ms);
+        }
+    }
+
+    Resume(wasrunning);
+
+    return retvalue;
+}
+
+bool Echosounder::SetValue(EchosounderCommandIds Command, const std::string &SonarValue)
+{
+    return (1 == SetValueCommand(Command, SonarValue)) ? true : false;
+}
+
+int Echosounder::SetValueCommand(EchosounderCommandIds Command, const std::string &SonarValue)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Port belongs to the event loop until DetachIO()
+    if (false != io_mode_)
+    {
+        return -1;
+    }
+
+    int retvalue = 2;
+
+    if (false != echosounder_commands_.IsSupported(Command))
+    {
+        const auto command = std::string(echosounder_commands_[Command].command_text);
+
+        if (command.length() > 0)
+        {
+            StreamingPause pause(*this);
+
+            bool wasrunning = is_running_;
+            if (false != is_running_)
+            {
+                Stop();
+            }
+
+            DiscardStaleInput();
+
+            const std::string fullcommand = command + ' ' + SonarValue + '\r';
+
+            if (false == WriteCommand(fullcommand))
+            {
+                retvalue = -2;
+            }
+            else
+            {
+                retvalue = SendCommandResponseCheck(Command);
+
+                if (1 == retvalue)
+                {
+                    echosounder_settings_.Set(Command, SonarValue);
+                    PublishSettings();
+                }
+
+                WaitCommandPrompt(command_timeouts_.Get(Command).prompt_ms);
+            }
+
+            Resume(wasrunning);
+        }
+    }
+
+    return retvalue;
+}
+
+std::size_t Echosounder::SetValues(std::vector<SettingValue> &Items)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    std::size_t count = 0;
+
+    for (auto &item : Items)
+    {
+        item.result = 0;
+    }
+
+    if ((true == Items.empty()) || (false != io_mode_))
+    {
+        return count;
+    }
+
+    StreamingPause pause(*this);
+
+    bool wasrunning = is_running_;
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    // Items sent and waiting for response, responses come in the order commands were sent
+    std::deque<std::size_t> inflight;
+    std::size_t next = 0;
+    bool sent = false;
+    EchosounderCommandIds lastcommand = IdInfo;
+
+    DiscardStaleInput();
+
+    while ((next < Items.size()) || (false == inflight.empty()))
+    {
+        // Keep a few commands in flight so the echosounder input buffer is not overrun
+        while ((next < Items.size()) && (inflight.size() < SETTINGS_PIPELINE_DEPTH))
+        {
+            SettingValue &item = Items[next];
+
+            if (false == echosounder_commands_.IsSupported(item.command))
+            {
+                item.result = 2;
+            }
+            else
+            {
+                const std::string fullcommand = std::string(echosounder_commands_[item.command].command_text) + ' ' + item.value + '\r';
+
+                if (false == WriteCommand(fullcommand))
+                {
+                    // Port does not take commands, the rest is not sent
+                    for (std::size_t index = next; index < Items.size(); index++)
+                    {
+                        Items[index].result = -2;
+                    }
+
+                    next = Items.size();
+                    break;
+                }
+
+                inflight.push_back(next);
+                lastcommand = item.command;
+                sent = true;
+            }
+
+            next++;
+        }
+
+        if (true == inflight.empty())
+        {
+            break;
+        }
+
+        SettingValue &item = Items[inflight.front()];
+        inflight.pop_front();
+
+        item.result = SendCommandResponseCheck(item.command);
+
+        if (1 == item.result)
+        {
+            echosounder_settings_.Set(item.command, item.value);
+            PublishSettings();
+            count++;
+        }
+        else if (-2 == item.result)
+        {
+            // Echosounder does not respond, commands still in flight are lost
+            for (auto index : inflight)
+            {
+                Items[index].result = -2;
+            }
+
+            inflight.clear();
+            next = Items.size();
+        }
+    }
+
+    if (false != sent)
+    {
+        WaitCommandPrompt(command_timeouts_.Get(lastcommand).prompt_ms);
+    }
+
+    Resume(wasrunning);
+
+    return count;
+}
+
+bool Echosounder::IsCommandSupported(EchosounderCommandIds Command) const
+{
+    return echosounder_commands_.IsSupported(Command);
+}
+
+std::string Echosounder::GetValue(EchosounderCommandIds Command)
+{
+    return std::atomic_load(&settings_view_)->GetText(Command);
+}
+
+bool Echosounder::GetValue(EchosounderCommandIds Command, long &Value) const
+{
+    return std::atomic_load(&settings_view_)->GetLong(Command, Value);
+}
+
+bool Echosounder::GetValue(EchosounderCommandIds Command, float &Value) const
+{
+    return std::atomic_load(&settings_view_)->GetFloat(Command, Value);
+}
+
+void Echosounder::PublishSettings()
+{
+    std::atomic_store(&settings_view_, std::shared_ptr<const SettingsStore>(new SettingsStore(echosounder_settings_)));
+
+    const std::shared_ptr<RecordingWriter> recorder = std::atomic_load(&recorder_);
+
+    if (nullptr != recorder)
+    {
+        recorder->SettingsChanged();
+    }
+}
+
+std::string Echosounder::GetSettingsSnapshot() const
+{
+    const std::shared_ptr<const SettingsStore> view = std::atomic_load(&settings_view_);
+    std::string text;
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        const EchosounderCommandIds command = static_cast<EchosounderCommandIds>(i);
+        const std::string &value = view->GetText(command);
+
+        if ((false != echosounder_commands_.IsSupported(command)) && (false == value.empty()))
+        {
+            text += std::to_string(i) + ' ' + echosounder_commands_[command].command_text + ' ' + value + '\n';
+        }
+    }
+
+    return text;
+}
+
+bool Echosounder::StartRecording(const std::string &Path, std::size_t SegmentSize)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (nullptr != std::atomic_load(&recorder_))
+    {
+        return false;
+    }
+
+    std::shared_ptr<RecordingWriter> recorder = std::make_shared<RecordingWriter>(0);
+
+    if (false == recorder->Open(Path, SegmentSize, [this]() { return GetSettingsSnapshot(); }))
+    {
+        return false;
+    }
+
+    std::atomic_store(&recorder_, recorder);
+
+    return true;
+}
+
+void Echosounder::StopRecording()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    const std::shared_ptr<RecordingWriter> recorder = std::atomic_exchange(&recorder_, std::shared_ptr<RecordingWriter>());
+
+    if (nullptr != recorder)
+    {
+        recorder->Close();
+    }
+}
+
+bool Echosounder::GetRecordingStatistics(EchosounderRecordingStatistics &Statistics) const
+{
+    const std::shared_ptr<RecordingWriter> recorder = std::atomic_load(&recorder_);
+
+    if (nullptr == recorder)
+    {
+        return false;
+    }
+
+    recorder->GetStatistics(Statistics);
+
+    return true;
+}
+
+void Echosounder::GetAllValues()
+{
+    info_parser_.Parse(command_result_, echosounder_settings_);
+    PublishSettings();
+}
+
+bool Echosounder::SetChangedValues(std::vector<SettingValue> &Items)
+{
+    const uint64_t dirty = echosounder_settings_.GetDirty();
+
+    Items.clear();
+
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        const EchosounderCommandIds_t command = static_cast<EchosounderCommandIds_t>(i);
+
+        // Only parameters have default value, commands like #go or #version are not sent
+        if ((0 != ((dirty >> i) & 1U)) &&
+            (false != echosounder_commands_.IsSupported(command)) &&
+            ('\0' != *echosounder_commands_[command].default_value) &&
+            (false == echosounder_settings_.GetText(command).empty()))
+        {
+            SettingValue item = { command, echosounder_settings_.GetText(command), 0 };
+            Items.push_back(item);
+        }
+    }
+
+    return SetValues(Items) == Items.size();
+}
+
+bool Echosounder::StageValue(EchosounderCommandIds Command, const std::string &SonarValue)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false == echosounder_commands_.IsSupported(Command))
+    {
+        return false;
+    }
+
+    echosounder_settings_.Stage(Command, SonarValue);
+    PublishSettings();
+
+    return true;
+}
+
+bool Echosounder::ApplySettings(bool Verify)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if ((false == is_detected_) || (false != io_mode_))
+    {
+        return false;
+    }
+
+    StreamingPause pause(*this);
+
+    bool wasrunning = is_running_;
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    std::vector<SettingValue> items;
+    bool result = SetChangedValues(items);
+
+    if ((false != Verify) && (false == items.empty()))
+    {
+        result = (1 == GetSonarInfo()) && (false != result);
+
+        for (const auto &item : items)
+        {
+            result = result && echosounder_settings_.Matches(item.command, item.value);
+        }
+    }
+
+    Resume(wasrunning);
+
+    return result;
+}
+
+std::shared_ptr<ITransport> &Echosounder::GetTransport()
+{
+    return transport_;
+}
+
+std::size_t Echosounder::ReadData(uint8_t *Buffer, std::size_t Size, int64_t timeoutms)
+{
+    std::shared_ptr<RingBuffer> buffer = std::atomic_load(&stream_buffer_);
+
+    if ((nullptr != buffer) && (buffer->Size() > 0))
+    {
+        return buffer->Read(Buffer, Size);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms);
+
+    if (false != is_streaming_)
+    {
+        std::unique_lock<std::mutex> lock(stream_mutex_);
+        stream_ready_.wait_until(lock, deadline, [this, &buffer]()
+        {
+            buffer = std::atomic_load(&stream_buffer_);
+            return (nullptr != buffer) && (buffer->Size() > 0);
+        });
+
+        return (nullptr != buffer) ? buffer->Read(Buffer, Size) : 0;
+    }
+
+    // Port is waited for without the lock, so a command from another thread is not held up by the read
+    {
+        std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+        // In event-driven mode the receive buffer belongs to ProcessIO()
+        if ((false == io_mode_) && (rx_end_ > rx_begin_))
+        {
+            const std::size_t count = std::min(Size, rx_end_ - rx_begin_);
+
+            std::copy(rx_buffer_.begin() + rx_begin_, rx_buffer_.begin() + rx_begin_ + count, Buffer);
+            ParseData(Buffer, count, rx_time_us_);
+            rx_begin_ += count;
+
+            return count;
+        }
+    }
+
+    if (false == transport_->WaitReadable(deadline))
+    {
+        return 0;
+    }
+
+    // Bytes may have been taken by a command meanwhile, then nothing is read
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    const std::size_t br = transport_->Read(Buffer, Size);
+    ParseData(Buffer, br, ClockModel::MonotonicUs());
+
+    return br;
+}
+
+std::size_t Echosounder::PeekData(DataView &View, int64_t timeoutms)
+{
+    View.first = nullptr;
+    View.first_size = 0;
+    View.second = nullptr;
+    View.second_size = 0;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms);
+    std::shared_ptr<RingBuffer> buffer = std::atomic_load(&stream_buffer_);
+
+    if ((false != is_streaming_) && ((nullptr == buffer) || (0 == buffer->Size())))
+    {
+        std::unique_lock<std::mutex> lock(stream_mutex_);
+        stream_ready_.wait_until(lock, deadline, [this, &buffer]()
+        {
+            buffer = std::atomic_load(&stream_buffer_);
+            return (nullptr != buffer) && (buffer->Size() > 0);
+        });
+    }
+
+    if ((nullptr != buffer) && ((false != is_streaming_) || (buffer->Size() > 0)))
+    {
+        // View points into this buffer, it is kept until ConsumeData() even if streaming is restarted
+        peek_buffer_ = buffer;
+        return buffer->Peek(View);
+    }
+
+    // Received bytes are moved into the stream buffer, so commands from other threads can reuse the receive buffer
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if ((false != io_mode_) || (false != is_streaming_) || (false == ReceiveData(deadline)))
+    {
+        return 0;
+    }
+
+    buffer = std::atomic_load(&stream_buffer_);
+
+    if (nullptr == buffer)
+    {
+        buffer = std::make_shared<RingBuffer>(RECEIVE_BUFFER_SIZE);
+        std::atomic_store(&stream_buffer_, buffer);
+    }
+
+    const std::size_t count = std::min(buffer->Capacity() - buffer->Size(), rx_end_ - rx_begin_);
+
+    PushStream(&rx_buffer_[rx_begin_], count, rx_time_us_);
+    rx_begin_ += count;
+
+    peek_buffer_ = buffer;
+    return buffer->Peek(View);
+}
+
+void Echosounder::ConsumeData(std::size_t Size)
+{
+    const std::shared_ptr<RingBuffer> buffer = (nullptr != peek_buffer_) ? peek_buffer_ : std::atomic_load(&stream_buffer_);
+
+    peek_buffer_.reset();
+
+    if (nullptr != buffer)
+    {
+        buffer->Consume(Size);
+    }
+}
+
+int Echosounder::GetSonarInfo()
+{
+    int result = -1;
+
+    result = SendCommand(EchosounderCommandIds::IdInfo);
+
+    if (1 == result)
+    {
+        // Timeout of the next #info follows the real size of the response
+        command_timeouts_.SetResponseSize(EchosounderCommandIds::IdInfo, command_result_.size());
+        GetAllValues();
+    }
+
+    return result;
+}
+
+void Echosounder::GetSettings()
+{
+    GetSettingsCommand();
+}
+
+int Echosounder::GetSettingsCommand()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Port belongs to the event loop until DetachIO()
+    if (false != io_mode_)
+    {
+        return -1;
+    }
+
+    if (false == is_detected_)
+    {
+        return -2;
+    }
+
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    return GetSonarInfo();
+}
+
+void Echosounder::SetSettings()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if ((false != is_detected_) && (false == io_mode_))
+    {
+        if (false != is_running_)
+        {
+            Stop();
+        }
+
+        std::vector<SettingValue> items;
+        SetChangedValues(items);
+    }
+}
+
+void Echosounder::Start()
+{
+    StartCommand();
+}
+
+int Echosounder::StartCommand()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Port belongs to the event loop until DetachIO()
+    if (false != io_mode_)
+    {
+        return -1;
+    }
+
+    if (false == is_detected_)
+    {
+        return -2;
+    }
+
+    return (false == is_running_) ? SendCommand(EchosounderCommandIds::IdGo) : 1;
+}
+
+void Echosounder::Stop()
+{
+    StopCommand();
+}
+
+int Echosounder::StopCommand()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Port belongs to the event loop until DetachIO()
+    if (false != io_mode_)
+    {
+        return -1;
+    }
+
+    if ((false != is_detected_) && (false != is_running_))
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        // Full detection is the fallback if the echosounder does not answer the break-in
+        if ((false != BreakIn()) || (false != Detect()))
+        {
+            is_running_ = false;
+            stop_latency_us_.store(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+        }
+        else
+        {
+            stop_latency_us_.store(-1);
+            return -2;
+        }
+    }
+
+    return 1;
+}
+
+bool Echosounder::BreakIn()
+{
+    StreamingPause pause(*this);
+
+    // Running echosounder stops on any received line and answers with the prompt
+    for (int i = 0; i < STOP_ATTEMPTS; i++)
+    {
+        if (false == WriteCommand("\r"))
+        {
+            return false;
+        }
+
+        if (1 == WaitCommandPrompt(STOP_PROMPT_TIMEOUT_MS, true))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Echosounder::ArmTrigger()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false == echosounder_commands_.IsSupported(EchosounderCommandIds::IdPingonce))
+    {
+        return false;
+    }
+
+    if (false != IsTriggerArmed())
+    {
+        return true;
+    }
+
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    return SetValue(EchosounderCommandIds::IdPingonce, "1");
+}
+
+bool Echosounder::DisarmTrigger()
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false == IsTriggerArmed())
+    {
+        return true;
+    }
+
+    return SetValue(EchosounderCommandIds::IdPingonce, "0");
+}
+
+bool Echosounder::IsTriggerArmed() const
+{
+    long value = 0;
+    return (false != std::atomic_load(&settings_view_)->GetLong(EchosounderCommandIds::IdPingonce, value)) && (1 == value);
+}
+
+int64_t Echosounder::PingTimeoutMs() const
+{
+    long range = 0;
+
+    for (auto command : { EchosounderCommandIds::IdRange, EchosounderCommandIds::IdRangeH, EchosounderCommandIds::IdRangeL })
+    {
+        long value = 0;
+
+        if ((false != echosounder_settings_.GetLong(command, value)) && (value > range))
+        {
+            range = value;
+        }
+    }
+
+    // Echo from the end of the range plus printing of the result, range is in mm
+    return CommandTimeouts::Estimate(PING_OUTPUT_BYTES, transport_->GetBaudrate()) + (2 * range) / SOUND_SPEED_MIN_MPS;
+}
+
+int Echosounder::Trigger(EchosounderPing &Ping)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    Ping.latency_us = -1;
+    Ping.count = 0;
+
+    if (false != io_mode_)
+    {
+        return -1;
+    }
+
+    if (false == IsTriggerArmed())
+    {
+        return 2;
+    }
+
+    StreamingPause pause(*this);
+
+    if (false != is_running_)
+    {
+        Stop();
+    }
+
+    DiscardStaleInput();
+
+    const std::string trigger = std::string(echosounder_commands_[EchosounderCommandIds::IdGo].command_text) + '\r';
+    const auto begin = std::chrono::steady_clock::now();
+
+    if (false == WriteCommand(trigger))
+    {
+        return -2;
+    }
+
+    int result = SendCommandResponseCheck(EchosounderCommandIds::IdGo);
+
+    if (1 != result)
+    {
+        return result;
+    }
+
+    // Output of the ping is followed by the command prompt
+    result = -2;
+    response_matcher_.Reset();
+    const auto deadline = Until(PingTimeoutMs());
+
+    while (false != ReceiveData(deadline))
+    {
+        std::size_t consumed = 0;
+        const int token = response_matcher_.Feed(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, ResponseMatcher::PromptTokens, consumed);
+
+        ParsePing(&rx_buffer_[rx_begin_], consumed, rx_time_us_, Ping);
+        rx_begin_ += consumed;
+
+        if (ResponseMatcher::TokenPrompt == token)
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    if (1 == result)
+    {
+        is_running_ = false;
+        Ping.latency_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    }
+    else
+    {
+        // Echosounder is still taken as running, the next command stops it
+        stale_input_ = true;
+    }
+
+    return result;
+}
+
+int64_t Echosounder::GetStopLatency() const
+{
+    return stop_latency_us_.load();
+}
+
+void Echosounder::DetectAndGetInfo()
+{
+    is_detected_ = Detect();
+
+    if (false != is_detected_)
+    {
+        GetSonarInfo();
+    }
+}
+
+bool Echosounder::Detect()
+{
+    return Detect(std::vector<uint32_t>());
+}
+
+bool Echosounder::Detect(const std::vector<uint32_t> &Baudrates)
+{
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    // Port belongs to the event loop until DetachIO()
+    if (false != io_mode_)
+    {
+        return false;
+    }
+
+    StreamingPause pause(*this);
+
+    // Detection has its own receive buffer, data received so far is stale
+    rx_begin_ = 0;
+    rx_end_ = 0;
+
+    EchosounderDetector detector(transport_);
+    EchosounderDetectInfo info;
+
+    detector.SetDeadline(deadline_);
+    const bool result = detector.Detect(Baudrates, info);
+
+    if (false != result)
+    {
+        detect_info_ = info;
+        is_running_ = false;
+        command_timeouts_.SetBaudrate(transport_->GetBaudrate());
+    }
+
+    return result;
+}
+
+const EchosounderDetectInfo &Echosounder::GetDetectInfo() const
+{
+    return detect_info_;
+}
+
+void Echosounder::SetCurrentTime()
+{
+    // Echosounder takes whole seconds, so the next second is sent to arrive right at its beginning
     const auto now = std::chrono::system_clock::now();
-    const auto timenow = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    const int64_t nowus = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    int64_t second = nowus / 1000000LL + 1;
+    const std::string command = echosounder_commands_[EchosounderCommandIds::IdTime].command_text;
+    const uint32_t baudrate = (0 != transport_->GetBaudrate()) ? transport_->GetBaudrate() : DEFAULT_BAUDRATE;
+    const int64_t transferus = static_cast<int64_t>(command.size() + std::to_string(second).size() + 2) * 10LL * 1000000LL / baudrate;
+    const auto sendtime = now + std::chrono::microseconds(std::max<int64_t>(0, second * 1000000LL - nowus - transferus));
+
+    // Most of the wait is done without the port, only the time to stop the echosounder is left
+    std::this_thread::sleep_until(sendtime - std::chrono::milliseconds(STOP_PROMPT_TIMEOUT_MS));
 
-    SetValue(EchosounderCommandIds::IdTime, std::to_string(timenow));
+    std::lock_guard<std::recursive_mutex> lock(port_mutex_);
+
+    if (false != io_mode_)
+    {
+        return;
+    }
+
+    StreamingPause pause(*this);
+    const bool wasrunning = is_running_;
+
+    if (false != wasrunning)
+    {
+        Stop();
+    }
+
+    const auto left = sendtime - std::chrono::system_clock::now();
+
+    if (std::chrono::steady_clock::now() + left <= deadline_)
+    {
+        std::this_thread::sleep_until(sendtime);
+    }
+    else
+    {
+        // No time to wait, the nearest second is set at once
+        const int64_t arrivalus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() + transferus;
+        second = (arrivalus + 500000LL) / 1000000LL;
+    }
+
+    time_sync_last_us_.store(ClockModel::MonotonicUs());
+
+    if (1 == SetValueCommand(EchosounderCommandIds::IdTime, std::to_string(second)))
+    {
+        // Samples of the old device time do not apply any more
+        clock_model_.Reset();
+    }
+
+    Resume(wasrunning);
+}
+
+void Echosounder::SetTimeSyncBound(int64_t BoundUs)
+{
+    // Smaller bounds are below what setting whole seconds can reach and would resync on every check
+    time_sync_bound_us_.store((BoundUs > 0) ? std::max<int64_t>(BoundUs, TIME_SYNC_MIN_BOUND_US) : 0);
+}
+
+bool Echosounder::GetClockState(EchosounderClockState &State) const
+{
+    return clock_model_.GetState(State);
+}
+
+bool Echosounder::ToDeviceTime(int64_t HostUs, int64_t &DeviceUs) const
+{
+    return clock_model_.ToDevice(HostUs, DeviceUs);
+}
+
+bool Echosounder::ToHostTime(int64_t DeviceUs, int64_t &HostUs) const
+{
+    return clock_model_.ToHost(DeviceUs, HostUs);
 }
 
 bool Echosounder::IsRunning()
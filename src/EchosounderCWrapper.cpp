@@ -7,7 +7,18 @@
 #include "DualEchosounder.h"
 #include "SingleEchosounder.h"
 #include "EchosounderCWrapper.h"
+#include "EchosounderDiscovery.h"
+#include "RecordingReader.h"
+#include "ReplayTransport.h"
+#if defined(__linux__)
+#include "EchosounderReactor.h"
+#endif
 #include "serial/serial.h"
+#include "SerialTransport.h"
+
+#if !defined(_WIN32)
+#include "PosixTransport.h"
+#endif
 
 #if defined(_MSC_VER) && _MSC_VER < 1900
 
@@ -40,14 +51,64 @@ __inline int c99_snprintf(char *outBuf, size_t size, const char *format, ...)
 
 #endif
 
+namespace
+{
+    std::shared_ptr<ITransport> OpenTransport(const std::string &portpath, uint32_t baudrate)
+    {
+#if defined(_WIN32)
+        std::shared_ptr<serial::Serial> serialPort(new serial::Serial(portpath, baudrate, serial::Timeout::simpleTimeout(SERIALPORT_TIMEOUT_MS)));
+        return std::make_shared<SerialTransport>(serialPort);
+#else
+        return std::make_shared<PosixTransport>(portpath, baudrate);
+#endif
+    }
+
+    std::chrono::steady_clock::time_point Deadline(uint32_t timeoutms)
+    {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms);
+    }
+
+    size_t SetValues(Echosounder *ss, pEchosounderSetting settings, size_t count, std::chrono::steady_clock::time_point deadline)
+    {
+        std::vector<Echosounder::SettingValue> items(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i].command = settings[i].command;
+            items[i].value = settings[i].value.value_text;
+            items[i].result = 0;
+        }
+
+        const size_t result = ss->SetValues(items, deadline);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            settings[i].result = items[i].result;
+        }
+
+        return result;
+    }
+
+    Echosounder::Completion MakeCompletion(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata)
+    {
+        Echosounder::Completion done;
+
+        if (nullptr != completion)
+        {
+            done = [snrctx, completion, userdata](int result) { completion(snrctx, result, userdata); };
+        }
+
+        return done;
+    }
+}
+
 pSnrCtx SingleEchosounderOpen(const char *portpath, uint32_t baudrate)
 {
     pSnrCtx ctx = nullptr;
 
     try
     {
-        std::shared_ptr<serial::Serial> serialPort(new serial::Serial(portpath, baudrate, serial::Timeout::simpleTimeout(SERIALPORT_TIMEOUT_MS)));
-        ctx = reinterpret_cast<pSnrCtx>(new SingleEchosounder(serialPort));
+        ctx = reinterpret_cast<pSnrCtx>(new SingleEchosounder(OpenTransport(portpath, baudrate)));
     }
     catch(...)
     {
@@ -57,14 +118,76 @@ pSnrCtx SingleEchosounderOpen(const char *portpath, uint32_t baudrate)
     return ctx;
 }
 
+pSnrCtx SingleEchosounderReplayOpen(const char *path, double speed)
+{
+    pSnrCtx ctx = nullptr;
+
+    try
+    {
+        // Recording has no echosounder to detect
+        auto transport = std::make_shared<ReplayTransport>(path, speed);
+        ctx = reinterpret_cast<pSnrCtx>(new SingleEchosounder(transport, nullptr));
+        transport->Play();
+    }
+    catch(...)
+    {
+        // In case of any exception this function returns nullptr
+    }
+
+    return ctx;
+}
+
+pSnrCtx DualEchosounderReplayOpen(const char *path, double speed)
+{
+    pSnrCtx ctx = nullptr;
+
+    try
+    {
+        auto transport = std::make_shared<ReplayTransport>(path, speed);
+        ctx = reinterpret_cast<pSnrCtx>(new DualEchosounder(transport, nullptr));
+        transport->Play();
+    }
+    catch(...)
+    {
+        // In case of any exception this function returns nullptr
+    }
+
+    return ctx;
+}
+
+int EchosounderReplaySeek(pSnrCtx snrctx, int64_t time_us)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    auto replay = dynamic_cast<ReplayTransport*>(ss->GetTransport().get());
+
+    if (nullptr == replay)
+    {
+        return -1;
+    }
+
+    return (false != replay->Seek(time_us)) ? 0 : -1;
+}
+
+int EchosounderReplayIsFinished(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    auto replay = dynamic_cast<ReplayTransport*>(ss->GetTransport().get());
+
+    if (nullptr == replay)
+    {
+        return -1;
+    }
+
+    return (false != replay->IsFinished()) ? 1 : 0;
+}
+
 pSnrCtx DualEchosounderOpen(const char* portpath, uint32_t baudrate)
 {
     pSnrCtx ctx = nullptr;
 
     try
     {
-        std::shared_ptr<serial::Serial> serialPort(new serial::Serial(portpath, baudrate, serial::Timeout::simpleTimeout(SERIALPORT_TIMEOUT_MS)));
-        ctx = reinterpret_cast<pSnrCtx>(new DualEchosounder(serialPort));
+        ctx = reinterpret_cast<pSnrCtx>(new DualEchosounder(OpenTransport(portpath, baudrate)));
     }
     catch (...)
     {
@@ -74,6 +197,108 @@ pSnrCtx DualEchosounderOpen(const char* portpath, uint32_t baudrate)
     return ctx;
 }
 
+int EchosounderProbe(const char *portpath, const uint32_t *baudrates, size_t count, EchosounderDetectInfo_t *info)
+{
+    int result = -1;
+
+    try
+    {
+        if (count > 0)
+        {
+            EchosounderDetector detector(OpenTransport(portpath, baudrates[0]));
+            result = (false != detector.Detect(std::vector<uint32_t>(baudrates, baudrates + count), *info)) ? 0 : -1;
+        }
+    }
+    catch (...)
+    {
+        // In case of any exception echosounder is not found
+    }
+
+    return result;
+}
+
+pSnrCtx EchosounderOpen(const char *portpath, const uint32_t *baudrates, size_t count, EchosounderDetectInfo_t *info)
+{
+    pSnrCtx ctx = nullptr;
+
+    try
+    {
+        if (count > 0)
+        {
+            auto transport = OpenTransport(portpath, baudrates[0]);
+            EchosounderDetector detector(transport);
+            EchosounderDetectInfo_t detectinfo;
+
+            if (false != detector.Detect(std::vector<uint32_t>(baudrates, baudrates + count), detectinfo))
+            {
+                Echosounder *ss = nullptr;
+
+                // Echosounder is already found, it is not detected again
+                if (false != detectinfo.dual)
+                {
+                    ss = new DualEchosounder(transport, &detectinfo);
+                }
+                else
+                {
+                    ss = new SingleEchosounder(transport, &detectinfo);
+                }
+
+                if (nullptr != info)
+                {
+                    *info = detectinfo;
+                }
+
+                ctx = reinterpret_cast<pSnrCtx>(ss);
+            }
+        }
+    }
+    catch (...)
+    {
+        // In case of any exception this function returns nullptr
+    }
+
+    return ctx;
+}
+
+void EchosounderGetDetectInfo(pSnrCtx snrctx, EchosounderDetectInfo_t *info)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    *info = ss->GetDetectInfo();
+}
+
+size_t EchosounderDiscover(const char *const *portpaths, size_t portcount, const uint32_t *baudrates, size_t count,
+                           size_t threads, pEchosounderPort units, size_t size)
+{
+    size_t found = 0;
+
+    try
+    {
+        if (count > 0)
+        {
+            std::vector<std::string> ports = (nullptr != portpaths) ?
+                std::vector<std::string>(portpaths, portpaths + portcount) : EchosounderDiscovery::ListPorts();
+
+            EchosounderDiscovery discovery(OpenTransport);
+            const auto detected = discovery.Discover(ports, std::vector<uint32_t>(baudrates, baudrates + count), threads);
+
+            for (size_t i = 0; (i < detected.size()) && (i < size); i++)
+            {
+                memset(&units[i], 0, sizeof(units[i]));
+                strncpy(units[i].port, detected[i].port.c_str(), sizeof(units[i].port) - 1);
+                units[i].info = detected[i].info;
+            }
+
+            found = detected.size();
+        }
+    }
+    catch (...)
+    {
+        // In case of any exception nothing is found
+    }
+
+    return found;
+}
+
 void EchosounderClose(pSnrCtx snrctx)
 {
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
@@ -84,7 +309,118 @@ void EchosounderClose(pSnrCtx snrctx)
 size_t EchosounderReadData(pSnrCtx snrctx, uint8_t *buffer, size_t size)
 {
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
-    return ss->GetSerialPort()->read(buffer, size);
+    return ss->ReadData(buffer, size, ss->GetReadTimeout());
+}
+
+size_t EchosounderPeekData(pSnrCtx snrctx, pEchosounderDataView view)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    DataView dataview;
+
+    const size_t size = ss->PeekData(dataview, ss->GetReadTimeout());
+
+    view->first = dataview.first;
+    view->first_size = dataview.first_size;
+    view->second = dataview.second;
+    view->second_size = dataview.second_size;
+
+    return size;
+}
+
+void EchosounderConsumeData(pSnrCtx snrctx, size_t size)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->ConsumeData(size);
+}
+
+int EchosounderReadRecord(pSnrCtx snrctx, EchosounderNmeaRecord_t *record)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ReadRecord(*record);
+
+    return (false != result) ? 0 : -1;
+}
+
+void EchosounderGetNmeaStatistics(pSnrCtx snrctx, EchosounderNmeaStatistics_t *statistics)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->GetNmeaStatistics(*statistics);
+}
+
+int DualEchosounderSetChannelOutput(pSnrCtx snrctx, bool records, bool pairs)
+{
+    auto ds = dynamic_cast<DualEchosounder*>(reinterpret_cast<Echosounder*>(snrctx));
+
+    if (nullptr == ds)
+    {
+        return -1;
+    }
+
+    ds->SetChannelOutput(records, pairs);
+
+    return 0;
+}
+
+int DualEchosounderReadChannelRecord(pSnrCtx snrctx, EchosounderChannel_t channel, EchosounderNmeaRecord_t *record)
+{
+    auto ds = dynamic_cast<DualEchosounder*>(reinterpret_cast<Echosounder*>(snrctx));
+
+    if ((nullptr == ds) || (channel < ChannelHigh) || (channel >= ChannelCount))
+    {
+        return -1;
+    }
+
+    bool result = ds->ReadChannelRecord(channel, *record);
+
+    return (false != result) ? 0 : -1;
+}
+
+int DualEchosounderReadChannelPair(pSnrCtx snrctx, EchosounderChannelPair_t *pair)
+{
+    auto ds = dynamic_cast<DualEchosounder*>(reinterpret_cast<Echosounder*>(snrctx));
+
+    if (nullptr == ds)
+    {
+        return -1;
+    }
+
+    bool result = ds->ReadChannelPair(*pair);
+
+    return (false != result) ? 0 : -1;
+}
+
+int DualEchosounderGetChannelStatistics(pSnrCtx snrctx, EchosounderChannelStatistics_t *statistics)
+{
+    auto ds = dynamic_cast<DualEchosounder*>(reinterpret_cast<Echosounder*>(snrctx));
+
+    if (nullptr == ds)
+    {
+        return -1;
+    }
+
+    ds->GetChannelStatistics(*statistics);
+
+    return 0;
+}
+
+int EchosounderStartStreaming(pSnrCtx snrctx, size_t buffersize)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->StartStreaming(buffersize);
+
+    return (false != result) ? 0 : -1;
+}
+
+void EchosounderStopStreaming(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->StopStreaming();
+}
+
+uint64_t EchosounderGetOverrunCount(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return ss->GetOverrunBytes();
 }
 
 long EchosounderValueToLong(pcEchosounderValue value)
@@ -130,6 +466,22 @@ int EchosounderGetValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pEchoso
     return (ssvalue.length() > 0) ? 0 : -1;
 }
 
+int EchosounderGetLongValue(pSnrCtx snrctx, EchosounderCommandIds_t command, long *value)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->GetValue(command, *value);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderGetFloatValue(pSnrCtx snrctx, EchosounderCommandIds_t command, float *value)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->GetValue(command, *value);
+
+    return (false != result) ? 0 : -1;
+}
+
 int EchosounderSetValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value)
 {
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
@@ -138,6 +490,326 @@ int EchosounderSetValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchos
     return (false != result) ? 0 : -1;
 }
 
+int EchosounderStageValue(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->StageValue(command, value->value_text);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderApplySettings(pSnrCtx snrctx, bool verify)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ApplySettings(verify);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderSetValueAsync(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value,
+                             EchosounderCompletion completion, void *userdata)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    int result = -1;
+
+    try
+    {
+        ss->SetValueAsync(command, value->value_text, MakeCompletion(snrctx, completion, userdata));
+        result = 0;
+    }
+    catch (...)
+    {
+        // In case of any exception command is not queued
+    }
+
+    return result;
+}
+
+int EchosounderGetSettingsAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    int result = -1;
+
+    try
+    {
+        ss->GetSettingsAsync(MakeCompletion(snrctx, completion, userdata));
+        result = 0;
+    }
+    catch (...)
+    {
+        // In case of any exception command is not queued
+    }
+
+    return result;
+}
+
+int EchosounderStartAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    int result = -1;
+
+    try
+    {
+        ss->StartAsync(MakeCompletion(snrctx, completion, userdata));
+        result = 0;
+    }
+    catch (...)
+    {
+        // In case of any exception command is not queued
+    }
+
+    return result;
+}
+
+int EchosounderStopAsync(pSnrCtx snrctx, EchosounderCompletion completion, void *userdata)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    int result = -1;
+
+    try
+    {
+        ss->StopAsync(MakeCompletion(snrctx, completion, userdata));
+        result = 0;
+    }
+    catch (...)
+    {
+        // In case of any exception command is not queued
+    }
+
+    return result;
+}
+
+size_t EchosounderGetPendingCommands(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return ss->GetPendingCommands();
+}
+
+int EchosounderAttachIO(pSnrCtx snrctx, size_t buffersize, EchosounderWakeup wakeup, void *userdata)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    std::function<void()> notify;
+
+    if (nullptr != wakeup)
+    {
+        notify = [snrctx, wakeup, userdata]() { wakeup(snrctx, userdata); };
+    }
+    else
+    {
+        notify = []() {};
+    }
+
+    try
+    {
+        return (false != ss->AttachIO(notify, buffersize)) ? 0 : -1;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
+
+void EchosounderDetachIO(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->DetachIO();
+}
+
+int EchosounderGetFd(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return ss->GetFd();
+}
+
+bool EchosounderWantsWrite(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return ss->WantsWrite();
+}
+
+int EchosounderProcessIO(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+
+    try
+    {
+        ss->ProcessIO();
+    }
+    catch (...)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t EchosounderGetIoTimeout(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    const auto deadline = ss->GetIoDeadline();
+
+    if (std::chrono::steady_clock::time_point::max() == deadline)
+    {
+        return -1;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    if (deadline <= now)
+    {
+        return 0;
+    }
+
+    return static_cast<int32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+}
+
+pSnrReactor EchosounderReactorCreate(void)
+{
+#if defined(__linux__)
+    try
+    {
+        return new EchosounderReactor();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+#else
+    return nullptr;
+#endif
+}
+
+void EchosounderReactorDestroy(pSnrReactor reactor)
+{
+#if defined(__linux__)
+    auto rr = reinterpret_cast<EchosounderReactor*>(reactor);
+    delete rr;
+#else
+    (void)reactor;
+#endif
+}
+
+int EchosounderReactorRegister(pSnrReactor reactor, pSnrCtx snrctx, size_t buffersize)
+{
+#if defined(__linux__)
+    auto rr = reinterpret_cast<EchosounderReactor*>(reactor);
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+
+    try
+    {
+        return (false != rr->Register(*ss, buffersize)) ? 0 : -1;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+#else
+    (void)reactor;
+    (void)snrctx;
+    (void)buffersize;
+    return -1;
+#endif
+}
+
+int EchosounderReactorUnregister(pSnrReactor reactor, pSnrCtx snrctx)
+{
+#if defined(__linux__)
+    auto rr = reinterpret_cast<EchosounderReactor*>(reactor);
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+
+    try
+    {
+        return (false != rr->Unregister(*ss)) ? 0 : -1;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+#else
+    (void)reactor;
+    (void)snrctx;
+    return -1;
+#endif
+}
+
+size_t EchosounderSetValues(pSnrCtx snrctx, pEchosounderSetting settings, size_t count)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return SetValues(ss, settings, count, std::chrono::steady_clock::time_point::max());
+}
+
+int EchosounderSetValueWithin(pSnrCtx snrctx, EchosounderCommandIds_t command, pcEchosounderValue value, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->SetValue(command, value->value_text, Deadline(timeoutms));
+
+    return (false != result) ? 0 : -1;
+}
+
+size_t EchosounderSetValuesWithin(pSnrCtx snrctx, pEchosounderSetting settings, size_t count, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return SetValues(ss, settings, count, Deadline(timeoutms));
+}
+
+int EchosounderApplySettingsWithin(pSnrCtx snrctx, bool verify, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ApplySettings(verify, Deadline(timeoutms));
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderStartWithin(pSnrCtx snrctx, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->Start(Deadline(timeoutms));
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderStopWithin(pSnrCtx snrctx, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->Stop(Deadline(timeoutms));
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderGetSettingsWithin(pSnrCtx snrctx, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->GetSettings(Deadline(timeoutms));
+
+    return (false != result) ? 0 : -1;
+}
+
+void EchosounderSetCommandTimeout(pSnrCtx snrctx, EchosounderCommandIds_t command, const EchosounderTimeout_t *timeout)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+
+    if (nullptr != timeout)
+    {
+        ss->SetCommandTimeout(command, *timeout);
+    }
+    else
+    {
+        ss->ResetCommandTimeout(command);
+    }
+}
+
+void EchosounderGetCommandTimeout(pSnrCtx snrctx, EchosounderCommandIds_t command, EchosounderTimeout_t *timeout)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    *timeout = ss->GetCommandTimeout(command);
+}
+
+void EchosounderSetReadTimeout(pSnrCtx snrctx, uint32_t timeoutms)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->SetReadTimeout(timeoutms);
+}
+
 bool EchosounderDetect(pSnrCtx snrctx)
 {
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
@@ -156,6 +828,36 @@ void EchosounderStop(pSnrCtx snrctx)
     ss->Stop();
 }
 
+int64_t EchosounderGetStopLatency(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    return ss->GetStopLatency();
+}
+
+int EchosounderArmTrigger(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ArmTrigger();
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderDisarmTrigger(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->DisarmTrigger();
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderTrigger(pSnrCtx snrctx, EchosounderPing_t *ping)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    int result = ss->Trigger(*ping);
+
+    return (1 == result) ? 0 : -1;
+}
+
 bool EchosounderIsRunning(pSnrCtx snrctx)
 {
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
@@ -173,3 +875,118 @@ void EchosounderSetCurrentTime(pSnrCtx snrctx)
     auto ss = reinterpret_cast<Echosounder*>(snrctx);
     ss->SetCurrentTime();
 }
+
+void EchosounderSetTimeSyncBound(pSnrCtx snrctx, uint32_t bound_us)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->SetTimeSyncBound(bound_us);
+}
+
+int64_t EchosounderGetMonotonicTime(void)
+{
+    return ClockModel::MonotonicUs();
+}
+
+int EchosounderGetClockState(pSnrCtx snrctx, EchosounderClockState_t *state)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->GetClockState(*state);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderHostToDeviceTime(pSnrCtx snrctx, int64_t host_us, int64_t *device_us)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ToDeviceTime(host_us, *device_us);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderDeviceToHostTime(pSnrCtx snrctx, int64_t device_us, int64_t *host_us)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->ToHostTime(device_us, *host_us);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderStartRecording(pSnrCtx snrctx, const char *path, size_t segment_size)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->StartRecording(path, segment_size);
+
+    return (false != result) ? 0 : -1;
+}
+
+void EchosounderStopRecording(pSnrCtx snrctx)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    ss->StopRecording();
+}
+
+int EchosounderGetRecordingStatistics(pSnrCtx snrctx, EchosounderRecordingStatistics_t *statistics)
+{
+    auto ss = reinterpret_cast<Echosounder*>(snrctx);
+    bool result = ss->GetRecordingStatistics(*statistics);
+
+    return (false != result) ? 0 : -1;
+}
+
+pSnrRecording EchosounderRecordingOpen(const char *path)
+{
+    RecordingReader *recording = new RecordingReader();
+
+    if (false == recording->Open(path))
+    {
+        delete recording;
+        return nullptr;
+    }
+
+    return recording;
+}
+
+void EchosounderRecordingClose(pSnrRecording recording)
+{
+    delete reinterpret_cast<RecordingReader*>(recording);
+}
+
+int EchosounderRecordingGetTimeRange(pSnrRecording recording, int64_t *begin_us, int64_t *end_us)
+{
+    auto rr = reinterpret_cast<RecordingReader*>(recording);
+    bool result = rr->GetTimeRange(*begin_us, *end_us);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderRecordingSeek(pSnrRecording recording, int64_t time_us)
+{
+    auto rr = reinterpret_cast<RecordingReader*>(recording);
+    bool result = rr->Seek(time_us);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderRecordingRead(pSnrRecording recording, EchosounderRecordingEntry_t *entry)
+{
+    auto rr = reinterpret_cast<RecordingReader*>(recording);
+    bool result = rr->Read(*entry);
+
+    return (false != result) ? 0 : -1;
+}
+
+int EchosounderRecordingGetValue(pSnrRecording recording, EchosounderCommandIds_t command, pEchosounderValue value)
+{
+    auto rr = reinterpret_cast<RecordingReader*>(recording);
+    std::string text;
+
+    if (false == rr->GetValue(command, text))
+    {
+        return -1;
+    }
+
+    snprintf(value->value_text, sizeof(value->value_text), "%s", text.c_str());
+    value->value_len = static_cast<int>(strlen(value->value_text));
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "EchosounderCommandTable.h"
+
+namespace
+{
+    constexpr EchosounderCommandList SingleEchosounderCommandList[] =
+    {
+        /* IdInfo             */ { "#info",       "",      ValueNone,    "" },
+        /* IdGo               */ { "#go",         "",      ValueNone,    "" },
+        /* IdRange            */ { "#range",      "50000", ValueInteger, "#range" },
+        /* IdRangeH           */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdRangeL           */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdInterval         */ { "#interval",   "0.1",   ValueFloat,   "#interval" },
+        /* IdPingonce         */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTxLength         */ { "#txlength",   "50",    ValueInteger, "#txlength" },
+        /* IdTxLengthH        */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTxLengthL        */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTxPower          */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdGain             */ { "#gain",       "0.0",   ValueFloat,   "#gain" },
+        /* IdGainH            */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdGainL            */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTVGMode          */ { "#tvgmode",    "1",     ValueMode,    "#tvgmode" },
+        /* IdTVGAbs           */ { "#tvgabs",     "0.140", ValueFloat,   "#tvgabs" },
+        /* IdTVGAbsH          */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTVGAbsL          */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTVGSprd          */ { "#tvgsprd",    "15.0",  ValueFloat,   "#tvgsprd" },
+        /* IdTVGSprdH         */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTVGSprdL         */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdAttn             */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdAttnH            */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdAttnL            */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdSound            */ { "#sound",      "1500",  ValueInteger, "#sound" },
+        /* IdDeadzone         */ { "#deadzone",   "300",   ValueInteger, "#deadzone" },
+        /* IdDeadzoneH        */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdDeadzoneL        */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdThreshold        */ { "#threshold",  "10",    ValueInteger, "#threshold" },
+        /* IdThresholdH       */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdThresholdL       */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdOffset           */ { "#offset",     "0",     ValueInteger, "#offset" },
+        /* IdOffsetH          */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdOffsetL          */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdMedianFlt        */ { "#medianflt",  "2",     ValueInteger, "#medianflt" },
+        /* IdSMAFlt           */ { "#movavgflt",  "1",     ValueInteger, "#movavgflt" },
+        /* IdNMEADBT          */ { "#nmeadbt",    "1",     ValueFlag,    "#nmeadbt" },
+        /* IdNMEADPT          */ { "#nmeadpt",    "1",     ValueFlag,    "#nmeadpt" },
+        /* IdNMEAMTW          */ { "#nmeamtw",    "1",     ValueFlag,    "#nmeamtw" },
+        /* IdNMEAXDR          */ { "#nmeaxdr",    "1",     ValueFlag,    "#nmeaxdr" },
+        /* IdNMEAEMA          */ { "#nmeaema",    "1",     ValueFlag,    "#nmeaema" },
+        /* IdNMEAZDA          */ { "#nmeazda",    "0",     ValueFlag,    "#nmeazda" },
+        /* IdOutrate          */ { "#nmearate",   "0.0",   ValueFloat,   "#outrate" },
+        /* IdNMEADPTOffset    */ { "#nmeadptoff", "0.0",   ValueFloat,   "#nmeadptoff" },
+        /* IdNMEADPTZero      */ { "#nmeadpzero", "1",     ValueFlag,    "#nmeadpzero" },
+        /* IdOutput           */ { "#output",     "3",     ValueInteger, "#output" },
+        /* IdAltprec          */ { "#altprec",    "3",     ValueMode,    "#altprec" },
+        /* IdSamplFreq        */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdTime             */ { "#time",       "0",     ValueInteger, "#time" },
+        /* IdSyncExtern       */ { "#syncextern", "0",     ValueFlag,    "#syncextern" },
+        /* IdSyncExternMode   */ { "#syncextmod", "1",     ValueFlag,    "#syncextmod" },
+        /* IdSyncOutPolarity  */ { "#syncoutpol", "1",     ValueFlag,    "#syncoutpol" },
+        /* IdAnlgMode         */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdAnlgRate         */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdAnlgMaxOut       */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdVersion          */ { "#version",    "",      ValueText,    "S/W Ver" },
+        /* IdSetHighFreq      */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdSetLowFreq       */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdSetDualFreq      */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdGetHighFreq      */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdGetLowFreq       */ { nullptr,       nullptr, ValueNone,    nullptr },
+        /* IdGetWorkFreq      */ { nullptr,       nullptr, ValueNone,    nullptr }
+    };
+
+    constexpr EchosounderCommandList DualEchosounderCommandList[] =
+    {
+        /* IdInfo             */ { "#info",       "",      ValueNone,    "" },
+        /* IdGo               */ { "#go",         "",      ValueNone,    "" },
+        /* IdRange            */ { "#range",      "50000", ValueInteger, "#range" },
+        /* IdRangeH           */ { "#rangeh",     "50000", ValueInteger, "#rangeh" },
+        /* IdRangeL           */ { "#rangel",     "50000", ValueInteger, "#rangel" },
+        /* IdInterval         */ { "#interval",   "1.0",   ValueFloat,   "#interval" },
+        /* IdPingonce         */ { "#pingonce",   "0",     ValueFlag,    "#pingonce" },
+        /* IdTxLength         */ { "#txlength",   "50",    ValueInteger, "#txlength" },
+        /* IdTxLengthH        */ { "#txlengthh",  "50",    ValueInteger, "#txlengthh" },
+        /* IdTxLengthL        */ { "#txlengthl",  "100",   ValueInteger, "#txlengthl" },
+        /* IdTxPower          */ { "#txpower",    "0.0",   ValueFloat,   "#txpower" },
+        /* IdGain             */ { "#gain",       "0.0",   ValueFloat,   "#gain" },
+        /* IdGainH            */ { "#gainh",      "0.0",   ValueFloat,   "#gainh" },
+        /* IdGainL            */ { "#gainl",      "0.0",   ValueFloat,   "#gainl" },
+        /* IdTVGMode          */ { "#tvgmode",    "1",     ValueMode,    "#tvgmode" },
+        /* IdTVGAbs           */ { "#tvgabs",     "0.140", ValueFloat,   "#tvgabs" },
+        /* IdTVGAbsH          */ { "#tvgabsh",    "0.140", ValueFloat,   "#tvgabsh" },
+        /* IdTVGAbsL          */ { "#tvgabsl",    "0.060", ValueFloat,   "#tvgabsl" },
+        /* IdTVGSprd          */ { "#tvgsprd",    "15.0",  ValueFloat,   "#tvgsprd" },
+        /* IdTVGSprdH         */ { "#tvgsprdh",   "15.0",  ValueFloat,   "#tvgsprdh" },
+        /* IdTVGSprdL         */ { "#tvgsprdl",   "15.0",  ValueFloat,   "#tvgsprdl" },
+        /* IdAttn             */ { "#attn",       "0",     ValueInteger, "#attn" },
+        /* IdAttnH            */ { "#attnh",      "0",     ValueInteger, "#attnh" },
+        /* IdAttnL            */ { "#attnl",      "0",     ValueInteger, "#attnl" },
+        /* IdSound            */ { "#sound",      "1500",  ValueInteger, "#sound" },
+        /* IdDeadzone         */ { "#deadzone",   "300",   ValueInteger, "#deadzone" },
+        /* IdDeadzoneH        */ { "#deadzoneh",  "300",   ValueInteger, "#deadzoneh" },
+        /* IdDeadzoneL        */ { "#deadzonel",  "500",   ValueInteger, "#deadzonel" },
+        /* IdThreshold        */ { "#threshold",  "10",    ValueInteger, "#threshold" },
+        /* IdThresholdH       */ { "#thresholdh", "10",    ValueInteger, "#thresholdh" },
+        /* IdThresholdL       */ { "#thresholdl", "10",    ValueInteger, "#thresholdl" },
+        /* IdOffset           */ { "#offset",     "0",     ValueInteger, "#offset" },
+        /* IdOffsetH          */ { "#offseth",    "0",     ValueInteger, "#offseth" },
+        /* IdOffsetL          */ { "#offsetl",    "0",     ValueInteger, "#offsetl" },
+        /* IdMedianFlt        */ { "#medianflt",  "2",     ValueInteger, "#medianflt" },
+        /* IdSMAFlt           */ { "#movavgflt",  "1",     ValueInteger, "#movavgflt" },
+        /* IdNMEADBT          */ { "#nmeadbt",    "1",     ValueFlag,    "#nmeadbt" },
+        /* IdNMEADPT          */ { "#nmeadpt",    "0",     ValueFlag,    "#nmeadpt" },
+        /* IdNMEAMTW          */ { "#nmeamtw",    "1",     ValueFlag,    "#nmeamtw" },
+        /* IdNMEAXDR          */ { "#nmeaxdr",    "1",     ValueFlag,    "#nmeaxdr" },
+        /* IdNMEAEMA          */ { "#nmeaema",    "0",     ValueFlag,    "#nmeaema" },
+        /* IdNMEAZDA          */ { "#nmeazda",    "0",     ValueFlag,    "#nmeazda" },
+        /* IdOutrate          */ { "#outrate",    "0.0",   ValueFloat,   "#nmearate" },
+        /* IdNMEADPTOffset    */ { "#nmeadptoff", "0.0",   ValueFloat,   "#nmeadptoff" },
+        /* IdNMEADPTZero      */ { "#nmeadpzero", "1",     ValueFlag,    "#nmeadpzero" },
+        /* IdOutput           */ { "#output",     "3",     ValueInteger, "#output" },
+        /* IdAltprec          */ { "#altprec",    "3",     ValueMode,    "#altprec" },
+        /* IdSamplFreq        */ { "#samplfreq",  "0",     ValueInteger, "#samplfreq" },
+        /* IdTime             */ { "#time",       "0",     ValueInteger, "#time" },
+        /* IdSyncExtern       */ { "#syncextern", "0",     ValueFlag,    "#syncextern" },
+        /* IdSyncExternMode   */ { "#syncextmod", "1",     ValueFlag,    "#syncextmod" },
+        /* IdSyncOutPolarity  */ { "#syncoutpol", "1",     ValueFlag,    "#syncoutpol" },
+        /* IdAnlgMode         */ { "#anlgmode",   "0",     ValueFlag,    "#anlgmode" },
+        /* IdAnlgRate         */ { "#anlgrate",   "0.100", ValueFloat,   "#anlgrate" },
+        /* IdAnlgMaxOut       */ { "#anlgmax",    "4",     ValueMode,    "#anlgmax" },
+        /* IdVersion          */ { "#version",    "",      ValueText,    "S/W Ver" },
+        /* IdSetHighFreq      */ { "#setfh",      "",      ValueNone,    "" },
+        /* IdSetLowFreq       */ { "#setfl",      "",      ValueNone,    "" },
+        /* IdSetDualFreq      */ { "#setfd",      "",      ValueNone,    "" },
+        /* IdGetHighFreq      */ { "#getfh",      "",      ValueInteger, "High Frequency" },
+        /* IdGetLowFreq       */ { "#getfl",      "",      ValueInteger, "Low Frequency" },
+        /* IdGetWorkFreq      */ { "#getf",       "",      ValueInteger, "(Active)" }
+    };
+
+    /**
+    *   Bit per command id which has command text
+    */
+    constexpr uint64_t Capabilities(const EchosounderCommandList *List, std::size_t Count)
+    {
+        return (0 == Count) ? 0U : (Capabilities(List, Count - 1) | ((nullptr != List[Count - 1].command_text) ? (uint64_t(1) << (Count - 1)) : 0U));
+    }
+
+    constexpr bool IsCommand(const char *Text, const char *Expected)
+    {
+        return (nullptr != Text) && (*Text == *Expected) && (('\0' == *Text) || IsCommand(Text + 1, Expected + 1));
+    }
+
+    static_assert(sizeof(SingleEchosounderCommandList) / sizeof(SingleEchosounderCommandList[0]) == EchosounderCommandCount, "single echosounder table must have entry for every command id");
+    static_assert(sizeof(DualEchosounderCommandList) / sizeof(DualEchosounderCommandList[0]) == EchosounderCommandCount, "dual echosounder table must have entry for every command id");
+
+    // Spot checks that entries are in EchosounderCommandIds order
+    static_assert(IsCommand(SingleEchosounderCommandList[IdGo].command_text, "#go"), "single echosounder table order");
+    static_assert(IsCommand(SingleEchosounderCommandList[IdOffset].command_text, "#offset"), "single echosounder table order");
+    static_assert(IsCommand(SingleEchosounderCommandList[IdVersion].command_text, "#version"), "single echosounder table order");
+    static_assert(IsCommand(DualEchosounderCommandList[IdGo].command_text, "#go"), "dual echosounder table order");
+    static_assert(IsCommand(DualEchosounderCommandList[IdOffsetL].command_text, "#offsetl"), "dual echosounder table order");
+    static_assert(IsCommand(DualEchosounderCommandList[IdVersion].command_text, "#version"), "dual echosounder table order");
+    static_assert(IsCommand(DualEchosounderCommandList[IdGetWorkFreq].command_text, "#getf"), "dual echosounder table order");
+}
+
+extern constexpr EchosounderCommandTable SingleEchosounderCommands = { SingleEchosounderCommandList, Capabilities(SingleEchosounderCommandList, EchosounderCommandCount) };
+extern constexpr EchosounderCommandTable DualEchosounderCommands = { DualEchosounderCommandList, Capabilities(DualEchosounderCommandList, EchosounderCommandCount) };
+
+static_assert(SingleEchosounderCommands.IsSupported(IdRange) && !SingleEchosounderCommands.IsSupported(IdRangeH), "single echosounder capabilities");
+static_assert(DualEchosounderCommands.IsSupported(IdRangeH) && DualEchosounderCommands.IsSupported(IdSetDualFreq), "dual echosounder capabilities");
@@ -0,0 +1,201 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "EchosounderDetector.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CommandTimeouts.h"
+
+#define DETECT_RECEIVE_BUFFER_SIZE 512U
+#define DETECT_FIRST_WAIT_MS 20
+#define DETECT_MAX_WAIT_MS 320
+#define DETECT_BUDGET_MS 1500
+#define DETECT_SCAN_BUDGET_MS 400
+#define DETECT_RESPONSE_BYTES 256U
+#define DETECT_PROMPT_BYTES 8U
+
+EchosounderDetector::EchosounderDetector(std::shared_ptr<ITransport> Transport) :
+    transport_(Transport),
+    rx_buffer_(DETECT_RECEIVE_BUFFER_SIZE),
+    rx_begin_(0),
+    rx_end_(0),
+    deadline_(std::chrono::steady_clock::time_point::max())
+{
+
+}
+
+void EchosounderDetector::SetDeadline(std::chrono::steady_clock::time_point Deadline)
+{
+    deadline_ = Deadline;
+}
+
+std::chrono::steady_clock::time_point EchosounderDetector::Until(int64_t TimeoutMs) const
+{
+    return std::min(deadline_, std::chrono::steady_clock::now() + std::chrono::milliseconds(TimeoutMs));
+}
+
+int EchosounderDetector::WaitToken(uint32_t Mask, std::chrono::steady_clock::time_point Deadline, std::string *Received)
+{
+    response_matcher_.Reset();
+
+    for (;;)
+    {
+        if (rx_begin_ == rx_end_)
+        {
+            rx_begin_ = 0;
+            rx_end_ = 0;
+
+            if (false == transport_->WaitReadable(Deadline))
+            {
+                return -1;
+            }
+
+            rx_end_ = transport_->Read(rx_buffer_.data(), rx_buffer_.size());
+            continue;
+        }
+
+        std::size_t consumed = 0;
+        const int token = response_matcher_.Feed(&rx_buffer_[rx_begin_], rx_end_ - rx_begin_, Mask, consumed);
+
+        if (nullptr != Received)
+        {
+            Received->append(reinterpret_cast<const char *>(&rx_buffer_[rx_begin_]), consumed);
+        }
+
+        rx_begin_ += consumed;
+
+        if (token >= 0)
+        {
+            return token;
+        }
+    }
+}
+
+void EchosounderDetector::DiscardInput()
+{
+    rx_begin_ = 0;
+    rx_end_ = 0;
+
+    while (transport_->Read(rx_buffer_.data(), rx_buffer_.size()) > 0)
+    {
+    }
+}
+
+bool EchosounderDetector::Probe(int64_t BudgetMs)
+{
+    const auto end = Until(BudgetMs);
+    int64_t waitms = DETECT_FIRST_WAIT_MS;
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        // Running unit stops on the first line it receives, idle unit answers an empty line with the prompt
+        transport_->Write("\r", Until(CommandTimeouts::Estimate(1, transport_->GetBaudrate())));
+
+        const auto deadline = std::min(end, std::chrono::steady_clock::now() + std::chrono::milliseconds(waitms));
+
+        if (ResponseMatcher::TokenPrompt == WaitToken(ResponseMatcher::PromptTokens, deadline, nullptr))
+        {
+            return true;
+        }
+
+        waitms = std::min<int64_t>(waitms * 2, DETECT_MAX_WAIT_MS);
+    }
+
+    return false;
+}
+
+int EchosounderDetector::Command(const char *Text, std::string &Response)
+{
+    Response.clear();
+
+    const std::string line = std::string(Text) + '\r';
+    const uint32_t baudrate = transport_->GetBaudrate();
+    int result = -2;
+
+    if (line.size() != transport_->Write(line, Until(CommandTimeouts::Estimate(line.size(), baudrate))))
+    {
+        return result;
+    }
+    const int token = WaitToken(ResponseMatcher::ResponseTokens, Until(CommandTimeouts::Estimate(DETECT_RESPONSE_BYTES, baudrate)), &Response);
+
+    switch (token)
+    {
+        case ResponseMatcher::TokenOk:
+        case ResponseMatcher::TokenOkGo:
+            result = 1;
+            break;
+
+        case ResponseMatcher::TokenInvalidCommand:
+            result = 2;
+            break;
+
+        case ResponseMatcher::TokenInvalidArgument:
+            result = 3;
+            break;
+
+        default:
+            return result;
+    }
+
+    WaitToken(ResponseMatcher::PromptTokens, Until(CommandTimeouts::Estimate(DETECT_PROMPT_BYTES, baudrate)), nullptr);
+
+    return result;
+}
+
+bool EchosounderDetector::Detect(const std::vector<uint32_t> &Baudrates, EchosounderDetectInfo &Info)
+{
+    memset(&Info, 0, sizeof(Info));
+
+    const std::size_t count = std::max<std::size_t>(Baudrates.size(), 1U);
+    const int64_t budget = (count > 1) ? DETECT_SCAN_BUDGET_MS : DETECT_BUDGET_MS;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if ((false == Baudrates.empty()) && (false == transport_->SetBaudrate(Baudrates[i])))
+        {
+            continue;
+        }
+
+        DiscardInput();
+
+        if (false == Probe(budget))
+        {
+            continue;
+        }
+
+        // Prompts caused by the other carriage returns may still be on the way
+        DiscardInput();
+
+        std::string response;
+
+        if (1 != Command("#speed", response))
+        {
+            continue;
+        }
+
+        // Without a list the echosounder answered at the baudrate the transport was opened with
+        Info.baudrate = (false == Baudrates.empty()) ? Baudrates[i] : transport_->GetBaudrate();
+        Info.dual = (1 == Command("#getf", response));
+
+        if (1 == Command("#version", response))
+        {
+            const std::size_t position = response.find("Ver:");
+
+            if (std::string::npos != position)
+            {
+                const std::size_t begin = response.find_first_not_of(' ', position + 4);
+                const std::size_t end = response.find_first_of(" \r\n", begin);
+
+                if (std::string::npos != begin)
+                {
+                    const std::string version = response.substr(begin, end - begin);
+                    strncpy(Info.firmware, version.c_str(), sizeof(Info.firmware) - 1);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
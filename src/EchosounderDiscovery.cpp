@@ -0,0 +1,95 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "EchosounderDiscovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "EchosounderDetector.h"
+#include "serial/serial.h"
+
+EchosounderDiscovery::EchosounderDiscovery(TransportFactory Factory) :
+    factory_(Factory)
+{
+
+}
+
+std::vector<std::string> EchosounderDiscovery::ListPorts()
+{
+    std::vector<std::string> ports;
+
+    for (const auto &port : serial::list_ports())
+    {
+        ports.push_back(port.port);
+    }
+
+    return ports;
+}
+
+std::vector<EchosounderDiscovery::Unit> EchosounderDiscovery::Discover(const std::vector<std::string> &Ports, const std::vector<uint32_t> &Baudrates, std::size_t Threads)
+{
+    std::vector<Unit> units;
+
+    if ((true == Ports.empty()) || (true == Baudrates.empty()))
+    {
+        return units;
+    }
+
+    // Slot per port keeps the result in the order of Ports whichever thread finishes first
+    std::vector<Unit> slots(Ports.size());
+    std::vector<char> found(Ports.size(), 0);
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&]()
+    {
+        for (std::size_t i = next++; i < Ports.size(); i = next++)
+        {
+            try
+            {
+                EchosounderDetector detector(factory_(Ports[i], Baudrates[0]));
+
+                if (false != detector.Detect(Baudrates, slots[i].info))
+                {
+                    slots[i].port = Ports[i];
+                    found[i] = 1;
+                }
+            }
+            catch (...)
+            {
+                // Port which can not be opened is skipped
+            }
+        }
+    };
+
+    const std::size_t count = (0 == Threads) ? Ports.size() : std::min(Threads, Ports.size());
+    std::vector<std::thread> threads;
+
+    try
+    {
+        for (std::size_t i = 1; i < count; i++)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (...)
+    {
+        // Less threads are used if they can not be created
+    }
+
+    worker();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < Ports.size(); i++)
+    {
+        if (0 != found[i])
+        {
+            units.push_back(slots[i]);
+        }
+    }
+
+    return units;
+}
@@ -0,0 +1,311 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "EchosounderReactor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define REACTOR_MAX_EVENTS 64
+
+EchosounderReactor::EchosounderReactor() :
+    epoll_fd_(-1),
+    wake_fd_(-1),
+    stop_(false)
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epoll_fd_ < 0)
+    {
+        throw std::runtime_error(std::string("Can not create epoll: ") + strerror(errno));
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (wake_fd_ < 0)
+    {
+        const int error = errno;
+        close(epoll_fd_);
+        throw std::runtime_error(std::string("Can not create eventfd: ") + strerror(error));
+    }
+
+    // Wakeup descriptor is told from echosounders by the null pointer
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+
+    if (0 != epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event))
+    {
+        const int error = errno;
+        close(wake_fd_);
+        close(epoll_fd_);
+        throw std::runtime_error(std::string("Can not watch eventfd: ") + strerror(error));
+    }
+
+    thread_ = std::thread(&EchosounderReactor::Run, this);
+}
+
+EchosounderReactor::~EchosounderReactor()
+{
+    std::set<Echosounder *> remaining;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        remaining.swap(registered_);
+    }
+
+    Wake();
+    thread_.join();
+
+    for (Echosounder *device : remaining)
+    {
+        device->DetachIO();
+    }
+
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+bool EchosounderReactor::Register(Echosounder &Device, std::size_t BufferSize)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if ((false != stop_) || (registered_.end() != registered_.find(&Device)))
+        {
+            return false;
+        }
+
+        if (false == Device.AttachIO([this]() { Wake(); }, BufferSize))
+        {
+            return false;
+        }
+
+        registered_.insert(&Device);
+        added_.push_back(&Device);
+    }
+
+    Wake();
+
+    return true;
+}
+
+bool EchosounderReactor::Unregister(Echosounder &Device)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (registered_.end() == registered_.find(&Device))
+        {
+            return false;
+        }
+
+        registered_.erase(&Device);
+        removed_.push_back(&Device);
+        Wake();
+
+        // Reactor thread does not touch the echosounder once the request is applied
+        changed_.wait(lock, [this, &Device]() { return removed_.end() == std::find(removed_.begin(), removed_.end(), &Device); });
+    }
+
+    Device.DetachIO();
+
+    return true;
+}
+
+void EchosounderReactor::Wake()
+{
+    const uint64_t one = 1;
+
+    // Counter overflow only means the reactor is already woken up
+    if (write(wake_fd_, &one, sizeof(one)) < 0)
+    {
+    }
+}
+
+void EchosounderReactor::ApplyChanges()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (Echosounder *device : removed_)
+        {
+            auto it = std::find_if(entries_.begin(), entries_.end(), [device](const Entry &item) { return device == item.device; });
+
+            if (entries_.end() != it)
+            {
+                if (false != it->polled)
+                {
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, device->GetFd(), nullptr);
+                }
+
+                entries_.erase(it);
+            }
+            else
+            {
+                // Unregistered before it was served
+                added_.erase(std::remove(added_.begin(), added_.end(), device), added_.end());
+            }
+        }
+
+        for (Echosounder *device : added_)
+        {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.ptr = device;
+
+            // Device which can not be watched is still served on wakeups and deadlines
+            const Entry item = { device, 0 == epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, device->GetFd(), &event), false, false };
+            entries_.push_back(item);
+        }
+
+        removed_.clear();
+        added_.clear();
+    }
+
+    changed_.notify_all();
+}
+
+int EchosounderReactor::GetTimeoutMs() const
+{
+    auto deadline = std::chrono::steady_clock::time_point::max();
+
+    for (const Entry &item : entries_)
+    {
+        deadline = std::min(deadline, item.device->GetIoDeadline());
+    }
+
+    if (std::chrono::steady_clock::time_point::max() == deadline)
+    {
+        return -1;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    if (deadline <= now)
+    {
+        return 0;
+    }
+
+    // Rounded up, so the deadline has passed when epoll_wait() returns
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+}
+
+void EchosounderReactor::Fail(Entry &Item)
+{
+    // Level-triggered hang up would be reported again at once, so the port is not watched any more
+    if (false != Item.polled)
+    {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, Item.device->GetFd(), nullptr);
+        Item.polled = false;
+    }
+
+    Item.failed = true;
+    Item.writing = false;
+    Item.device->FailIO();
+}
+
+void EchosounderReactor::Process(Entry &Item)
+{
+    // Commands queued to a failed port complete at once instead of waiting for their deadline
+    if (false != Item.failed)
+    {
+        Item.device->FailIO();
+        return;
+    }
+
+    try
+    {
+        Item.device->ProcessIO();
+    }
+    catch (...)
+    {
+        // Transport failure, the port is not used any more
+        Fail(Item);
+        return;
+    }
+
+    // Writability is watched only while command bytes are pending, otherwise epoll would report it all the time
+    const bool writing = Item.device->WantsWrite();
+
+    if ((false != Item.polled) && (writing != Item.writing))
+    {
+        epoll_event event = {};
+        event.events = (false != writing) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.ptr = Item.device;
+
+        if (0 == epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, Item.device->GetFd(), &event))
+        {
+            Item.writing = writing;
+        }
+    }
+}
+
+void EchosounderReactor::Run()
+{
+    epoll_event events[REACTOR_MAX_EVENTS];
+
+    for (;;)
+    {
+        ApplyChanges();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (false != stop_)
+            {
+                break;
+            }
+        }
+
+        const int count = epoll_wait(epoll_fd_, events, REACTOR_MAX_EVENTS, GetTimeoutMs());
+        bool woken = false;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (nullptr == events[i].data.ptr)
+            {
+                uint64_t value = 0;
+
+                if (read(wake_fd_, &value, sizeof(value)) < 0)
+                {
+                }
+
+                woken = true;
+                continue;
+            }
+
+            Echosounder *device = static_cast<Echosounder *>(events[i].data.ptr);
+            auto it = std::find_if(entries_.begin(), entries_.end(), [device](const Entry &item) { return device == item.device; });
+
+            if (entries_.end() == it)
+            {
+                continue;
+            }
+
+            // Hang up comes together with EPOLLIN, data still received is taken before the port is dropped
+            Process(*it);
+
+            if ((0 != (events[i].events & (EPOLLHUP | EPOLLERR))) && (false == it->failed))
+            {
+                Fail(*it);
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        // Queued commands are started and expired steps are retried or failed
+        for (Entry &item : entries_)
+        {
+            if ((false != woken) || (item.device->GetIoDeadline() <= now))
+            {
+                Process(item);
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "ITransport.h"
+
+ITransport::~ITransport()
+{
+
+}
+
+bool ITransport::SetBaudrate(uint32_t Baudrate)
+{
+    (void)Baudrate;
+    return false;
+}
+
+uint32_t ITransport::GetBaudrate() const
+{
+    return 0;
+}
+
+std::size_t ITransport::WriteSome(const uint8_t *Data, std::size_t Size)
+{
+    return Write(Data, Size, std::chrono::steady_clock::now());
+}
+
+int ITransport::GetFd() const
+{
+    return -1;
+}
+
+std::size_t ITransport::Write(const std::string &Data, std::chrono::steady_clock::time_point Deadline)
+{
+    return Write(reinterpret_cast<const uint8_t *>(Data.data()), Data.size(), Deadline);
+}
@@ -0,0 +1,189 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "InfoParser.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+namespace
+{
+    const char ActiveMark[] = "(Active)";
+
+    bool IsBlank(char Ch)
+    {
+        return (' ' == Ch) || ('\t' == Ch) || ('\r' == Ch) || ('\n' == Ch);
+    }
+
+    bool IsNumberChar(char Ch)
+    {
+        return ((Ch >= '0') && (Ch <= '9')) || ('.' == Ch) || ('+' == Ch) || ('-' == Ch);
+    }
+
+    bool StartsWith(const char *Begin, const char *End, const char *Prefix)
+    {
+        const std::size_t length = strlen(Prefix);
+
+        return (static_cast<std::size_t>(End - Begin) >= length) && (0 == memcmp(Begin, Prefix, length));
+    }
+
+    const char *SkipBlanks(const char *Begin, const char *End)
+    {
+        while ((Begin < End) && (false != IsBlank(*Begin)))
+        {
+            Begin++;
+        }
+
+        return Begin;
+    }
+
+    const char *TrimBlanks(const char *Begin, const char *End)
+    {
+        while ((End > Begin) && (false != IsBlank(*(End - 1))))
+        {
+            End--;
+        }
+
+        return End;
+    }
+}
+
+InfoParser::InfoParser(const EchosounderCommandTable &CommandList) :
+    has_active_(false),
+    active_id_(IdInfo)
+{
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        const EchosounderCommandIds_t id = static_cast<EchosounderCommandIds_t>(i);
+        const char *name = CommandList.commands[i].info_key;
+
+        if ((nullptr == name) || ('\0' == *name))
+        {
+            continue;
+        }
+
+        if (0 == strcmp(name, ActiveMark))
+        {
+            // " 200000Hz (Active)" line reports the working frequency
+            has_active_ = true;
+            active_id_ = id;
+            continue;
+        }
+
+        Key key;
+        key.id = id;
+        key.name = name;
+        keys_.push_back(key);
+    }
+
+    std::sort(keys_.begin(), keys_.end());
+}
+
+const InfoParser::Key *InfoParser::Find(const char *Name, std::size_t Length) const
+{
+    const auto it = std::lower_bound(keys_.cbegin(), keys_.cend(), Name,
+                                     [Length](const Key &Item, const char *Value)
+    {
+        return Item.name.compare(0, std::string::npos, Value, Length) < 0;
+    });
+
+    if ((it != keys_.cend()) && (0 == it->name.compare(0, std::string::npos, Name, Length)))
+    {
+        return &(*it);
+    }
+
+    return nullptr;
+}
+
+std::size_t InfoParser::Parse(const std::string &Info, SettingsStore &Settings) const
+{
+    // Only the first line for each command is taken
+    std::bitset<IdGetWorkFreq + 1> found;
+    std::size_t count = 0;
+
+    const char *ch = Info.data();
+    const char *infoend = ch + Info.size();
+
+    while (ch < infoend)
+    {
+        const char *lineend = static_cast<const char *>(memchr(ch, '\n', infoend - ch));
+        lineend = (nullptr != lineend) ? lineend : infoend;
+
+        const char *begin = SkipBlanks(ch, lineend);
+        const char *end = TrimBlanks(begin, lineend);
+        ch = lineend + 1;
+
+        const Key *key = nullptr;
+        const char *value = nullptr;
+        const char *valueend = nullptr;
+
+        if (false != StartsWith(begin, end, "- "))
+        {
+            // - #name [ value unit ] description
+            const char *name = begin + 2;
+            const char *nameend = name;
+
+            while ((nameend < end) && (' ' != *nameend) && ('[' != *nameend))
+            {
+                nameend++;
+            }
+
+            const char *open = std::find(nameend, end, '[');
+            const char *close = std::find(open, end, ']');
+
+            if (close == end)
+            {
+                continue;
+            }
+
+            key = Find(name, nameend - name);
+            value = SkipBlanks(open + 1, close);
+            valueend = value;
+
+            while ((valueend < close) && (false == IsBlank(*valueend)))
+            {
+                valueend++;
+            }
+
+            if (std::find_if_not(value, valueend, IsNumberChar) != valueend)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            // Label: value[unit] ["(Active)"]
+            const char *colon = std::find(begin, end, ':');
+
+            if (colon == end)
+            {
+                continue;
+            }
+
+            key = Find(begin, TrimBlanks(begin, colon) - begin);
+            value = SkipBlanks(colon + 1, end);
+            valueend = value;
+
+            while ((valueend < end) && (((*valueend >= '0') && (*valueend <= '9')) || ('.' == *valueend)))
+            {
+                valueend++;
+            }
+
+            if ((false != has_active_) && (false == found[active_id_]) && (valueend > value) &&
+                (std::search(valueend, end, ActiveMark, ActiveMark + sizeof(ActiveMark) - 1) != end))
+            {
+                found[active_id_] = true;
+                Settings.Set(active_id_, value, valueend - value);
+                count++;
+            }
+        }
+
+        if ((nullptr != key) && (valueend > value) && (false == found[key->id]))
+        {
+            found[key->id] = true;
+            Settings.Set(key->id, value, valueend - value);
+            count++;
+        }
+    }
+
+    return count;
+}
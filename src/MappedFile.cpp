@@ -0,0 +1,292 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+    *   Allocate all blocks of the file, so writing into the mapping can not run out of disk space
+    *   (that raises SIGBUS) and a full disk or quota fails here instead
+    */
+    bool Reserve(int Fd, off_t Size)
+    {
+#if defined(__APPLE__)
+        fstore_t store = { F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, Size, 0 };
+
+        if (-1 == fcntl(Fd, F_PREALLOCATE, &store))
+        {
+            store.fst_flags = F_ALLOCATEALL;
+
+            if (-1 == fcntl(Fd, F_PREALLOCATE, &store))
+            {
+                return false;
+            }
+        }
+
+        return 0 == ftruncate(Fd, Size);
+#else
+        return 0 == posix_fallocate(Fd, 0, Size);
+#endif
+    }
+}
+#endif
+
+MappedFile::MappedFile() :
+    data_(nullptr),
+    size_(0),
+    writable_(false),
+#if defined(_WIN32)
+    file_(INVALID_HANDLE_VALUE),
+    mapping_(nullptr)
+#else
+    fd_(-1)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    Close(size_);
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Create(const std::string &Path, std::size_t Size)
+{
+    Close();
+
+    // Readers may open the file while it is written
+    file_ = CreateFileA(Path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (INVALID_HANDLE_VALUE == file_)
+    {
+        return false;
+    }
+
+    const uint64_t size = Size;
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+
+    if (nullptr != mapping_)
+    {
+        data_ = static_cast<uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, Size));
+    }
+
+    if (nullptr == data_)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = Size;
+    writable_ = true;
+
+    return true;
+}
+
+bool MappedFile::Open(const std::string &Path)
+{
+    Close();
+
+    file_ = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (INVALID_HANDLE_VALUE == file_)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if ((FALSE != GetFileSizeEx(file_, &size)) && (size.QuadPart > 0))
+    {
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (nullptr != mapping_)
+        {
+            data_ = static_cast<uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+
+    if (nullptr == data_)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    return true;
+}
+
+void MappedFile::Sync()
+{
+    if ((nullptr != data_) && (false != writable_))
+    {
+        FlushViewOfFile(data_, 0);
+    }
+}
+
+void MappedFile::Close(std::size_t UsedSize)
+{
+    if (nullptr != data_)
+    {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+
+    if (nullptr != mapping_)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+
+    if (INVALID_HANDLE_VALUE != file_)
+    {
+        // Size can only be changed after the mapping is closed
+        if ((false != writable_) && (UsedSize > 0) && (UsedSize < size_))
+        {
+            LARGE_INTEGER position;
+            position.QuadPart = static_cast<LONGLONG>(UsedSize);
+
+            if (FALSE != SetFilePointerEx(file_, position, nullptr, FILE_BEGIN))
+            {
+                SetEndOfFile(file_);
+            }
+        }
+
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+
+    size_ = 0;
+    writable_ = false;
+}
+
+#else
+
+bool MappedFile::Create(const std::string &Path, std::size_t Size)
+{
+    Close();
+
+    fd_ = open(Path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    if (false != Reserve(fd_, static_cast<off_t>(Size)))
+    {
+        void *data = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+        if (MAP_FAILED != data)
+        {
+            data_ = static_cast<uint8_t *>(data);
+        }
+    }
+
+    if (nullptr == data_)
+    {
+        // Partly allocated file is not left behind to be taken for a segment
+        Close();
+        unlink(Path.c_str());
+        return false;
+    }
+
+    size_ = Size;
+    writable_ = true;
+
+    return true;
+}
+
+bool MappedFile::Open(const std::string &Path)
+{
+    Close();
+
+    fd_ = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+
+    if ((0 == fstat(fd_, &status)) && (status.st_size > 0))
+    {
+        void *data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+
+        if (MAP_FAILED != data)
+        {
+            data_ = static_cast<uint8_t *>(data);
+        }
+    }
+
+    if (nullptr == data_)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(status.st_size);
+
+    return true;
+}
+
+void MappedFile::Sync()
+{
+    if ((nullptr != data_) && (false != writable_))
+    {
+        msync(data_, size_, MS_ASYNC);
+    }
+}
+
+void MappedFile::Close(std::size_t UsedSize)
+{
+    if (nullptr != data_)
+    {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+
+    if (fd_ >= 0)
+    {
+        if ((false != writable_) && (UsedSize > 0) && (UsedSize < size_))
+        {
+            if (0 != ftruncate(fd_, static_cast<off_t>(UsedSize)))
+            {
+                // File keeps its full size, readers rely on the size stored in the file
+            }
+        }
+
+        close(fd_);
+        fd_ = -1;
+    }
+
+    size_ = 0;
+    writable_ = false;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const
+{
+    return nullptr != data_;
+}
+
+uint8_t *MappedFile::Data() const
+{
+    return data_;
+}
+
+std::size_t MappedFile::Size() const
+{
+    return size_;
+}
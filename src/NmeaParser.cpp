@@ -0,0 +1,420 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "NmeaParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const std::size_t MaxFields = 24U;
+
+    struct Field
+    {
+        const char *begin;
+        const char *end;
+
+        bool IsEmpty() const
+        {
+            return begin == end;
+        }
+
+        char FirstChar() const
+        {
+            return IsEmpty() ? '\0' : *begin;
+        }
+    };
+
+    int HexValue(uint8_t Ch)
+    {
+        if ((Ch >= '0') && (Ch <= '9'))
+        {
+            return Ch - '0';
+        }
+
+        if ((Ch >= 'A') && (Ch <= 'F'))
+        {
+            return Ch - 'A' + 10;
+        }
+
+        if ((Ch >= 'a') && (Ch <= 'f'))
+        {
+            return Ch - 'a' + 10;
+        }
+
+        return -1;
+    }
+
+    /**
+    *   Locale independent decimal parser, empty field gives NaN
+    */
+    bool ParseFloat(const Field &Value, float &Result)
+    {
+        if (false != Value.IsEmpty())
+        {
+            Result = std::numeric_limits<float>::quiet_NaN();
+            return true;
+        }
+
+        const char *ch = Value.begin;
+        bool negative = false;
+
+        if (('-' == *ch) || ('+' == *ch))
+        {
+            negative = ('-' == *ch);
+            ch++;
+        }
+
+        double integer = 0.0;
+        double fraction = 0.0;
+        double scale = 1.0;
+        bool digits = false;
+
+        while ((ch < Value.end) && (*ch >= '0') && (*ch <= '9'))
+        {
+            integer = integer * 10.0 + (*ch - '0');
+            digits = true;
+            ch++;
+        }
+
+        if ((ch < Value.end) && ('.' == *ch))
+        {
+            ch++;
+
+            while ((ch < Value.end) && (*ch >= '0') && (*ch <= '9'))
+            {
+                fraction = fraction * 10.0 + (*ch - '0');
+                scale *= 10.0;
+                digits = true;
+                ch++;
+            }
+        }
+
+        if ((ch != Value.end) || (false == digits))
+        {
+            return false;
+        }
+
+        const double result = integer + fraction / scale;
+        Result = static_cast<float>(negative ? -result : result);
+
+        return true;
+    }
+
+    bool ParseInteger(const Field &Value, long &Result)
+    {
+        if (false != Value.IsEmpty())
+        {
+            return false;
+        }
+
+        const char *ch = Value.begin;
+        bool negative = false;
+
+        if (('-' == *ch) || ('+' == *ch))
+        {
+            negative = ('-' == *ch);
+            ch++;
+        }
+
+        long result = 0;
+        bool digits = false;
+
+        while ((ch < Value.end) && (*ch >= '0') && (*ch <= '9'))
+        {
+            result = result * 10 + (*ch - '0');
+            digits = true;
+            ch++;
+        }
+
+        Result = negative ? -result : result;
+
+        return (ch == Value.end) && (false != digits);
+    }
+
+    bool ParseTwoDigits(const char *Text, uint8_t &Result)
+    {
+        if ((Text[0] < '0') || (Text[0] > '9') || (Text[1] < '0') || (Text[1] > '9'))
+        {
+            return false;
+        }
+
+        Result = static_cast<uint8_t>((Text[0] - '0') * 10 + (Text[1] - '0'));
+        return true;
+    }
+
+    bool IsType(const Field &Address, const char *Type)
+    {
+        return (5 == (Address.end - Address.begin)) && (0 == memcmp(Address.begin + 2, Type, 3));
+    }
+}
+
+const std::size_t NmeaParser::MaxBodySize;
+
+NmeaParser::NmeaParser() :
+    state_(StateIdle),
+    body_size_(0),
+    checksum_(0),
+    received_checksum_(0),
+    sentences_(0),
+    checksum_errors_(0),
+    malformed_(0),
+    unsupported_(0)
+{
+    memset(&record_, 0, sizeof(record_));
+}
+
+void NmeaParser::Reset()
+{
+    state_ = StateIdle;
+    body_size_ = 0;
+}
+
+const EchosounderNmeaRecord &NmeaParser::GetRecord() const
+{
+    return record_;
+}
+
+void NmeaParser::GetStatistics(EchosounderNmeaStatistics &Statistics) const
+{
+    Statistics.sentences = sentences_.load(std::memory_order_relaxed);
+    Statistics.checksum_errors = checksum_errors_.load(std::memory_order_relaxed);
+    Statistics.malformed = malformed_.load(std::memory_order_relaxed);
+    Statistics.unsupported = unsupported_.load(std::memory_order_relaxed);
+    Statistics.dropped = 0;
+}
+
+std::size_t NmeaParser::Feed(const uint8_t *Data, std::size_t Size, bool &Complete)
+{
+    Complete = false;
+
+    for (std::size_t i = 0; i < Size; i++)
+    {
+        const uint8_t ch = Data[i];
+
+        if ('$' == ch)
+        {
+            // Start of sentence always restarts, a truncated sentence is dropped
+            if (StateIdle != state_)
+            {
+                malformed_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            state_ = StateBody;
+            body_size_ = 0;
+            checksum_ = 0;
+            continue;
+        }
+
+        switch (state_)
+        {
+            case StateIdle:
+                break;
+
+            case StateBody:
+                if ('*' == ch)
+                {
+                    state_ = StateChecksumHigh;
+                }
+                else if (('\r' == ch) || ('\n' == ch) || (body_size_ >= MaxBodySize))
+                {
+                    malformed_.fetch_add(1, std::memory_order_relaxed);
+                    state_ = StateIdle;
+                }
+                else
+                {
+                    body_[body_size_++] = static_cast<char>(ch);
+                    checksum_ ^= ch;
+                }
+                break;
+
+            case StateChecksumHigh:
+                if (HexValue(ch) < 0)
+                {
+                    malformed_.fetch_add(1, std::memory_order_relaxed);
+                    state_ = StateIdle;
+                }
+                else
+                {
+                    received_checksum_ = static_cast<uint8_t>(HexValue(ch) << 4);
+                    state_ = StateChecksumLow;
+                }
+                break;
+
+            case StateChecksumLow:
+                state_ = StateIdle;
+
+                if (HexValue(ch) < 0)
+                {
+                    malformed_.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if ((received_checksum_ | HexValue(ch)) != checksum_)
+                {
+                    checksum_errors_.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    body_[body_size_] = '\0';
+                    const int result = ParseBody();
+
+                    if (1 == result)
+                    {
+                        sentences_.fetch_add(1, std::memory_order_relaxed);
+                        Complete = true;
+                        return i + 1;
+                    }
+                    else if (0 == result)
+                    {
+                        unsupported_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        malformed_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                break;
+        }
+    }
+
+    return Size;
+}
+
+int NmeaParser::ParseBody()
+{
+    Field fields[MaxFields];
+    std::size_t count = 0;
+
+    const char *begin = body_;
+    const char *end = body_ + body_size_;
+
+    for (const char *ch = body_; ch <= end; ch++)
+    {
+        if ((ch == end) || (',' == *ch))
+        {
+            if (count == MaxFields)
+            {
+                return -1;
+            }
+
+            fields[count].begin = begin;
+            fields[count].end = ch;
+            count++;
+            begin = ch + 1;
+        }
+    }
+
+    const Field &address = fields[0];
+
+    // Only "ttsss" addresses, proprietary "P..." sentences are not supported
+    if ((5 != (address.end - address.begin)) || ('P' == address.FirstChar()))
+    {
+        return 0;
+    }
+
+    memset(&record_, 0, sizeof(record_));
+    record_.talker[0] = address.begin[0];
+    record_.talker[1] = address.begin[1];
+
+    bool valid = true;
+
+    if (false != IsType(address, "DBT"))
+    {
+        // $--DBT,x.x,f,x.x,M,x.x,F
+        record_.sentence = NmeaDBT;
+        valid = (count >= 7) &&
+                ParseFloat(fields[1], record_.data.dbt.depth_ft) &&
+                ParseFloat(fields[3], record_.data.dbt.depth_m) &&
+                ParseFloat(fields[5], record_.data.dbt.depth_fathoms);
+    }
+    else if (false != IsType(address, "DPT"))
+    {
+        // $--DPT,x.x,x.x[,x.x]
+        record_.sentence = NmeaDPT;
+        record_.data.dpt.max_range_m = std::numeric_limits<float>::quiet_NaN();
+        valid = (count >= 3) &&
+                ParseFloat(fields[1], record_.data.dpt.depth_m) &&
+                ParseFloat(fields[2], record_.data.dpt.offset_m) &&
+                ((count < 4) || ParseFloat(fields[3], record_.data.dpt.max_range_m));
+    }
+    else if (false != IsType(address, "MTW"))
+    {
+        // $--MTW,x.x,C
+        record_.sentence = NmeaMTW;
+        valid = (count >= 2) && ParseFloat(fields[1], record_.data.mtw.temperature_c);
+    }
+    else if (false != IsType(address, "XDR"))
+    {
+        // $--XDR,a,x.x,a,c--c[,a,x.x,a,c--c...]
+        record_.sentence = NmeaXDR;
+
+        for (std::size_t i = 1; ((i + 3) < count) && (record_.data.xdr.count < static_cast<int>(NMEA_XDR_MAX_MEASUREMENTS)); i += 4)
+        {
+            EchosounderNmeaXDRMeasurement &measurement = record_.data.xdr.measurements[record_.data.xdr.count];
+            const std::size_t namelength = std::min(static_cast<std::size_t>(fields[i + 3].end - fields[i + 3].begin), static_cast<std::size_t>(NMEA_XDR_NAME_SIZE - 1));
+
+            measurement.type = fields[i].FirstChar();
+            measurement.unit = fields[i + 2].FirstChar();
+            memcpy(measurement.name, fields[i + 3].begin, namelength);
+            measurement.name[namelength] = '\0';
+
+            valid = valid && ParseFloat(fields[i + 1], measurement.value);
+            record_.data.xdr.count++;
+        }
+
+        valid = valid && (record_.data.xdr.count > 0);
+    }
+    else if (false != IsType(address, "EMA"))
+    {
+        // $--EMA,x.x[,x.x...]
+        record_.sentence = NmeaEMA;
+
+        for (std::size_t i = 1; (i < count) && (record_.data.ema.count < static_cast<int>(NMEA_EMA_MAX_VALUES)); i++)
+        {
+            valid = valid && ParseFloat(fields[i], record_.data.ema.values[record_.data.ema.count]);
+            record_.data.ema.count++;
+        }
+    }
+    else if (false != IsType(address, "ZDA"))
+    {
+        // $--ZDA,hhmmss.ss,xx,xx,xxxx,xx,xx
+        record_.sentence = NmeaZDA;
+        EchosounderNmeaZDA &zda = record_.data.zda;
+        long value = 0;
+
+        valid = (count >= 5) && ((fields[1].end - fields[1].begin) >= 6) &&
+                ParseTwoDigits(fields[1].begin, zda.hour) &&
+                ParseTwoDigits(fields[1].begin + 2, zda.minute) &&
+                ParseTwoDigits(fields[1].begin + 4, zda.second);
+
+        if (false != valid)
+        {
+            float seconds = 0.0F;
+            Field fraction = { fields[1].begin + 6, fields[1].end };
+
+            if (false == fraction.IsEmpty())
+            {
+                valid = ('.' == *fraction.begin) && ParseFloat(fraction, seconds);
+                zda.microsecond = static_cast<uint32_t>(seconds * 1e6F + 0.5F);
+            }
+        }
+
+        valid = valid && ParseInteger(fields[2], value);
+        zda.day = static_cast<uint8_t>(value);
+        valid = valid && ParseInteger(fields[3], value);
+        zda.month = static_cast<uint8_t>(value);
+        valid = valid && ParseInteger(fields[4], value);
+        zda.year = static_cast<uint16_t>(value);
+
+        if ((false != valid) && (count >= 7))
+        {
+            zda.zone_hours = static_cast<int8_t>(ParseInteger(fields[5], value) ? value : 0);
+            zda.zone_minutes = static_cast<int8_t>(ParseInteger(fields[6], value) ? value : 0);
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    return (false != valid) ? 1 : -1;
+}
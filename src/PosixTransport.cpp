@@ -0,0 +1,291 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "PosixTransport.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    speed_t BaudrateToSpeed(uint32_t Baudrate)
+    {
+        switch (Baudrate)
+        {
+            case 1200:    return B1200;
+            case 2400:    return B2400;
+            case 4800:    return B4800;
+            case 9600:    return B9600;
+            case 19200:   return B19200;
+            case 38400:   return B38400;
+            case 57600:   return B57600;
+            case 115200:  return B115200;
+            case 230400:  return B230400;
+#if defined(B460800)
+            case 460800:  return B460800;
+#endif
+#if defined(B921600)
+            case 921600:  return B921600;
+#endif
+            default:
+                throw std::invalid_argument("Unsupported baudrate " + std::to_string(Baudrate));
+        }
+    }
+
+    int MillisecondsUntil(std::chrono::steady_clock::time_point Deadline)
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now >= Deadline)
+        {
+            return 0;
+        }
+
+        // Round up, so poll() never returns just before the deadline
+        const auto left = std::chrono::duration_cast<std::chrono::microseconds>(Deadline - now).count();
+        return static_cast<int>((left + 999) / 1000);
+    }
+}
+
+PosixTransport::PosixTransport(const std::string &PortPath, uint32_t Baudrate) :
+    fd_(-1),
+    baudrate_(Baudrate)
+{
+    const speed_t speed = BaudrateToSpeed(Baudrate);
+
+    if (0 != pipe(interrupt_fds_))
+    {
+        throw std::runtime_error(std::string("Can not create pipe: ") + strerror(errno));
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(interrupt_fds_[i], F_SETFL, fcntl(interrupt_fds_[i], F_GETFL) | O_NONBLOCK);
+        fcntl(interrupt_fds_[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    fd_ = ::open(PortPath.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd_ < 0)
+    {
+        const int error = errno;
+        ClosePipe();
+        throw std::runtime_error("Can not open " + PortPath + ": " + strerror(error));
+    }
+
+    struct termios options;
+
+    if (0 != tcgetattr(fd_, &options))
+    {
+        const int error = errno;
+        ::close(fd_);
+        ClosePipe();
+        throw std::runtime_error("Can not get attributes of " + PortPath + ": " + strerror(error));
+    }
+
+    cfmakeraw(&options);
+    options.c_cflag |= (CLOCAL | CREAD);
+    options.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    options.c_iflag &= ~(IXON | IXOFF | IXANY);
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 0;
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+
+    if (0 != tcsetattr(fd_, TCSANOW, &options))
+    {
+        const int error = errno;
+        ::close(fd_);
+        ClosePipe();
+        throw std::runtime_error("Can not configure " + PortPath + ": " + strerror(error));
+    }
+
+    tcflush(fd_, TCIOFLUSH);
+}
+
+PosixTransport::~PosixTransport()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+
+    ClosePipe();
+}
+
+void PosixTransport::ClosePipe()
+{
+    ::close(interrupt_fds_[0]);
+    ::close(interrupt_fds_[1]);
+}
+
+int PosixTransport::GetFd() const
+{
+    return fd_;
+}
+
+std::size_t PosixTransport::Read(uint8_t *Buffer, std::size_t Size)
+{
+    for (;;)
+    {
+        const ssize_t br = ::read(fd_, Buffer, Size);
+
+        if (br >= 0)
+        {
+            return static_cast<std::size_t>(br);
+        }
+
+        if (EINTR != errno)
+        {
+            return 0;
+        }
+    }
+}
+
+std::size_t PosixTransport::Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline)
+{
+    std::size_t written = 0;
+
+    while (written < Size)
+    {
+        const ssize_t bw = ::write(fd_, Data + written, Size - written);
+
+        if (bw > 0)
+        {
+            written += static_cast<std::size_t>(bw);
+        }
+        else if ((bw < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+        {
+            // Port stalled (flow control, hung adapter), give up at the deadline
+            struct pollfd pfd = { fd_, POLLOUT, 0 };
+
+            if ((0 == poll(&pfd, 1, MillisecondsUntil(Deadline))) && (std::chrono::steady_clock::now() >= Deadline))
+            {
+                break;
+            }
+        }
+        else if ((bw < 0) && (EINTR == errno))
+        {
+            // retry
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return written;
+}
+
+std::size_t PosixTransport::WriteSome(const uint8_t *Data, std::size_t Size)
+{
+    for (;;)
+    {
+        const ssize_t bw = ::write(fd_, Data, Size);
+
+        if (bw >= 0)
+        {
+            return static_cast<std::size_t>(bw);
+        }
+
+        if ((EAGAIN == errno) || (EWOULDBLOCK == errno))
+        {
+            return 0;
+        }
+
+        if (EINTR != errno)
+        {
+            throw std::runtime_error(std::string("Can not write to port: ") + strerror(errno));
+        }
+    }
+}
+
+bool PosixTransport::WaitReadable(std::chrono::steady_clock::time_point Deadline)
+{
+    for (;;)
+    {
+        struct pollfd pfds[2] = { { fd_, POLLIN, 0 }, { interrupt_fds_[0], POLLIN, 0 } };
+        const int result = poll(pfds, 2, MillisecondsUntil(Deadline));
+
+        if (result > 0)
+        {
+            // Interrupted, or hang up or error on the port without data, nothing to wait for
+            return (0 == pfds[1].revents) && (0 != (pfds[0].revents & POLLIN));
+        }
+
+        if ((0 == result) && (std::chrono::steady_clock::now() >= Deadline))
+        {
+            return false;
+        }
+
+        if ((result < 0) && (EINTR != errno))
+        {
+            return false;
+        }
+    }
+}
+
+void PosixTransport::SetInterrupted(bool Interrupted)
+{
+    if (false != Interrupted)
+    {
+        const uint8_t wakeup = 1;
+        (void)::write(interrupt_fds_[1], &wakeup, 1);
+    }
+    else
+    {
+        uint8_t drain[16];
+        while (::read(interrupt_fds_[0], drain, sizeof(drain)) > 0)
+        {
+        }
+    }
+}
+
+void PosixTransport::Flush()
+{
+    tcdrain(fd_);
+}
+
+bool PosixTransport::SetBaudrate(uint32_t Baudrate)
+{
+    struct termios options;
+    speed_t speed = B0;
+
+    try
+    {
+        speed = BaudrateToSpeed(Baudrate);
+    }
+    catch (const std::invalid_argument &)
+    {
+        return false;
+    }
+
+    if (0 != tcgetattr(fd_, &options))
+    {
+        return false;
+    }
+
+    tcdrain(fd_);
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+
+    if (0 != tcsetattr(fd_, TCSANOW, &options))
+    {
+        return false;
+    }
+
+    // Bytes received at the previous speed are garbage
+    tcflush(fd_, TCIFLUSH);
+    baudrate_ = Baudrate;
+
+    return true;
+}
+
+uint32_t PosixTransport::GetBaudrate() const
+{
+    return baudrate_;
+}
@@ -0,0 +1,236 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "RecordingReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+RecordingReader::RecordingReader() :
+    segment_(0),
+    offset_(0),
+    settings_(nullptr)
+{
+
+}
+
+bool RecordingReader::Open(const std::string &Path)
+{
+    Close();
+
+    for (uint32_t number = 0; ; number++)
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+
+        if ((false == file->Open(RecordingSegmentPath(Path, number))) || (false == IsValid(*file)))
+        {
+            break;
+        }
+
+        Segment item;
+        item.header = reinterpret_cast<const RecordingSegmentHeader *>(file->Data());
+        item.index = reinterpret_cast<const RecordingIndexEntry *>(file->Data() + item.header->index_offset);
+        item.data = file->Data() + item.header->data_offset;
+        item.file = std::move(file);
+
+        segments_.push_back(std::move(item));
+    }
+
+    return false == segments_.empty();
+}
+
+void RecordingReader::Close()
+{
+    segments_.clear();
+    segment_ = 0;
+    offset_ = 0;
+    settings_ = nullptr;
+}
+
+bool RecordingReader::IsValid(const MappedFile &File)
+{
+    if (File.Size() < RECORDING_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    const RecordingSegmentHeader *header = reinterpret_cast<const RecordingSegmentHeader *>(File.Data());
+
+    // Records are stored as they are in memory, so only the same layout can be read
+    return (0 == memcmp(header->magic, RECORDING_MAGIC, sizeof(header->magic))) &&
+           (RECORDING_VERSION == header->version) &&
+           (sizeof(EchosounderNmeaRecord) == header->record_size) &&
+           (header->index_offset >= RECORDING_HEADER_SIZE) &&
+           ((header->index_offset + header->index_capacity * sizeof(RecordingIndexEntry)) <= header->data_offset) &&
+           (header->data_offset <= File.Size());
+}
+
+const RecordingEntryHeader *RecordingReader::EntryAt(const Segment &Item, uint64_t Offset) const
+{
+    const uint64_t datasize = Item.header->data_size;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const uint64_t limit = std::min<uint64_t>(datasize, Item.file->Size() - Item.header->data_offset);
+
+    if ((Offset + sizeof(RecordingEntryHeader)) > limit)
+    {
+        return nullptr;
+    }
+
+    const RecordingEntryHeader *entry = reinterpret_cast<const RecordingEntryHeader *>(Item.data + Offset);
+
+    return ((Offset + RecordingEntrySize(entry->size)) <= limit) ? entry : nullptr;
+}
+
+bool RecordingReader::GetTimeRange(int64_t &BeginUs, int64_t &EndUs) const
+{
+    if ((true == segments_.empty()) || (0 == segments_.front().header->begin_time_us))
+    {
+        return false;
+    }
+
+    BeginUs = segments_.front().header->begin_time_us;
+    EndUs = BeginUs;
+
+    for (const auto &item : segments_)
+    {
+        if (0 != item.header->begin_time_us)
+        {
+            EndUs = item.header->end_time_us;
+        }
+    }
+
+    return true;
+}
+
+int64_t RecordingReader::GetUtcOffset() const
+{
+    return (false == segments_.empty()) ? segments_.front().header->utc_offset_us : 0;
+}
+
+bool RecordingReader::Seek(int64_t TimeUs)
+{
+    segment_ = 0;
+    offset_ = 0;
+    settings_ = nullptr;
+
+    // Last segment starting at or before TimeUs, only the last segment may be still empty
+    std::size_t count = segments_.size();
+
+    if ((count > 0) && (0 == segments_[count - 1].header->begin_time_us))
+    {
+        count--;
+    }
+
+    const auto segment = std::upper_bound(segments_.begin(), segments_.begin() + count, TimeUs,
+        [](int64_t Time, const Segment &Item) { return Time < Item.header->begin_time_us; });
+
+    segment_ = (segments_.begin() != segment) ? static_cast<std::size_t>(segment - segments_.begin()) - 1 : 0;
+
+    if (segment_ < count)
+    {
+        // Last index entry at or before TimeUs
+        const Segment &item = segments_[segment_];
+        const uint64_t indexcount = item.header->index_count;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        const RecordingIndexEntry *index = std::upper_bound(item.index, item.index + indexcount, TimeUs,
+            [](int64_t Time, const RecordingIndexEntry &Entry) { return Time < Entry.time_us; });
+
+        if (item.index != index)
+        {
+            const RecordingEntryHeader *settings = EntryAt(item, (index - 1)->settings_offset);
+
+            offset_ = (index - 1)->offset;
+            settings_ = ((nullptr != settings) && (RecordingSettings == settings->type)) ? settings : nullptr;
+        }
+    }
+
+    // Scan forward from the index entry to the first entry at or after TimeUs
+    while (true)
+    {
+        const std::size_t segment = segment_;
+        const uint64_t offset = offset_;
+        const RecordingEntryHeader *settings = settings_;
+        EchosounderRecordingEntry entry;
+
+        if (false == Read(entry))
+        {
+            return false;
+        }
+
+        if (entry.time_us >= TimeUs)
+        {
+            segment_ = segment;
+            offset_ = offset;
+            settings_ = settings;
+
+            return true;
+        }
+    }
+}
+
+bool RecordingReader::Read(EchosounderRecordingEntry &Entry)
+{
+    while (segment_ < segments_.size())
+    {
+        const RecordingEntryHeader *entry = EntryAt(segments_[segment_], offset_);
+
+        if (nullptr != entry)
+        {
+            Entry.type = static_cast<EchosounderRecordingEntryType>(entry->type);
+            Entry.time_us = entry->time_us;
+            Entry.data = reinterpret_cast<const uint8_t *>(entry + 1);
+            Entry.size = entry->size;
+
+            if (RecordingSettings == entry->type)
+            {
+                settings_ = entry;
+            }
+
+            offset_ += RecordingEntrySize(entry->size);
+
+            return true;
+        }
+
+        // The last segment may still grow
+        if ((segment_ + 1) >= segments_.size())
+        {
+            break;
+        }
+
+        segment_++;
+        offset_ = 0;
+    }
+
+    return false;
+}
+
+bool RecordingReader::GetValue(EchosounderCommandIds Command, std::string &Value) const
+{
+    if (nullptr == settings_)
+    {
+        return false;
+    }
+
+    // Lines of "<id> <command> <value>\n"
+    const char *text = reinterpret_cast<const char *>(settings_ + 1);
+    const char *end = text + settings_->size;
+
+    while (text < end)
+    {
+        const char *lineend = std::find(text, end, '\n');
+        const char *command = std::find(text, lineend, ' ');
+        const char *value = std::find((command < lineend) ? command + 1 : lineend, lineend, ' ');
+
+        if ((value < lineend) && (static_cast<long>(Command) == strtol(std::string(text, command).c_str(), nullptr, 10)))
+        {
+            Value.assign(value + 1, lineend);
+            return true;
+        }
+
+        text = (lineend < end) ? lineend + 1 : end;
+    }
+
+    return false;
+}
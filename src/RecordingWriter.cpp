@@ -0,0 +1,314 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "RecordingWriter.h"
+#include "ClockModel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#define RECORDING_BUFFER_SIZE (1U << 20)
+#define RECORDING_SEGMENT_SIZE (64U << 20)
+#define RECORDING_SEGMENT_MIN (1U << 20)
+#define RECORDING_INDEX_RATIO 1024U
+#define RECORDING_INDEX_INTERVAL_US 100000LL
+#define RECORDING_POLL_MS 10
+
+RecordingWriter::RecordingWriter(std::size_t BufferSize) :
+    ring_((0 != BufferSize) ? BufferSize : RECORDING_BUFFER_SIZE),
+    segment_size_(RECORDING_SEGMENT_SIZE),
+    utc_offset_us_(0),
+    stop_(false),
+    settings_changed_(false),
+    failed_(false),
+    entries_(0),
+    bytes_(0),
+    dropped_(0),
+    segments_(0),
+    header_(nullptr),
+    index_(nullptr),
+    data_(nullptr),
+    settings_offset_(0),
+    next_index_us_(0)
+{
+
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    Close();
+}
+
+bool RecordingWriter::Open(const std::string &Path, std::size_t SegmentSize, SettingsSource Settings)
+{
+    if ((false != thread_.joinable()) || (nullptr != header_))
+    {
+        return false;
+    }
+
+    path_ = Path;
+    segment_size_ = (0 != SegmentSize) ? std::max<std::size_t>(SegmentSize, RECORDING_SEGMENT_MIN) : RECORDING_SEGMENT_SIZE;
+    settings_ = Settings;
+
+    // Entry times follow the monotonic clock, shifted once so they read as UTC
+    const int64_t utcus = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    utc_offset_us_ = utcus - ClockModel::MonotonicUs();
+
+    failed_.store(false);
+
+    if (false == OpenSegment(0))
+    {
+        return false;
+    }
+
+    stop_ = false;
+    thread_ = std::thread(&RecordingWriter::WriterThread, this);
+
+    return true;
+}
+
+void RecordingWriter::Close()
+{
+    if (false != thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    CloseSegment();
+}
+
+bool RecordingWriter::Append(EchosounderRecordingEntryType Type, int64_t TimeUs, const void *Data, std::size_t Size)
+{
+    const RecordingEntryHeader entry = { static_cast<uint32_t>(Size), static_cast<uint32_t>(Type), TimeUs };
+
+    // Entry is written whole or not at all, so the writer thread never sees a partial one
+    if ((false != failed_.load(std::memory_order_relaxed)) ||
+        ((ring_.Capacity() - ring_.Size()) < (sizeof(entry) + Size)))
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring_.Write(reinterpret_cast<const uint8_t *>(&entry), sizeof(entry));
+    ring_.Write(static_cast<const uint8_t *>(Data), Size);
+
+    return true;
+}
+
+void RecordingWriter::SettingsChanged()
+{
+    settings_changed_.store(true);
+}
+
+void RecordingWriter::GetStatistics(EchosounderRecordingStatistics &Statistics) const
+{
+    Statistics.entries = entries_.load();
+    Statistics.bytes = bytes_.load();
+    Statistics.dropped = dropped_.load();
+    Statistics.segments = segments_.load();
+    Statistics.failed = (false != failed_.load()) ? 1U : 0U;
+}
+
+bool RecordingWriter::OpenSegment(uint32_t Segment)
+{
+    if (false == file_.Create(RecordingSegmentPath(path_, Segment), segment_size_))
+    {
+        failed_.store(true);
+        return false;
+    }
+
+    const uint64_t indexcapacity = segment_size_ / RECORDING_INDEX_RATIO;
+
+    // New file reads as zeros, only non-zero fields are set
+    header_ = reinterpret_cast<RecordingSegmentHeader *>(file_.Data());
+    memcpy(header_->magic, RECORDING_MAGIC, sizeof(header_->magic));
+    header_->version = RECORDING_VERSION;
+    header_->segment = Segment;
+    header_->record_size = sizeof(EchosounderNmeaRecord);
+    header_->index_offset = RECORDING_HEADER_SIZE;
+    header_->index_capacity = indexcapacity;
+    header_->data_offset = RECORDING_HEADER_SIZE + indexcapacity * sizeof(RecordingIndexEntry);
+    header_->data_capacity = segment_size_ - header_->data_offset;
+    header_->utc_offset_us = utc_offset_us_;
+
+    index_ = reinterpret_cast<RecordingIndexEntry *>(file_.Data() + header_->index_offset);
+    data_ = file_.Data() + header_->data_offset;
+    settings_offset_ = 0;
+    next_index_us_ = std::numeric_limits<int64_t>::min();
+
+    segments_.fetch_add(1);
+    bytes_.fetch_add(header_->data_offset);
+
+    return true;
+}
+
+void RecordingWriter::CloseSegment()
+{
+    if (nullptr == header_)
+    {
+        return;
+    }
+
+    header_->closed = 1;
+
+    const std::size_t used = static_cast<std::size_t>(header_->data_offset + header_->data_size);
+
+    file_.Sync();
+    file_.Close(used);
+
+    header_ = nullptr;
+    index_ = nullptr;
+    data_ = nullptr;
+}
+
+bool RecordingWriter::Fits(std::size_t PayloadSize) const
+{
+    return (header_->data_size + RecordingEntrySize(PayloadSize)) <= header_->data_capacity;
+}
+
+void RecordingWriter::WriteEntry(uint32_t Type, int64_t TimeUs, const uint8_t *Payload, std::size_t Size)
+{
+    const uint64_t offset = header_->data_size;
+    const RecordingEntryHeader entry = { static_cast<uint32_t>(Size), Type, TimeUs };
+
+    memcpy(data_ + offset, &entry, sizeof(entry));
+
+    // Payload of queued entries goes from the ring straight into the mapping
+    if (nullptr != Payload)
+    {
+        memcpy(data_ + offset + sizeof(entry), Payload, Size);
+    }
+    else
+    {
+        ring_.Read(data_ + offset + sizeof(entry), Size);
+    }
+
+    if (RecordingSettings == Type)
+    {
+        settings_offset_ = offset;
+    }
+
+    const bool indexed = (TimeUs >= next_index_us_) && (header_->index_count < header_->index_capacity);
+
+    if (false != indexed)
+    {
+        const RecordingIndexEntry item = { TimeUs, offset, settings_offset_, 0 };
+        index_[header_->index_count] = item;
+        next_index_us_ = TimeUs + RECORDING_INDEX_INTERVAL_US;
+    }
+
+    if (0 == header_->begin_time_us)
+    {
+        header_->begin_time_us = TimeUs;
+    }
+
+    header_->end_time_us = TimeUs;
+
+    // Readers trust data_size and index_count, they are updated only after the entry is complete
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->data_size = offset + RecordingEntrySize(Size);
+
+    if (false != indexed)
+    {
+        header_->index_count++;
+    }
+
+    entries_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(RecordingEntrySize(Size), std::memory_order_relaxed);
+}
+
+void RecordingWriter::WriteSettings(int64_t TimeUs, const std::string &Text)
+{
+    WriteEntry(RecordingSettings, TimeUs, reinterpret_cast<const uint8_t *>(Text.data()), Text.size());
+}
+
+bool RecordingWriter::WriteNext()
+{
+    DataView view;
+    RecordingEntryHeader entry;
+    const std::size_t available = ring_.Peek(view);
+
+    if (available < sizeof(entry))
+    {
+        return false;
+    }
+
+    const std::size_t first = std::min(view.first_size, sizeof(entry));
+    memcpy(&entry, view.first, first);
+
+    if (first < sizeof(entry))
+    {
+        memcpy(reinterpret_cast<uint8_t *>(&entry) + first, view.second, sizeof(entry) - first);
+    }
+
+    // Producer has not finished writing the payload yet
+    if (available < (sizeof(entry) + entry.size))
+    {
+        return false;
+    }
+
+    ring_.Consume(sizeof(entry));
+
+    const int64_t time = entry.time_us + utc_offset_us_;
+    std::string settings = ((false != settings_changed_.exchange(false)) && (settings_)) ? settings_() : std::string();
+    const std::size_t needed = entry.size + RecordingEntrySize(settings.size());
+    const bool indexfull = (nullptr != header_) && (time >= next_index_us_) && (header_->index_count == header_->index_capacity);
+
+    if ((nullptr != header_) && ((false == Fits(needed)) || (false != indexfull)))
+    {
+        const uint32_t segment = header_->segment + 1;
+
+        CloseSegment();
+        OpenSegment(segment);
+    }
+
+    if ((nullptr == header_) || (false == Fits(needed)))
+    {
+        // Recording failed or the entry does not fit into an empty segment
+        ring_.Consume(entry.size);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // Every segment starts with settings, so it can be read on its own
+    if ((0 == header_->data_size) && (false != settings.empty()) && (settings_))
+    {
+        settings = settings_();
+    }
+
+    if ((0 == header_->data_size) || (false == settings.empty()))
+    {
+        WriteSettings(time, settings);
+    }
+
+    WriteEntry(entry.type, time, nullptr, entry.size);
+
+    return true;
+}
+
+void RecordingWriter::WriterThread()
+{
+    bool stop = false;
+
+    while (false == stop)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(RECORDING_POLL_MS), [this] { return stop_; });
+            stop = stop_;
+        }
+
+        // Entries queued before Close() are written before the thread ends
+        while (false != WriteNext())
+        {
+
+        }
+    }
+}
@@ -0,0 +1,180 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "ReplayTransport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+ReplayTransport::ReplayTransport(const std::string &Path, double Speed) :
+    speed_(Speed),
+    interrupted_(false),
+    entry_(),
+    entry_read_(0),
+    bytes_(0),
+    playing_(false),
+    origin_us_(0)
+{
+    if (false == reader_.Open(Path))
+    {
+        throw std::runtime_error("Can not open recording " + Path);
+    }
+
+    NextEntry();
+}
+
+ReplayTransport::~ReplayTransport()
+{
+
+}
+
+void ReplayTransport::NextEntry()
+{
+    entry_read_ = 0;
+
+    while (false != reader_.Read(entry_))
+    {
+        if ((RecordingData == entry_.type) && (entry_.size > 0))
+        {
+            return;
+        }
+    }
+
+    entry_.data = nullptr;
+    entry_.size = 0;
+}
+
+std::chrono::steady_clock::time_point ReplayTransport::DueTime() const
+{
+    if ((nullptr == entry_.data) || (false == playing_))
+    {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    if (speed_ <= 0.0)
+    {
+        return std::chrono::steady_clock::time_point::min();
+    }
+
+    const int64_t delay = static_cast<int64_t>(static_cast<double>(entry_.time_us - origin_us_) / speed_);
+
+    return origin_ + std::chrono::microseconds(delay);
+}
+
+std::size_t ReplayTransport::Read(uint8_t *Buffer, std::size_t Size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::size_t count = 0;
+
+    // Everything due is returned, as a port returns all bytes received so far
+    while ((count < Size) && (nullptr != entry_.data) && (std::chrono::steady_clock::now() >= DueTime()))
+    {
+        const std::size_t chunk = std::min(Size - count, entry_.size - entry_read_);
+
+        memcpy(Buffer + count, entry_.data + entry_read_, chunk);
+        entry_read_ += chunk;
+        count += chunk;
+
+        if (entry_read_ == entry_.size)
+        {
+            NextEntry();
+        }
+    }
+
+    bytes_ += count;
+
+    return count;
+}
+
+std::size_t ReplayTransport::Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline)
+{
+    (void)Data;
+    (void)Deadline;
+
+    return Size;
+}
+
+bool ReplayTransport::WaitReadable(std::chrono::steady_clock::time_point Deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (false == interrupted_)
+    {
+        const auto due = DueTime();
+
+        if (std::chrono::steady_clock::now() >= due)
+        {
+            return true;
+        }
+
+        if (std::chrono::steady_clock::now() >= Deadline)
+        {
+            return false;
+        }
+
+        changed_.wait_until(lock, std::min(due, Deadline));
+    }
+
+    return false;
+}
+
+void ReplayTransport::SetInterrupted(bool Interrupted)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interrupted_ = Interrupted;
+    }
+
+    changed_.notify_all();
+}
+
+void ReplayTransport::Flush()
+{
+
+}
+
+void ReplayTransport::Play()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        playing_ = true;
+        origin_ = std::chrono::steady_clock::now();
+        origin_us_ = entry_.time_us;
+    }
+
+    changed_.notify_all();
+}
+
+bool ReplayTransport::Seek(int64_t TimeUs)
+{
+    bool result = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        result = reader_.Seek(TimeUs);
+        NextEntry();
+        origin_ = std::chrono::steady_clock::now();
+        origin_us_ = entry_.time_us;
+        result = (false != result) && (nullptr != entry_.data);
+    }
+
+    changed_.notify_all();
+
+    return result;
+}
+
+bool ReplayTransport::IsFinished() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return nullptr == entry_.data;
+}
+
+uint64_t ReplayTransport::GetBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return bytes_;
+}
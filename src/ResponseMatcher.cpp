@@ -0,0 +1,140 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "ResponseMatcher.h"
+
+#include <cstring>
+#include <queue>
+
+namespace
+{
+    const char *const ResponseTokenTexts[ResponseMatcher::TokenCount] =
+    {
+        "OK\r\n",
+        "OK go\r\n",
+        "Invalid command\r\n",
+        "Invalid argument\r\n",
+        ">"
+    };
+
+    const std::size_t AlphabetSize = 256U;
+}
+
+const uint32_t ResponseMatcher::ResponseTokens;
+const uint32_t ResponseMatcher::PromptTokens;
+
+ResponseMatcher::Automaton::Automaton()
+{
+    std::vector<uint8_t> fail;
+
+    // Trie of all tokens, 0 in transitions means "no edge yet" (root can not be a target)
+    transitions.assign(AlphabetSize, 0);
+    outputs.assign(1, -1);
+    fail.assign(1, 0);
+
+    for (int token = 0; token < TokenCount; token++)
+    {
+        const char *text = ResponseTokenTexts[token];
+        std::size_t state = 0;
+
+        for (std::size_t i = 0; i < strlen(text); i++)
+        {
+            const uint8_t ch = static_cast<uint8_t>(text[i]);
+
+            if (0 == transitions[state * AlphabetSize + ch])
+            {
+                transitions[state * AlphabetSize + ch] = static_cast<uint8_t>(outputs.size());
+                transitions.resize(transitions.size() + AlphabetSize, 0);
+                outputs.push_back(-1);
+                fail.push_back(0);
+            }
+
+            state = transitions[state * AlphabetSize + ch];
+        }
+
+        outputs[state] = static_cast<int8_t>(token);
+    }
+
+    // Turn the trie into a complete DFA (Aho-Corasick), walking states breadth first
+    std::queue<std::size_t> pending;
+
+    for (std::size_t ch = 0; ch < AlphabetSize; ch++)
+    {
+        const uint8_t next = transitions[ch];
+
+        if (0 != next)
+        {
+            fail[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (false == pending.empty())
+    {
+        const std::size_t state = pending.front();
+        pending.pop();
+
+        if (-1 == outputs[state])
+        {
+            outputs[state] = outputs[fail[state]];
+        }
+
+        for (std::size_t ch = 0; ch < AlphabetSize; ch++)
+        {
+            const uint8_t next = transitions[state * AlphabetSize + ch];
+
+            if (0 != next)
+            {
+                fail[next] = transitions[fail[state] * AlphabetSize + ch];
+                pending.push(next);
+            }
+            else
+            {
+                transitions[state * AlphabetSize + ch] = transitions[fail[state] * AlphabetSize + ch];
+            }
+        }
+    }
+}
+
+const ResponseMatcher::Automaton &ResponseMatcher::GetAutomaton()
+{
+    static const Automaton automaton;
+    return automaton;
+}
+
+ResponseMatcher::ResponseMatcher() :
+    state_(0)
+{
+
+}
+
+void ResponseMatcher::Reset()
+{
+    state_ = 0;
+}
+
+int ResponseMatcher::Feed(const uint8_t *data, std::size_t size, uint32_t mask, std::size_t &consumed)
+{
+    const Automaton &automaton = GetAutomaton();
+    const uint8_t *transitions = automaton.transitions.data();
+    const int8_t *outputs = automaton.outputs.data();
+
+    std::size_t state = state_;
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        state = transitions[state * AlphabetSize + data[i]];
+
+        const int token = outputs[state];
+
+        if ((token >= 0) && (0 != (mask & (1U << token))))
+        {
+            state_ = 0;
+            consumed = i + 1;
+            return token;
+        }
+    }
+
+    state_ = static_cast<uint8_t>(state);
+    consumed = size;
+
+    return -1;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PowerOfTwo.h"
+
+RingBuffer::RingBuffer(std::size_t Capacity) :
+    storage_(RoundUpToPowerOfTwo(Capacity)),
+    mask_(storage_.size() - 1),
+    head_(0),
+    tail_(0)
+{
+
+}
+
+std::size_t RingBuffer::Write(const uint8_t *Data, std::size_t Size)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+    const std::size_t count = std::min(Size, storage_.size() - (head - tail));
+    const std::size_t offset = head & mask_;
+    const std::size_t first = std::min(count, storage_.size() - offset);
+
+    memcpy(&storage_[offset], Data, first);
+    memcpy(&storage_[0], Data + first, count - first);
+
+    head_.store(head + count, std::memory_order_release);
+
+    return count;
+}
+
+std::size_t RingBuffer::Read(uint8_t *Buffer, std::size_t Size)
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+
+    const std::size_t count = std::min(Size, head - tail);
+    const std::size_t offset = tail & mask_;
+    const std::size_t first = std::min(count, storage_.size() - offset);
+
+    memcpy(Buffer, &storage_[offset], first);
+    memcpy(Buffer + first, &storage_[0], count - first);
+
+    tail_.store(tail + count, std::memory_order_release);
+
+    return count;
+}
+
+std::size_t RingBuffer::Peek(DataView &View) const
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+
+    const std::size_t count = head - tail;
+    const std::size_t offset = tail & mask_;
+
+    View.first = &storage_[offset];
+    View.first_size = std::min(count, storage_.size() - offset);
+    View.second = &storage_[0];
+    View.second_size = count - View.first_size;
+
+    return count;
+}
+
+void RingBuffer::Consume(std::size_t Size)
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+
+    tail_.store(tail + std::min(Size, head - tail), std::memory_order_release);
+}
+
+std::size_t RingBuffer::Size() const
+{
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
+
+std::size_t RingBuffer::Capacity() const
+{
+    return storage_.size();
+}
@@ -0,0 +1,151 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "SerialTransport.h"
+
+#include <algorithm>
+
+SerialTransport::SerialTransport(std::shared_ptr<serial::Serial> SerialPort) :
+    serial_port_(SerialPort),
+    interrupted_(false),
+    pending_(0),
+    has_pending_(false)
+{
+
+}
+
+SerialTransport::~SerialTransport()
+{
+
+}
+
+std::shared_ptr<serial::Serial> &SerialTransport::GetSerialPort()
+{
+    return serial_port_;
+}
+
+std::size_t SerialTransport::Read(uint8_t *Buffer, std::size_t Size)
+{
+    std::size_t count = 0;
+
+#if defined(_WIN32)
+    {
+        // Byte received by WaitReadable() goes first
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+
+        if ((false != has_pending_) && (Size > 0))
+        {
+            Buffer[0] = pending_;
+            has_pending_ = false;
+            count = 1;
+        }
+    }
+#endif
+
+    const std::size_t available = std::min(serial_port_->available(), Size - count);
+
+    return (available > 0) ? count + serial_port_->read(Buffer + count, available) : count;
+}
+
+std::size_t SerialTransport::Write(const uint8_t *Data, std::size_t Size, std::chrono::steady_clock::time_point Deadline)
+{
+    std::size_t written = 0;
+
+    // Every write returns after the port write timeout at the latest
+    do
+    {
+        written += serial_port_->write(Data + written, Size - written);
+    }
+    while ((written < Size) && (std::chrono::steady_clock::now() < Deadline));
+
+    return written;
+}
+
+bool SerialTransport::WaitReadable(std::chrono::steady_clock::time_point Deadline)
+{
+    for (;;)
+    {
+        if (false != interrupted_.load())
+        {
+            return false;
+        }
+
+        if ((false != HasPending()) || (serial_port_->available() > 0))
+        {
+            return true;
+        }
+
+        if (std::chrono::steady_clock::now() >= Deadline)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        // serial::Serial::waitReadable() is not implemented on Windows. Reading one byte blocks
+        // in ReadFile() until it arrives or for up to the port read timeout, the byte is kept
+        // for the next Read().
+        uint8_t byte = 0;
+
+        if (serial_port_->read(&byte, 1) > 0)
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_ = byte;
+            has_pending_ = true;
+        }
+#else
+        // Blocks in select() on the port for up to the port read timeout
+        serial_port_->waitReadable();
+#endif
+    }
+}
+
+bool SerialTransport::HasPending()
+{
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+
+    return has_pending_;
+}
+
+void SerialTransport::SetInterrupted(bool Interrupted)
+{
+    interrupted_.store(Interrupted);
+}
+
+void SerialTransport::Flush()
+{
+    serial_port_->flush();
+}
+
+bool SerialTransport::SetBaudrate(uint32_t Baudrate)
+{
+    try
+    {
+        serial_port_->setBaudrate(Baudrate);
+        serial_port_->flushInput();
+
+#if defined(_WIN32)
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        has_pending_ = false;
+#endif
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t SerialTransport::GetBaudrate() const
+{
+    uint32_t baudrate = 0;
+
+    try
+    {
+        baudrate = serial_port_->getBaudrate();
+    }
+    catch (...)
+    {
+        // Baudrate is not known
+    }
+
+    return baudrate;
+}
@@ -0,0 +1,204 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+#include "SettingsStore.h"
+
+namespace
+{
+    /**
+    *   Locale independent parser for values reported by #info, e.g. "50000", "-1.5", ".140"
+    */
+    bool ParseNumber(const char *Text, std::size_t Length, bool AllowFraction, long &Integer, float &Number)
+    {
+        const char *ch = Text;
+        const char *end = Text + Length;
+        bool negative = false;
+
+        if ((ch < end) && (('-' == *ch) || ('+' == *ch)))
+        {
+            negative = ('-' == *ch);
+            ch++;
+        }
+
+        long integer = 0;
+        double fraction = 0.0;
+        double scale = 1.0;
+        bool digits = false;
+
+        while ((ch < end) && (*ch >= '0') && (*ch <= '9'))
+        {
+            integer = integer * 10 + (*ch - '0');
+            digits = true;
+            ch++;
+        }
+
+        if ((false != AllowFraction) && (ch < end) && ('.' == *ch))
+        {
+            ch++;
+
+            while ((ch < end) && (*ch >= '0') && (*ch <= '9'))
+            {
+                fraction = fraction * 10.0 + (*ch - '0');
+                scale *= 10.0;
+                digits = true;
+                ch++;
+            }
+        }
+
+        if ((ch != end) || (false == digits))
+        {
+            return false;
+        }
+
+        const double number = static_cast<double>(integer) + fraction / scale;
+
+        Integer = negative ? -integer : integer;
+        Number = static_cast<float>(negative ? -number : number);
+
+        return true;
+    }
+}
+
+SettingsStore::SettingsStore(const EchosounderCommandTable &CommandList) :
+    dirty_(0)
+{
+    for (std::size_t i = 0; i < EchosounderCommandCount; i++)
+    {
+        entries_[i].type = CommandList.commands[i].value_type;
+        entries_[i].numeric = false;
+        entries_[i].integer = 0;
+        entries_[i].number = 0.0F;
+    }
+}
+
+bool SettingsStore::Parse(Entry &Item, const char *Text, std::size_t Length)
+{
+    Item.numeric = false;
+
+    switch (Item.type)
+    {
+        case ValueInteger:
+        case ValueFlag:
+        case ValueMode:
+            Item.numeric = ParseNumber(Text, Length, false, Item.integer, Item.number);
+            break;
+
+        case ValueFloat:
+            Item.numeric = ParseNumber(Text, Length, true, Item.integer, Item.number);
+            break;
+
+        case ValueText:
+            return true;
+
+        default:
+            break;
+    }
+
+    return Item.numeric;
+}
+
+bool SettingsStore::Set(EchosounderCommandIds Command, const char *Text, std::size_t Length)
+{
+    if (static_cast<unsigned>(Command) >= EchosounderCommandCount)
+    {
+        return false;
+    }
+
+    Entry &entry = entries_[Command];
+
+    if (Text != entry.text.data())
+    {
+        entry.text.assign(Text, Length);
+    }
+
+    entry.confirmed = entry.text;
+    dirty_ &= ~(uint64_t(1) << Command);
+
+    return Parse(entry, entry.text.data(), entry.text.size());
+}
+
+bool SettingsStore::Stage(EchosounderCommandIds Command, const std::string &Text)
+{
+    if (static_cast<unsigned>(Command) >= EchosounderCommandCount)
+    {
+        return false;
+    }
+
+    Entry &entry = entries_[Command];
+
+    entry.text = Text;
+
+    if (entry.text != entry.confirmed)
+    {
+        dirty_ |= (uint64_t(1) << Command);
+    }
+    else
+    {
+        dirty_ &= ~(uint64_t(1) << Command);
+    }
+
+    return Parse(entry, entry.text.data(), entry.text.size());
+}
+
+uint64_t SettingsStore::GetDirty() const
+{
+    return dirty_;
+}
+
+bool SettingsStore::Matches(EchosounderCommandIds Command, const std::string &Text) const
+{
+    if (static_cast<unsigned>(Command) >= EchosounderCommandCount)
+    {
+        return false;
+    }
+
+    const Entry &entry = entries_[Command];
+    long integer = 0;
+    float number = 0.0F;
+
+    if ((false != entry.numeric) && (false != ParseNumber(Text.data(), Text.size(), (ValueFloat == entry.type), integer, number)))
+    {
+        // #info may print decimals with other precision than they were sent, e.g. 0.14 and 0.140
+        const float difference = (entry.number > number) ? (entry.number - number) : (number - entry.number);
+        const float magnitude = (entry.number > 0.0F) ? entry.number : -entry.number;
+
+        return difference <= 1e-5F * ((magnitude > 1.0F) ? magnitude : 1.0F);
+    }
+
+    return entry.text == Text;
+}
+
+bool SettingsStore::Set(EchosounderCommandIds Command, const std::string &Text)
+{
+    return Set(Command, Text.data(), Text.size());
+}
+
+const std::string &SettingsStore::GetText(EchosounderCommandIds Command) const
+{
+    return (static_cast<unsigned>(Command) < EchosounderCommandCount) ? entries_[Command].text : empty_;
+}
+
+bool SettingsStore::GetLong(EchosounderCommandIds Command, long &Value) const
+{
+    if ((static_cast<unsigned>(Command) >= EchosounderCommandCount) || (false == entries_[Command].numeric))
+    {
+        return false;
+    }
+
+    Value = entries_[Command].integer;
+    return true;
+}
+
+bool SettingsStore::GetFloat(EchosounderCommandIds Command, float &Value) const
+{
+    if ((static_cast<unsigned>(Command) >= EchosounderCommandCount) || (false == entries_[Command].numeric))
+    {
+        return false;
+    }
+
+    Value = entries_[Command].number;
+    return true;
+}
+
+EchosounderValueType SettingsStore::GetType(EchosounderCommandIds Command) const
+{
+    return (static_cast<unsigned>(Command) < EchosounderCommandCount) ? entries_[Command].type : ValueNone;
+}
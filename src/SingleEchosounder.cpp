@@ -1,7 +1,19 @@
 // Copyright (c) EofE Ultrasonics Co., Ltd., 2024
 #include "SingleEchosounder.h"
 
-SingleEchosounder::SingleEchosounder(std::shared_ptr<serial::Serial> SerialPort, std::map<int, EchosounderCommandList>& CommandList) :
+SingleEchosounder::SingleEchosounder(std::shared_ptr<ITransport> Transport, const EchosounderCommandTable &CommandList) :
+    Echosounder(Transport, CommandList)
+{
+
+}
+
+SingleEchosounder::SingleEchosounder(std::shared_ptr<ITransport> Transport, const EchosounderDetectInfo *Detected, const EchosounderCommandTable &CommandList) :
+    Echosounder(Transport, Detected, CommandList)
+{
+
+}
+
+SingleEchosounder::SingleEchosounder(std::shared_ptr<serial::Serial> SerialPort, const EchosounderCommandTable &CommandList) :
     Echosounder(SerialPort, CommandList)
 {
 
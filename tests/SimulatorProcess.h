@@ -0,0 +1,102 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Simulator used by the tests of the command paths.
+// Test programs get the echosounder_sim executable as their first argument.
+
+#if !defined(SIMULATORPROCESS_H)
+#define SIMULATORPROCESS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "PosixTransport.h"
+
+/**
+    @class SimulatorProcess
+
+    Runs echosounder_sim for the lifetime of the object. Path is the pseudo-terminal
+    the simulator prints on start, empty if it failed to start.
+ */
+
+class SimulatorProcess
+{
+    pid_t pid_;
+    std::string path_;
+
+public:
+
+    SimulatorProcess(const std::string &Executable, const std::vector<std::string> &Options) :
+        pid_(-1)
+    {
+        int fds[2];
+
+        if (0 != pipe(fds))
+        {
+            return;
+        }
+
+        std::vector<char *> arguments;
+        arguments.push_back(const_cast<char *>(Executable.c_str()));
+
+        for (const std::string &option : Options)
+        {
+            arguments.push_back(const_cast<char *>(option.c_str()));
+        }
+
+        arguments.push_back(nullptr);
+
+        pid_ = fork();
+
+        if (0 == pid_)
+        {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+            execv(Executable.c_str(), arguments.data());
+            _exit(127);
+        }
+
+        close(fds[1]);
+
+        char ch;
+
+        while ((pid_ > 0) && (1 == read(fds[0], &ch, 1)) && ('\n' != ch))
+        {
+            path_.push_back(ch);
+        }
+
+        close(fds[0]);
+    }
+
+    ~SimulatorProcess()
+    {
+        if (pid_ > 0)
+        {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+        }
+    }
+
+    SimulatorProcess(const SimulatorProcess &) = delete;
+    SimulatorProcess &operator=(const SimulatorProcess &) = delete;
+
+    const std::string &GetPath() const
+    {
+        return path_;
+    }
+
+    /**
+    *   @brief Open the simulator port
+    */
+    std::shared_ptr<PosixTransport> Open() const
+    {
+        return std::make_shared<PosixTransport>(path_, 115200);
+    }
+};
+
+#endif // SIMULATORPROCESS_H
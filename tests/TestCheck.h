@@ -0,0 +1,53 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Checks shared by the regression tests.
+// Failed checks are printed, TestResult() is the exit code of the test program.
+
+#if !defined(TESTCHECK_H)
+#define TESTCHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+#define CHECK(Condition) Check((Condition), #Condition, __FILE__, __LINE__)
+
+/**
+*   Number of failed checks
+*/
+inline int &TestFailures()
+{
+    static int failures = 0;
+
+    return failures;
+}
+
+inline void Check(bool Passed, const char *Text, const char *File, int Line)
+{
+    if (false == Passed)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", File, Line, Text);
+        TestFailures()++;
+    }
+}
+
+inline bool Near(double Value, double Expected, double Tolerance)
+{
+    return std::fabs(Value - Expected) <= Tolerance;
+}
+
+/**
+*   @brief Print number of failed checks
+*   @return exit code, 1 if any check failed
+*/
+inline int TestResult()
+{
+    if (0 != TestFailures())
+    {
+        fprintf(stderr, "%d checks failed\n", TestFailures());
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif // TESTCHECK_H
@@ -0,0 +1,132 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Asynchronous command tests.
+// Queues commands to the command thread of the simulator and checks results, completion
+// callbacks, execution order and cancellation when the echosounder is closed.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define COMMANDS 20
+#define WAIT_LIMIT_MS 5000
+
+namespace
+{
+    bool WaitReady(std::future<int> &Result)
+    {
+        return std::future_status::ready == Result.wait_for(std::chrono::milliseconds(WAIT_LIMIT_MS));
+    }
+
+    bool WaitIdle(Echosounder &Sonar)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WAIT_LIMIT_MS);
+
+        while ((0 != Sonar.GetPendingCommands()) && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return 0 == Sonar.GetPendingCommands();
+    }
+
+    void TestAsyncOrder(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "50" });
+        SingleEchosounder sonar(sim.Open());
+        std::vector<std::future<int>> results;
+        std::vector<int> order;
+
+        CHECK(sonar.IsDetected());
+
+        results.push_back(sonar.StartAsync());
+
+        // Callbacks run on the command thread one after another, in the order of queueing
+        for (int i = 0; i < COMMANDS; i++)
+        {
+            results.push_back(sonar.SetValueAsync(IdRange, std::to_string(10000 + i * 100), [&order, i](int Result)
+            {
+                order.push_back((1 == Result) ? i : -1);
+            }));
+        }
+
+        std::future<int> invalid = sonar.SetValueAsync(IdRange, "abc");
+        std::future<int> settings = sonar.GetSettingsAsync();
+        std::future<int> stop = sonar.StopAsync();
+
+        for (std::future<int> &result : results)
+        {
+            CHECK(WaitReady(result) && (1 == result.get()));
+        }
+
+        CHECK(WaitReady(invalid) && (3 == invalid.get()));
+        CHECK(WaitReady(settings) && (1 == settings.get()));
+        CHECK(WaitReady(stop) && (1 == stop.get()));
+        CHECK(WaitIdle(sonar));
+
+        CHECK(COMMANDS == order.size());
+
+        for (std::size_t i = 0; i < order.size(); i++)
+        {
+            CHECK(static_cast<int>(i) == order[i]);
+        }
+
+        CHECK(false == sonar.IsRunning());
+        CHECK(std::to_string(10000 + (COMMANDS - 1) * 100) == sonar.GetValue(IdRange));
+    }
+
+    void TestAsyncClose(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--latency", "20" });
+        std::vector<std::future<int>> results;
+
+        {
+            SingleEchosounder sonar(sim.Open());
+
+            for (int i = 0; i < COMMANDS; i++)
+            {
+                results.push_back(sonar.SetValueAsync(IdRange, std::to_string(10000 + i * 100)));
+            }
+        }
+
+        // Commands left in the queue are cancelled, none is left without a result
+        int done = 0;
+        int cancelled = 0;
+
+        for (std::future<int> &result : results)
+        {
+            CHECK(WaitReady(result));
+
+            const int value = result.get();
+            CHECK((1 == value) || (0 == value));
+
+            done += (1 == value) ? 1 : 0;
+            cancelled += (0 == value) ? 1 : 0;
+        }
+
+        CHECK(COMMANDS == done + cancelled);
+        CHECK(cancelled > 0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestAsyncOrder(argv[1]);
+    TestAsyncClose(argv[1]);
+
+    return TestResult();
+}
@@ -0,0 +1,91 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// ClockModel tests.
+// Checks drift and offset estimation, conversions both ways and ZDA time.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "ClockModel.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestClockModel()
+    {
+        ClockModel model;
+        EchosounderClockState state;
+        int64_t converted = 0;
+
+        CHECK(false == model.ToDevice(0, converted));
+        CHECK(false == model.ToHost(0, converted));
+        CHECK(false == model.GetState(state));
+
+        // Device runs 50 ppm fast and 1.25 s ahead, sentences arrive 0..1 ms after their time
+        const int64_t host0 = 5000000000LL;
+        const int64_t device0 = 1792224000000000LL;
+        const double drift = 50e-6;
+        uint32_t random = 1;
+
+        for (int64_t i = 0; i < 200; i++)
+        {
+            const int64_t host = host0 + i * 500000LL;
+            const int64_t device = device0 + 1250000LL + static_cast<int64_t>(std::llround(static_cast<double>(host - host0) * (1.0 + drift)));
+
+            random = random * 1103515245U + 12345U;
+            model.AddSample(host + static_cast<int64_t>((random >> 8) % 1000U), device);
+        }
+
+        CHECK(model.GetState(state));
+
+        // Samples closer than 1 s are skipped, the window keeps the newest 64
+        CHECK(64 == state.samples);
+        CHECK(Near(state.drift_ppm, 50.0, 10.0));
+        CHECK(state.residual_us < 1000.0);
+
+        // Offset includes the mean delay of 0.5 ms
+        const int64_t host = host0 + 80000000LL;
+        const int64_t expected = device0 + 1250000LL + static_cast<int64_t>(std::llround(80000000.0 * (1.0 + drift))) - 500;
+
+        CHECK(model.ToDevice(host, converted));
+        CHECK(std::llabs(converted - expected) < 1000);
+
+        // ToHost is the inverse of ToDevice
+        for (int64_t offset = -1000000000LL; offset <= 1000000000LL; offset += 250000000LL)
+        {
+            int64_t device = 0;
+            int64_t back = 0;
+
+            CHECK(model.ToDevice(host + offset, device));
+            CHECK(model.ToHost(device, back));
+            CHECK(std::llabs(back - (host + offset)) <= 1);
+        }
+
+        model.Reset();
+        CHECK(false == model.ToDevice(host, converted));
+
+        EchosounderNmeaZDA zda;
+        memset(&zda, 0, sizeof(zda));
+        zda.year = 2026;
+        zda.month = 10;
+        zda.day = 17;
+        zda.hour = 12;
+        zda.minute = 34;
+        zda.second = 56;
+        zda.microsecond = 780000;
+
+        CHECK(ClockModel::ZdaToUtcUs(zda, converted) && (1792240496780000LL == converted));
+
+        zda.month = 13;
+        CHECK(false == ClockModel::ZdaToUtcUs(zda, converted));
+    }
+}
+
+int main()
+{
+    TestClockModel();
+
+    return TestResult();
+}
@@ -0,0 +1,83 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// CommandTimeouts tests.
+// Checks default timeouts by response size and baudrate, and overrides set by the user.
+
+#include "CommandTimeouts.h"
+#include "EchosounderCommandTable.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestEstimate()
+    {
+        // 64 bytes of 10 bits with double margin take 134 ms at 9600 baud
+        CHECK(334 == CommandTimeouts::Estimate(64, 9600));
+        CHECK(212 == CommandTimeouts::Estimate(64, 115200));
+        CHECK(200 == CommandTimeouts::Estimate(0, 115200));
+
+        // Unknown baudrate is taken as the slowest one
+        CHECK(CommandTimeouts::Estimate(64, 9600) == CommandTimeouts::Estimate(64, 0));
+        CHECK(CommandTimeouts::Estimate(4096, 9600) > CommandTimeouts::Estimate(4096, 115200));
+    }
+
+    void TestDefaults()
+    {
+        CommandTimeouts timeouts(DualEchosounderCommands);
+
+        const EchosounderTimeout slow = timeouts.Get(IdRange);
+        CHECK(slow.response_ms == CommandTimeouts::Estimate(64, 0));
+        CHECK(slow.prompt_ms < slow.response_ms);
+
+        // #info prints a line per supported command
+        CHECK(timeouts.Get(IdInfo).response_ms > 1000);
+        CHECK(timeouts.Get(IdInfo).response_ms > timeouts.Get(IdVersion).response_ms);
+
+        timeouts.SetBaudrate(115200);
+        CHECK(timeouts.Get(IdRange).response_ms < slow.response_ms);
+        CHECK(timeouts.Get(IdInfo).response_ms < 1000);
+
+        // Measured size of the response replaces the estimate
+        timeouts.SetResponseSize(IdInfo, 100);
+        CHECK(CommandTimeouts::Estimate(100, 115200) == timeouts.Get(IdInfo).response_ms);
+
+        // Ids out of range get the timeouts of #info
+        const EchosounderCommandIds invalid = static_cast<EchosounderCommandIds>(EchosounderCommandCount);
+        timeouts.SetResponseSize(invalid, 1);
+        CHECK(timeouts.Get(IdInfo).response_ms == timeouts.Get(invalid).response_ms);
+    }
+
+    void TestOverrides()
+    {
+        CommandTimeouts timeouts(SingleEchosounderCommands);
+        const EchosounderTimeout defaults = timeouts.Get(IdRange);
+
+        // Zero fields keep the default
+        EchosounderTimeout timeout;
+        timeout.response_ms = 50;
+        timeout.prompt_ms = 0;
+        timeouts.Set(IdRange, timeout);
+
+        CHECK(50 == timeouts.Get(IdRange).response_ms);
+        CHECK(defaults.prompt_ms == timeouts.Get(IdRange).prompt_ms);
+
+        // Overrides are kept when the baudrate changes, defaults follow it
+        timeouts.SetBaudrate(115200);
+        CHECK(50 == timeouts.Get(IdRange).response_ms);
+        CHECK(CommandTimeouts::Estimate(8, 115200) == timeouts.Get(IdRange).prompt_ms);
+        CHECK(CommandTimeouts::Estimate(64, 115200) == timeouts.Get(IdInterval).response_ms);
+
+        timeouts.Reset(IdRange);
+        CHECK(CommandTimeouts::Estimate(64, 115200) == timeouts.Get(IdRange).response_ms);
+    }
+}
+
+int main()
+{
+    TestEstimate();
+    TestDefaults();
+    TestOverrides();
+
+    return TestResult();
+}
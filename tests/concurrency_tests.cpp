@@ -0,0 +1,132 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Concurrency tests.
+// Runs commands from a control thread while the data thread reads and peeks the output
+// of the simulator, with and without streaming mode.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define PEEKS 20
+#define RUN_MS 1000
+
+namespace
+{
+    std::string ViewText(const DataView &View)
+    {
+        std::string text(reinterpret_cast<const char *>(View.first), View.first_size);
+        text.append(reinterpret_cast<const char *>(View.second), View.second_size);
+
+        return text;
+    }
+
+    void TestPeekDuringCommands(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "50" });
+        SingleEchosounder sonar(sim.Open());
+        int peeks = 0;
+        int changed = 0;
+
+        sonar.Start();
+
+        // Commands of another thread between PeekData() and ConsumeData() leave the view as it was
+        for (int i = 0; i < PEEKS; i++)
+        {
+            DataView view;
+            const std::size_t count = sonar.PeekData(view, 500);
+
+            if (0 == count)
+            {
+                continue;
+            }
+
+            const std::string before = ViewText(view);
+
+            std::thread control([&sonar]()
+            {
+                sonar.Stop();
+                sonar.SetValue(IdRange, "20000");
+                sonar.Start();
+            });
+
+            control.join();
+
+            changed += (before != ViewText(view)) ? 1 : 0;
+            peeks++;
+            sonar.ConsumeData(count);
+        }
+
+        sonar.Stop();
+
+        CHECK(peeks > 0);
+        CHECK(0 == changed);
+
+        EchosounderNmeaStatistics statistics;
+        sonar.GetNmeaStatistics(statistics);
+        CHECK(statistics.sentences > 0);
+        CHECK(0 == statistics.checksum_errors);
+    }
+
+    void TestControlAndData(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "100" });
+        SingleEchosounder sonar(sim.Open());
+        std::atomic<bool> stop(false);
+        std::size_t bytes = 0;
+        int commands = 0;
+        int failed = 0;
+
+        CHECK(sonar.StartStreaming(1U << 16));
+        sonar.Start();
+
+        std::thread data([&sonar, &stop, &bytes]()
+        {
+            uint8_t buffer[1024];
+
+            while (false == stop)
+            {
+                bytes += sonar.ReadData(buffer, sizeof(buffer), 10);
+            }
+        });
+
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(RUN_MS);
+
+        while (std::chrono::steady_clock::now() < end)
+        {
+            const std::string range = (0 == (commands & 1)) ? "20000" : "30000";
+
+            failed += (false == sonar.SetValue(IdRange, range)) ? 1 : 0;
+            failed += (range != sonar.GetValue(IdRange)) ? 1 : 0;
+            commands++;
+        }
+
+        stop = true;
+        data.join();
+
+        CHECK(commands > 0);
+        CHECK(0 == failed);
+        CHECK(bytes > 0);
+        CHECK(sonar.IsRunning());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestPeekDuringCommands(argv[1]);
+    TestControlAndData(argv[1]);
+
+    return TestResult();
+}
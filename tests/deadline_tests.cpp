@@ -0,0 +1,91 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Deadline and command timeout tests.
+// Runs commands against a slow simulator with deadlines and overridden timeouts shorter
+// than its response time, and checks they fail in time and later commands still work.
+
+#include <chrono>
+#include <string>
+
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define RESPONSE_LATENCY "200"
+#define SHORT_MS 50
+#define FAIL_LIMIT_MS 150
+
+namespace
+{
+    int64_t ElapsedMs(std::chrono::steady_clock::time_point Begin)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Begin).count();
+    }
+
+    void TestDeadline(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--latency", RESPONSE_LATENCY });
+        SingleEchosounder sonar(sim.Open());
+
+        CHECK(sonar.IsDetected());
+
+        auto begin = std::chrono::steady_clock::now();
+        CHECK(false == sonar.SetValue(IdRange, "20000", begin + std::chrono::milliseconds(SHORT_MS)));
+        CHECK(ElapsedMs(begin) < FAIL_LIMIT_MS);
+
+        begin = std::chrono::steady_clock::now();
+        CHECK(false == sonar.Start(begin + std::chrono::milliseconds(SHORT_MS)));
+        CHECK(ElapsedMs(begin) < FAIL_LIMIT_MS);
+
+        // Late responses of the failed commands do not confuse the next ones
+        CHECK(sonar.SetValue(IdRange, "30000"));
+        CHECK("30000" == sonar.GetValue(IdRange));
+        CHECK(sonar.GetSettings(std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+    }
+
+    void TestCommandTimeout(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--latency", RESPONSE_LATENCY });
+        SingleEchosounder sonar(sim.Open());
+        const EchosounderTimeout defaults = sonar.GetCommandTimeout(IdRange);
+
+        EchosounderTimeout timeout;
+        timeout.response_ms = SHORT_MS;
+        timeout.prompt_ms = 0;
+        sonar.SetCommandTimeout(IdRange, timeout);
+
+        CHECK(SHORT_MS == sonar.GetCommandTimeout(IdRange).response_ms);
+        CHECK(defaults.prompt_ms == sonar.GetCommandTimeout(IdRange).prompt_ms);
+
+        // Prompt is waited for after a failed response as well
+        timeout.prompt_ms = SHORT_MS;
+        sonar.SetCommandTimeout(IdRange, timeout);
+
+        const auto begin = std::chrono::steady_clock::now();
+        CHECK(false == sonar.SetValue(IdRange, "20000"));
+        CHECK(ElapsedMs(begin) < FAIL_LIMIT_MS);
+
+        // Other commands keep their timeouts
+        CHECK(sonar.SetValue(IdInterval, "0.5"));
+
+        sonar.ResetCommandTimeout(IdRange);
+        CHECK(defaults.response_ms == sonar.GetCommandTimeout(IdRange).response_ms);
+        CHECK(sonar.SetValue(IdRange, "20000"));
+        CHECK("20000" == sonar.GetValue(IdRange));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestDeadline(argv[1]);
+    TestCommandTimeout(argv[1]);
+
+    return TestResult();
+}
@@ -0,0 +1,110 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Detection tests.
+// Detects the single and dual frequency simulator, stopped and running, with and without
+// a baudrate list, and checks that a port without an echosounder fails within the budget.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+
+#include "EchosounderDetector.h"
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define SILENT_LIMIT_MS 2000
+#define DEADLINE_MS 100
+#define DEADLINE_LIMIT_MS 300
+
+namespace
+{
+    int64_t ElapsedMs(std::chrono::steady_clock::time_point Begin)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Begin).count();
+    }
+
+    void TestDetectModel(const std::string &Simulator, bool Dual)
+    {
+        SimulatorProcess sim(Simulator, Dual ? std::vector<std::string>{ "--dual" } : std::vector<std::string>());
+        std::shared_ptr<PosixTransport> transport = sim.Open();
+        EchosounderDetector detector(transport);
+        EchosounderDetectInfo info;
+
+        // Without a list the baudrate the transport was opened with is reported
+        CHECK(detector.Detect({}, info));
+        CHECK(115200 == info.baudrate);
+        CHECK(Dual == info.dual);
+        CHECK(0 == strcmp(info.firmware, "1.05"));
+
+        // First baudrate of the list answers, the simulator takes any
+        CHECK(detector.Detect({ 9600, 115200 }, info));
+        CHECK(9600 == info.baudrate);
+        CHECK(9600 == transport->GetBaudrate());
+    }
+
+    void TestDetectRunning(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "50" });
+        SingleEchosounder sonar(sim.Open());
+
+        CHECK(sonar.IsDetected());
+
+        sonar.Start();
+        CHECK(sonar.IsRunning());
+
+        // Detection breaks into the running output and leaves the echosounder stopped
+        CHECK(sonar.Detect({ 115200 }));
+        CHECK(false == sonar.IsRunning());
+        CHECK(115200 == sonar.GetDetectInfo().baudrate);
+        CHECK(sonar.SetValue(IdRange, "20000"));
+    }
+
+    void TestDetectSilent()
+    {
+        // Pseudo-terminal nobody answers on
+        const int master = posix_openpt(O_RDWR | O_NOCTTY);
+        CHECK((master >= 0) && (0 == grantpt(master)) && (0 == unlockpt(master)));
+
+        if (master < 0)
+        {
+            return;
+        }
+
+        std::shared_ptr<PosixTransport> transport = std::make_shared<PosixTransport>(ptsname(master), 115200);
+        EchosounderDetector detector(transport);
+        EchosounderDetectInfo info;
+
+        auto begin = std::chrono::steady_clock::now();
+        CHECK(false == detector.Detect({}, info));
+        CHECK(ElapsedMs(begin) < SILENT_LIMIT_MS);
+
+        begin = std::chrono::steady_clock::now();
+        detector.SetDeadline(begin + std::chrono::milliseconds(DEADLINE_MS));
+        CHECK(false == detector.Detect({ 9600, 19200, 115200 }, info));
+        CHECK(ElapsedMs(begin) < DEADLINE_LIMIT_MS);
+
+        transport.reset();
+        close(master);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestDetectModel(argv[1], false);
+    TestDetectModel(argv[1], true);
+    TestDetectRunning(argv[1]);
+    TestDetectSilent();
+
+    return TestResult();
+}
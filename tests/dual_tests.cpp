@@ -0,0 +1,133 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Dual frequency channel tests.
+// Runs the dual simulator in dual mode and checks that records are separated by channel
+// and that high and low records of the same sentence type and ping are paired.
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "DualEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define RUN_MS 400
+
+namespace
+{
+    bool IsTalker(const EchosounderNmeaRecord &Record, const char *Talker)
+    {
+        return 0 == strcmp(Record.talker, Talker);
+    }
+
+    void TestChannels(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--dual", "--rate", "50" });
+        DualEchosounder sonar(sim.Open());
+
+        CHECK(sonar.IsDetected());
+        CHECK(sonar.SetValue(IdSetDualFreq, ""));
+
+        // Reader thread parses the output while the test only sleeps
+        CHECK(sonar.StartStreaming(1U << 16));
+        sonar.SetChannelOutput(true, true);
+        sonar.Start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(RUN_MS));
+        sonar.Stop();
+
+        uint64_t counts[ChannelCount] = { 0, 0 };
+        const char *const talkers[ChannelCount] = { "SH", "SL" };
+
+        for (int channel = ChannelHigh; channel < ChannelCount; channel++)
+        {
+            EchosounderNmeaRecord item;
+            int64_t previous = 0;
+            bool talker = true;
+            bool ordered = true;
+
+            while (false != sonar.ReadChannelRecord(static_cast<EchosounderChannel>(channel), item))
+            {
+                talker = talker && IsTalker(item, talkers[channel]);
+                ordered = ordered && (item.host_time_us >= previous);
+                previous = item.host_time_us;
+                counts[channel]++;
+            }
+
+            CHECK(counts[channel] > 0);
+            CHECK(true == talker);
+            CHECK(true == ordered);
+        }
+
+        // Every ping prints both channels
+        CHECK(counts[ChannelHigh] == counts[ChannelLow]);
+
+        EchosounderChannelPair pair;
+        uint64_t pairs = 0;
+        bool aligned = true;
+
+        while (false != sonar.ReadChannelPair(pair))
+        {
+            aligned = aligned && (pair.high.sentence == pair.low.sentence);
+            aligned = aligned && IsTalker(pair.high, "SH") && IsTalker(pair.low, "SL");
+            aligned = aligned && (pair.high.host_time_us <= pair.low.host_time_us);
+            pairs++;
+        }
+
+        CHECK(true == aligned);
+        CHECK(counts[ChannelLow] == pairs);
+
+        EchosounderChannelStatistics statistics;
+        sonar.GetChannelStatistics(statistics);
+        CHECK(counts[ChannelHigh] == statistics.records[ChannelHigh]);
+        CHECK(counts[ChannelLow] == statistics.records[ChannelLow]);
+        CHECK(pairs == statistics.pairs);
+        CHECK((0 == statistics.dropped[ChannelHigh]) && (0 == statistics.dropped[ChannelLow]));
+        CHECK(0 == statistics.pairs_dropped);
+        CHECK(0 == statistics.unmatched);
+
+        // Common sentences stay in the record queue
+        EchosounderNmeaRecord record;
+        bool common = true;
+
+        while (false != sonar.ReadRecord(record))
+        {
+            common = common && IsTalker(record, "SD");
+        }
+
+        CHECK(true == common);
+
+        // Without channel output the records of both channels go to the record queue
+        sonar.SetChannelOutput(false, false);
+        sonar.Start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(RUN_MS));
+        sonar.Stop();
+
+        uint64_t channels = 0;
+
+        while (false != sonar.ReadRecord(record))
+        {
+            channels += (IsTalker(record, "SH") || IsTalker(record, "SL")) ? 1 : 0;
+        }
+
+        CHECK(channels > 0);
+
+        CHECK(false == sonar.ReadChannelRecord(ChannelHigh, record));
+        CHECK(false == sonar.ReadChannelPair(pair));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestChannels(argv[1]);
+
+    return TestResult();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// InfoParser tests.
+// Checks values taken from #info responses of the single and dual echosounders.
+
+#include <string>
+
+#include "EchosounderCommandTable.h"
+#include "InfoParser.h"
+#include "SettingsStore.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestInfoParser()
+    {
+        const std::string info =
+            " S/W Ver: 1.05 (build 7)\r\n"
+            " - #range [ 30000 mm ] Range\r\n"
+            " - #rangeh [ 20000 mm ] Range of high frequency\r\n"
+            " - #interval [ 0.5 s ] Interval\r\n"
+            " - #gainl [ -3.5 dB ] Gain of low frequency\r\n"
+            " - #nmearate [ 2.0 Hz ] Output rate\r\n"
+            " - #nmeadbt [ on ] DBT output\r\n"
+            " - #nmeamtw [ 0 ] MTW output\r\n"
+            " - #range [ 99999 mm ] Repeated\r\n"
+            " - #unknown [ 1 ] Not in the table\r\n"
+            " - #deadzone [ 300 mm Dead zone\r\n"
+            "High Frequency: 200000Hz\r\n"
+            "Low Frequency: 30000Hz (Active)\r\n"
+            "OK\r\n";
+
+        const InfoParser parser(DualEchosounderCommands);
+        SettingsStore settings(DualEchosounderCommands);
+        long value = 0;
+        float number = 0.0F;
+
+        CHECK(10 == parser.Parse(info, settings));
+
+        CHECK("1.05" == settings.GetText(IdVersion));
+        CHECK(settings.GetLong(IdRange, value) && (30000 == value));
+        CHECK(settings.GetLong(IdRangeH, value) && (20000 == value));
+        CHECK(settings.GetFloat(IdInterval, number) && Near(number, 0.5, 1e-6));
+        CHECK(settings.GetFloat(IdGainL, number) && Near(number, -3.5, 1e-6));
+        CHECK(settings.GetFloat(IdOutrate, number) && Near(number, 2.0, 1e-6));
+        CHECK(settings.GetLong(IdNMEAMTW, value) && (0 == value));
+        CHECK(settings.GetLong(IdGetHighFreq, value) && (200000 == value));
+        CHECK(settings.GetLong(IdGetLowFreq, value) && (30000 == value));
+        CHECK(settings.GetLong(IdGetWorkFreq, value) && (30000 == value));
+
+        // Non-numeric and unterminated values are skipped
+        CHECK(true == settings.GetText(IdNMEADBT).empty());
+        CHECK(true == settings.GetText(IdDeadzone).empty());
+
+        // Single echosounder reports the output rate as #outrate, and has no frequency lines
+        const InfoParser singleparser(SingleEchosounderCommands);
+        SettingsStore singlesettings(SingleEchosounderCommands);
+
+        CHECK(2 == singleparser.Parse(" - #outrate [ 5.0 Hz ] Output rate\r\n - #nmearate [ 1.0 Hz ] \r\nLow Frequency: 30000Hz (Active)\r\n - #range [ 1000 mm ] Range\r\n", singlesettings));
+        CHECK(singlesettings.GetFloat(IdOutrate, number) && Near(number, 5.0, 1e-6));
+        CHECK(singlesettings.GetLong(IdRange, value) && (1000 == value));
+        CHECK(true == singlesettings.GetText(IdGetWorkFreq).empty());
+    }
+}
+
+int main()
+{
+    TestInfoParser();
+
+    return TestResult();
+}
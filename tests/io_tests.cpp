@@ -0,0 +1,138 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Event loop integration tests.
+// Drives the simulator by ProcessIO() from a poll() loop of the test, checks asynchronous
+// commands, refusal of synchronous ones and that no output is lost when stopping.
+
+#include <chrono>
+#include <future>
+#include <string>
+
+#include <poll.h>
+
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define BUFFER_SIZE (1U << 16)
+#define WAIT_LIMIT_MS 5000
+#define CYCLES 5
+
+namespace
+{
+    /**
+    *   Event loop of the test, runs until Result is ready or for LimitMs
+    */
+    bool RunLoop(Echosounder &Sonar, std::future<int> *Result, int64_t LimitMs)
+    {
+        const auto limit = std::chrono::steady_clock::now() + std::chrono::milliseconds(LimitMs);
+
+        for (;;)
+        {
+            // Queued command is picked up here, Wakeup of the test does nothing
+            Sonar.ProcessIO();
+
+            if ((nullptr != Result) && (std::future_status::ready == Result->wait_for(std::chrono::seconds(0))))
+            {
+                return true;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+
+            if (now >= limit)
+            {
+                return nullptr == Result;
+            }
+
+            const auto until = std::min(limit, Sonar.GetIoDeadline());
+            const int64_t timeout = std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count();
+
+            struct pollfd fds;
+            fds.fd = Sonar.GetFd();
+            fds.events = POLLIN | (Sonar.WantsWrite() ? POLLOUT : 0);
+            fds.revents = 0;
+
+            poll(&fds, 1, static_cast<int>(std::max<int64_t>(timeout, 0) + 1));
+        }
+    }
+
+    int Run(Echosounder &Sonar, std::future<int> Result)
+    {
+        return RunLoop(Sonar, &Result, WAIT_LIMIT_MS) ? Result.get() : -100;
+    }
+
+    void TestEventLoop(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "200", "--latency", "30" });
+        SingleEchosounder sonar(sim.Open());
+        uint8_t buffer[4096];
+        std::size_t stopping = 0;
+
+        CHECK(sonar.IsDetected());
+        CHECK(sonar.GetFd() >= 0);
+
+        CHECK(sonar.AttachIO([]() {}, BUFFER_SIZE));
+        CHECK(false == sonar.AttachIO([]() {}, BUFFER_SIZE));
+
+        CHECK(false == sonar.SetValue(IdRange, "20000"));
+        sonar.Start();
+        CHECK(false == sonar.IsRunning());
+
+        for (int i = 0; i < CYCLES; i++)
+        {
+            CHECK(1 == Run(sonar, sonar.StartAsync()));
+            CHECK(RunLoop(sonar, nullptr, 100));
+            CHECK(sonar.ReadData(buffer, sizeof(buffer), 0) > 0);
+
+            // Running echosounder is stopped for the command and resumed
+            const std::string range = (0 == (i & 1)) ? "20000" : "30000";
+            CHECK(1 == Run(sonar, sonar.SetValueAsync(IdRange, range)));
+            CHECK(range == sonar.GetValue(IdRange));
+            CHECK(sonar.IsRunning());
+
+            while (sonar.ReadData(buffer, sizeof(buffer), 0) > 0)
+            {
+
+            }
+
+            CHECK(1 == Run(sonar, sonar.StopAsync()));
+            CHECK(false == sonar.IsRunning());
+
+            std::size_t br = 0;
+
+            do
+            {
+                br = sonar.ReadData(buffer, sizeof(buffer), 0);
+                stopping += br;
+            }
+            while (br > 0);
+        }
+
+        // Output received until the prompts of the break-ins goes to the stream, no sentence is cut
+        CHECK(stopping > 0);
+
+        EchosounderNmeaStatistics statistics;
+        sonar.GetNmeaStatistics(statistics);
+        CHECK(statistics.sentences > 0);
+        CHECK(0 == statistics.malformed);
+        CHECK(0 == statistics.checksum_errors);
+
+        sonar.DetachIO();
+        CHECK(sonar.SetValue(IdRange, "40000"));
+        CHECK("40000" == sonar.GetValue(IdRange));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestEventLoop(argv[1]);
+
+    return TestResult();
+}
@@ -0,0 +1,184 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// NmeaParser tests.
+// Checks decoded fields of every supported sentence, input split at every byte and error statistics.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "NmeaParser.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    /**
+    *   Sentence with the checksum of Body appended
+    */
+    std::string Sentence(const std::string &Body)
+    {
+        uint8_t checksum = 0;
+        char text[8];
+
+        for (const char ch : Body)
+        {
+            checksum ^= static_cast<uint8_t>(ch);
+        }
+
+        snprintf(text, sizeof(text), "*%02X\r\n", checksum);
+
+        return "$" + Body + text;
+    }
+
+    /**
+    *   Feed Text in chunks of Chunk bytes, records of all completed sentences are appended to Records
+    */
+    void FeedAll(NmeaParser &Parser, const std::string &Text, std::size_t Chunk, std::vector<EchosounderNmeaRecord> &Records)
+    {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(Text.data());
+
+        for (std::size_t offset = 0; offset < Text.size(); offset += Chunk)
+        {
+            std::size_t size = std::min(Chunk, Text.size() - offset);
+            const uint8_t *chunk = data + offset;
+
+            while (size > 0)
+            {
+                bool complete = false;
+                const std::size_t consumed = Parser.Feed(chunk, size, complete);
+
+                if (false != complete)
+                {
+                    Records.push_back(Parser.GetRecord());
+                }
+
+                chunk += consumed;
+                size -= consumed;
+            }
+        }
+    }
+
+    void TestNmeaSentences()
+    {
+        const std::string text =
+            Sentence("SDDBT,32.8,f,10.00,M,5.47,F") +
+            Sentence("SDDPT,10.00,0.50,100") +
+            Sentence("SDMTW,15.5,C") +
+            Sentence("SDXDR,A,1.5,D,PTCH,A,-2.25,D,ROLL") +
+            Sentence("SDEMA,1.0,,-3.5") +
+            Sentence("SDZDA,123456.78,17,10,2026,02,30");
+
+        NmeaParser parser;
+        std::vector<EchosounderNmeaRecord> records;
+        FeedAll(parser, text, text.size(), records);
+
+        CHECK(6 == records.size());
+
+        if (6 != records.size())
+        {
+            return;
+        }
+
+        CHECK(NmeaDBT == records[0].sentence);
+        CHECK(0 == strcmp(records[0].talker, "SD"));
+        CHECK(Near(records[0].data.dbt.depth_ft, 32.8, 1e-4));
+        CHECK(Near(records[0].data.dbt.depth_m, 10.0, 1e-4));
+        CHECK(Near(records[0].data.dbt.depth_fathoms, 5.47, 1e-4));
+
+        CHECK(NmeaDPT == records[1].sentence);
+        CHECK(Near(records[1].data.dpt.depth_m, 10.0, 1e-4));
+        CHECK(Near(records[1].data.dpt.offset_m, 0.5, 1e-4));
+        CHECK(Near(records[1].data.dpt.max_range_m, 100.0, 1e-4));
+
+        CHECK(NmeaMTW == records[2].sentence);
+        CHECK(Near(records[2].data.mtw.temperature_c, 15.5, 1e-4));
+
+        CHECK(NmeaXDR == records[3].sentence);
+        CHECK(2 == records[3].data.xdr.count);
+        CHECK('A' == records[3].data.xdr.measurements[0].type);
+        CHECK('D' == records[3].data.xdr.measurements[0].unit);
+        CHECK(Near(records[3].data.xdr.measurements[0].value, 1.5, 1e-4));
+        CHECK(0 == strcmp(records[3].data.xdr.measurements[0].name, "PTCH"));
+        CHECK(Near(records[3].data.xdr.measurements[1].value, -2.25, 1e-4));
+        CHECK(0 == strcmp(records[3].data.xdr.measurements[1].name, "ROLL"));
+
+        CHECK(NmeaEMA == records[4].sentence);
+        CHECK(3 == records[4].data.ema.count);
+        CHECK(Near(records[4].data.ema.values[0], 1.0, 1e-4));
+        CHECK(std::isnan(records[4].data.ema.values[1]));
+        CHECK(Near(records[4].data.ema.values[2], -3.5, 1e-4));
+
+        const EchosounderNmeaZDA &zda = records[5].data.zda;
+        CHECK(NmeaZDA == records[5].sentence);
+        CHECK((12 == zda.hour) && (34 == zda.minute) && (56 == zda.second));
+        CHECK(780000 == zda.microsecond);
+        CHECK((17 == zda.day) && (10 == zda.month) && (2026 == zda.year));
+        CHECK((2 == zda.zone_hours) && (30 == zda.zone_minutes));
+
+        EchosounderNmeaStatistics statistics;
+        parser.GetStatistics(statistics);
+        CHECK(6 == statistics.sentences);
+        CHECK((0 == statistics.checksum_errors) && (0 == statistics.malformed) && (0 == statistics.unsupported));
+    }
+
+    void TestNmeaSplit()
+    {
+        const std::string text = Sentence("SDDBT,32.8,f,10.00,M,5.47,F") + Sentence("SDMTW,15.5,C");
+
+        // Every split point, down to one byte per Feed()
+        for (std::size_t chunk = 1; chunk <= text.size(); chunk++)
+        {
+            NmeaParser parser;
+            std::vector<EchosounderNmeaRecord> records;
+            FeedAll(parser, text, chunk, records);
+
+            CHECK(2 == records.size());
+            CHECK((2 == records.size()) && (NmeaDBT == records[0].sentence) && (NmeaMTW == records[1].sentence));
+            CHECK((2 == records.size()) && Near(records[0].data.dbt.depth_m, 10.0, 1e-4));
+        }
+    }
+
+    void TestNmeaErrors()
+    {
+        std::string corrupted = Sentence("SDDBT,32.8,f,10.00,M,5.47,F");
+        corrupted[8] = '9';
+
+        const std::string text =
+            corrupted +
+            "$SDMTW,15" + Sentence("SDMTW,15.5,C") +     // truncated by the next "$"
+            "$SDMTW,15.5,C\r\n" +                        // no checksum
+            Sentence("PEOFE,1,2") +                      // proprietary
+            Sentence("SDGGA,1,2") +                      // not supported
+            Sentence("SDDBT,x,f,10.00,M,5.47,F") +       // bad field
+            "noise" + Sentence("SDDPT,1.0,0.0");
+
+        NmeaParser parser;
+        std::vector<EchosounderNmeaRecord> records;
+        FeedAll(parser, text, 7, records);
+
+        CHECK(2 == records.size());
+        CHECK((2 == records.size()) && (NmeaMTW == records[0].sentence) && (NmeaDPT == records[1].sentence));
+        CHECK((2 == records.size()) && std::isnan(records[1].data.dpt.max_range_m));
+
+        EchosounderNmeaStatistics statistics;
+        parser.GetStatistics(statistics);
+        CHECK(2 == statistics.sentences);
+        CHECK(1 == statistics.checksum_errors);
+        CHECK(3 == statistics.malformed);
+        CHECK(2 == statistics.unsupported);
+    }
+
+}
+
+int main()
+{
+    TestNmeaSentences();
+    TestNmeaSplit();
+    TestNmeaErrors();
+
+    return TestResult();
+}
@@ -0,0 +1,143 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Reactor tests.
+// Serves several simulators from one reactor thread, checks data and asynchronous commands
+// of each, and that a simulator which exits fails only its own commands. Linux only.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EchosounderReactor.h"
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define UNITS 3
+#define BUFFER_SIZE (1U << 16)
+#define WAIT_LIMIT_MS 5000
+#define FAIL_LIMIT_MS 500
+
+namespace
+{
+    int Wait(std::future<int> Result, int64_t LimitMs = WAIT_LIMIT_MS)
+    {
+        if (std::future_status::ready != Result.wait_for(std::chrono::milliseconds(LimitMs)))
+        {
+            return -100;
+        }
+
+        return Result.get();
+    }
+
+    void TestReactor(const std::string &Simulator)
+    {
+        std::vector<std::unique_ptr<SimulatorProcess>> sims;
+        std::vector<std::unique_ptr<SingleEchosounder>> sonars;
+        EchosounderReactor reactor;
+
+        for (int i = 0; i < UNITS; i++)
+        {
+            sims.emplace_back(new SimulatorProcess(Simulator, { "--rate", "50" }));
+            sonars.emplace_back(new SingleEchosounder(sims.back()->Open()));
+            CHECK(sonars.back()->IsDetected());
+            CHECK(reactor.Register(*sonars.back(), BUFFER_SIZE));
+        }
+
+        CHECK(false == reactor.Register(*sonars[0], BUFFER_SIZE));
+
+        for (auto &sonar : sonars)
+        {
+            CHECK(1 == Wait(sonar->StartAsync()));
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        for (auto &sonar : sonars)
+        {
+            uint8_t buffer[256];
+            EchosounderNmeaRecord record;
+
+            CHECK(sonar->ReadData(buffer, sizeof(buffer), 1000) > 0);
+            CHECK(sonar->ReadRecord(record));
+
+            // Port belongs to the reactor, synchronous commands are refused
+            CHECK(false == sonar->SetValue(IdRange, "20000"));
+        }
+
+        // Commands of all units are in flight at the same time
+        std::vector<std::future<int>> results;
+
+        for (std::size_t i = 0; i < sonars.size(); i++)
+        {
+            results.push_back(sonars[i]->SetValueAsync(IdRange, std::to_string(10000 + i * 1000)));
+        }
+
+        for (std::future<int> &result : results)
+        {
+            CHECK(1 == Wait(std::move(result)));
+        }
+
+        for (std::size_t i = 0; i < sonars.size(); i++)
+        {
+            CHECK(std::to_string(10000 + i * 1000) == sonars[i]->GetValue(IdRange));
+            CHECK(1 == Wait(sonars[i]->StopAsync()));
+            CHECK(false == sonars[i]->IsRunning());
+        }
+
+        // Unregistered echosounder takes synchronous commands again
+        for (auto &sonar : sonars)
+        {
+            CHECK(reactor.Unregister(*sonar));
+            CHECK(sonar->SetValue(IdRange, "30000"));
+        }
+
+        CHECK(false == reactor.Unregister(*sonars[0]));
+    }
+
+    void TestReactorHangUp(const std::string &Simulator)
+    {
+        std::unique_ptr<SimulatorProcess> lost(new SimulatorProcess(Simulator, { "--rate", "50" }));
+        SimulatorProcess kept(Simulator, { "--rate", "50" });
+        SingleEchosounder first(lost->Open());
+        SingleEchosounder second(kept.Open());
+        EchosounderReactor reactor;
+
+        CHECK(reactor.Register(first, BUFFER_SIZE));
+        CHECK(reactor.Register(second, BUFFER_SIZE));
+        CHECK(1 == Wait(first.StartAsync()));
+        CHECK(1 == Wait(second.StartAsync()));
+
+        lost.reset();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // Commands of the lost port fail at once, the other port is still served
+        const auto begin = std::chrono::steady_clock::now();
+        CHECK(-2 == Wait(first.SetValueAsync(IdRange, "20000")));
+        CHECK(std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(FAIL_LIMIT_MS));
+
+        CHECK(1 == Wait(second.SetValueAsync(IdRange, "20000")));
+        CHECK(1 == Wait(second.StopAsync()));
+
+        CHECK(reactor.Unregister(first));
+        CHECK(reactor.Unregister(second));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestReactor(argv[1]);
+    TestReactorHangUp(argv[1]);
+
+    return TestResult();
+}
@@ -0,0 +1,99 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Recording tests.
+// Writes a recording of several segments and seeks to every data entry.
+// Optional argument is the directory for temporary recordings, the current one by default.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "EchosounderCommandTable.h"
+#include "RecordingReader.h"
+#include "RecordingWriter.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestRecordingSeek(const std::string &Directory)
+    {
+        const std::string path = Directory + "/recording_tests";
+        const int count = 3000;
+        const int64_t step = 1000;
+
+        {
+            RecordingWriter writer(8U << 20);
+            std::vector<uint8_t> payload(1000, 0);
+
+            // Minimum segment size, so the entries take several segments
+            CHECK(writer.Open(path, 1U << 20, [] { return std::string("2 #range 30000\n"); }));
+
+            for (int i = 0; i < count; i++)
+            {
+                memcpy(payload.data(), &i, sizeof(i));
+                CHECK(writer.Append(RecordingData, 1000000LL + i * step, payload.data(), payload.size()));
+            }
+
+            writer.Close();
+
+            EchosounderRecordingStatistics statistics;
+            writer.GetStatistics(statistics);
+            CHECK(static_cast<uint64_t>(count) < statistics.entries);
+            CHECK(0 == statistics.dropped);
+            CHECK(statistics.segments >= 3);
+            CHECK(0 == statistics.failed);
+        }
+
+        RecordingReader reader;
+        int64_t begin = 0;
+        int64_t end = 0;
+
+        CHECK(reader.Open(path));
+        CHECK(reader.GetTimeRange(begin, end));
+        CHECK((count - 1) * step == end - begin);
+
+        // Every data entry, including the first ones of each segment, is found by its time
+        for (int i = 0; i < count; i += 7)
+        {
+            EchosounderRecordingEntry entry;
+            std::string value;
+            int number = -1;
+
+            CHECK(reader.Seek(begin + i * step - step / 2));
+
+            while ((false != reader.Read(entry)) && (RecordingData != entry.type))
+            {
+
+            }
+
+            memcpy(&number, entry.data, sizeof(number));
+            CHECK(i == number);
+            CHECK(begin + i * step == entry.time_us);
+            CHECK(reader.GetValue(IdRange, value) && ("30000" == value));
+        }
+
+        EchosounderRecordingEntry entry;
+        CHECK(reader.Seek(begin - 1000000LL));
+        CHECK(reader.Read(entry) && (begin == entry.time_us));
+        CHECK(false == reader.Seek(end + 1));
+        CHECK(false == reader.Read(entry));
+
+        reader.Close();
+
+        for (uint32_t segment = 0; 0 == unlink(RecordingSegmentPath(path, segment).c_str()); segment++)
+        {
+
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    TestRecordingSeek((argc > 1) ? argv[1] : ".");
+
+    return TestResult();
+}
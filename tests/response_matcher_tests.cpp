@@ -0,0 +1,90 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// ResponseMatcher tests.
+// Checks that response tokens are found at every split of the input.
+
+#include <algorithm>
+#include <string>
+
+#include "ResponseMatcher.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    int MatchAll(ResponseMatcher &Matcher, const std::string &Text, std::size_t Chunk, uint32_t Mask, std::size_t &Consumed)
+    {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(Text.data());
+
+        Consumed = 0;
+
+        for (std::size_t offset = 0; offset < Text.size(); offset += Chunk)
+        {
+            std::size_t consumed = 0;
+            const int token = Matcher.Feed(data + offset, std::min(Chunk, Text.size() - offset), Mask, consumed);
+
+            Consumed = offset + consumed;
+
+            if (token >= 0)
+            {
+                return token;
+            }
+        }
+
+        return -1;
+    }
+
+    void TestResponseMatcher()
+    {
+        struct Case
+        {
+            const char *text;
+            uint32_t mask;
+            int token;
+            std::size_t consumed;
+        };
+
+        const Case cases[] =
+        {
+            { "#range 1000\r\nOK\r\n>", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenOk, 17 },
+            { "#go\r\nOK go\r\n>", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenOkGo, 12 },
+            { "#rnge\r\nInvalid command\r\n>", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenInvalidCommand, 24 },
+            { "#range x\r\nInvalid argument\r\n>", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenInvalidArgument, 28 },
+            { "$SDDBT,1,f,2,M,3,F*00\r\n>OK\r\n", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenOk, 28 },
+            { "OK\r\n\r\n>rest", ResponseMatcher::PromptTokens, ResponseMatcher::TokenPrompt, 7 },
+            { "OOK\r\n", ResponseMatcher::ResponseTokens, ResponseMatcher::TokenOk, 5 },
+            { "OK go", ResponseMatcher::ResponseTokens, -1, 5 },
+            { "Invalid\r\n", ResponseMatcher::ResponseTokens, -1, 9 }
+        };
+
+        for (const Case &item : cases)
+        {
+            const std::string text = item.text;
+
+            // Tokens split across Feed() calls are found the same way
+            for (std::size_t chunk = 1; chunk <= text.size(); chunk++)
+            {
+                ResponseMatcher matcher;
+                std::size_t consumed = 0;
+                const int token = MatchAll(matcher, text, chunk, item.mask, consumed);
+
+                CHECK(item.token == token);
+                CHECK(item.consumed == consumed);
+            }
+        }
+
+        // Partial token is kept until Reset()
+        ResponseMatcher matcher;
+        std::size_t consumed = 0;
+        CHECK(-1 == MatchAll(matcher, "O", 1, ResponseMatcher::ResponseTokens, consumed));
+        matcher.Reset();
+        CHECK(-1 == MatchAll(matcher, "K\r\n", 1, ResponseMatcher::ResponseTokens, consumed));
+    }
+}
+
+int main()
+{
+    TestResponseMatcher();
+
+    return TestResult();
+}
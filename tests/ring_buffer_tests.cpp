@@ -0,0 +1,233 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// RingBuffer and SpscQueue tests.
+// Checks capacity, wrap around and ordering with one producer and one consumer thread.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "PowerOfTwo.h"
+#include "RingBuffer.h"
+#include "SpscQueue.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestRoundUp()
+    {
+        CHECK(1 == RoundUpToPowerOfTwo(0));
+        CHECK(1 == RoundUpToPowerOfTwo(1));
+        CHECK(128 == RoundUpToPowerOfTwo(100));
+        CHECK(4096 == RoundUpToPowerOfTwo(4096));
+        CHECK(8192 == RoundUpToPowerOfTwo(4097));
+    }
+
+    void TestRingBuffer()
+    {
+        RingBuffer ring(100);
+        uint8_t data[256];
+        uint8_t out[256];
+
+        for (std::size_t i = 0; i < sizeof(data); i++)
+        {
+            data[i] = static_cast<uint8_t>(i);
+        }
+
+        CHECK(128 == ring.Capacity());
+        CHECK(0 == ring.Size());
+
+        // Full ring takes only the free space
+        CHECK(100 == ring.Write(data, 100));
+        CHECK(28 == ring.Write(data + 100, 50));
+        CHECK(0 == ring.Write(data, 1));
+        CHECK(128 == ring.Size());
+
+        CHECK(96 == ring.Read(out, 96));
+        CHECK(0 == memcmp(out, data, 96));
+
+        // Written bytes wrap around the end of the storage
+        CHECK(64 == ring.Write(data + 128, 64));
+
+        DataView view;
+        CHECK(96 == ring.Peek(view));
+        CHECK((32 == view.first_size) && (64 == view.second_size));
+        CHECK(0 == memcmp(view.first, data + 96, 32));
+        CHECK(0 == memcmp(view.second, data + 128, 64));
+
+        // Peek does not take bytes out, Consume is limited to the available bytes
+        CHECK(96 == ring.Size());
+        ring.Consume(40);
+        CHECK(56 == ring.Size());
+        CHECK(56 == ring.Peek(view));
+        CHECK((56 == view.first_size) && (0 == view.second_size));
+        CHECK(0 == memcmp(view.first, data + 136, 56));
+        ring.Consume(1000);
+        CHECK(0 == ring.Size());
+        CHECK(0 == ring.Read(out, sizeof(out)));
+    }
+
+    void TestRingBufferThreads()
+    {
+        const std::size_t total = 1U << 20;
+        RingBuffer ring(4096);
+        bool ordered = true;
+
+        std::thread producer([&ring, total]()
+        {
+            uint8_t chunk[777];
+            std::size_t written = 0;
+
+            while (written < total)
+            {
+                const std::size_t size = std::min(sizeof(chunk), total - written);
+
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    chunk[i] = static_cast<uint8_t>((written + i) % 251);
+                }
+
+                std::size_t offset = 0;
+
+                while (offset < size)
+                {
+                    const std::size_t bw = ring.Write(chunk + offset, size - offset);
+
+                    if (0 == bw)
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    offset += bw;
+                }
+
+                written += size;
+            }
+        });
+
+        std::size_t read = 0;
+        uint8_t buffer[1000];
+        bool peek = false;
+
+        while (read < total)
+        {
+            if (0 == ring.Size())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Read and Peek/Consume alternate on the consumer side
+            peek = !peek;
+
+            if (false == peek)
+            {
+                const std::size_t br = ring.Read(buffer, sizeof(buffer));
+
+                for (std::size_t i = 0; i < br; i++)
+                {
+                    ordered = ordered && (buffer[i] == static_cast<uint8_t>((read + i) % 251));
+                }
+
+                read += br;
+            }
+            else
+            {
+                DataView view;
+                const std::size_t count = ring.Peek(view);
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    const uint8_t value = (i < view.first_size) ? view.first[i] : view.second[i - view.first_size];
+                    ordered = ordered && (value == static_cast<uint8_t>((read + i) % 251));
+                }
+
+                ring.Consume(count);
+                read += count;
+            }
+        }
+
+        producer.join();
+
+        CHECK(true == ordered);
+        CHECK(0 == ring.Size());
+    }
+
+    void TestSpscQueue()
+    {
+        SpscQueue<int> queue(5);
+        int item = -1;
+
+        CHECK(false == queue.Pop(item));
+
+        for (int i = 0; i < 8; i++)
+        {
+            CHECK(queue.Push(i));
+        }
+
+        CHECK(false == queue.Push(8));
+        CHECK(8 == queue.Size());
+
+        CHECK(queue.Pop(item) && (0 == item));
+        CHECK(queue.Push(8));
+
+        for (int i = 1; i <= 8; i++)
+        {
+            CHECK(queue.Pop(item) && (i == item));
+        }
+
+        CHECK(false == queue.Pop(item));
+        CHECK(0 == queue.Size());
+    }
+
+    void TestSpscQueueThreads()
+    {
+        const uint32_t total = 1000000;
+        SpscQueue<uint32_t> queue(256);
+        uint32_t expected = 0;
+        bool ordered = true;
+
+        std::thread producer([&queue, total]()
+        {
+            for (uint32_t i = 0; i < total; i++)
+            {
+                while (false == queue.Push(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        while (expected < total)
+        {
+            uint32_t item = 0;
+
+            if (false == queue.Pop(item))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            ordered = ordered && (item == expected);
+            expected++;
+        }
+
+        producer.join();
+
+        CHECK(true == ordered);
+        CHECK(0 == queue.Size());
+    }
+}
+
+int main()
+{
+    TestRoundUp();
+    TestRingBuffer();
+    TestRingBufferThreads();
+    TestSpscQueue();
+    TestSpscQueueThreads();
+
+    return TestResult();
+}
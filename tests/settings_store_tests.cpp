@@ -0,0 +1,103 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// SettingsStore tests.
+// Checks parsing of stored values by the value type of the command and tracking of staged values.
+
+#include <string>
+
+#include "EchosounderCommandTable.h"
+#include "SettingsStore.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+    void TestSettingsValues()
+    {
+        SettingsStore settings(SingleEchosounderCommands);
+        long value = 0;
+        float number = 0.0F;
+
+        // Nothing is known before the first value is stored
+        CHECK(true == settings.GetText(IdRange).empty());
+        CHECK(false == settings.GetLong(IdRange, value));
+
+        CHECK(ValueInteger == settings.GetType(IdRange));
+        CHECK(ValueFloat == settings.GetType(IdInterval));
+        CHECK(ValueText == settings.GetType(IdVersion));
+        CHECK(ValueNone == settings.GetType(IdGainL));
+
+        CHECK(settings.Set(IdRange, "30000"));
+        CHECK(settings.GetLong(IdRange, value) && (30000 == value));
+        CHECK(settings.GetFloat(IdRange, number) && Near(number, 30000.0, 1e-3));
+        CHECK("30000" == settings.GetText(IdRange));
+
+        // Decimals are truncated by the integer getter
+        CHECK(settings.Set(IdInterval, "-1.75"));
+        CHECK(settings.GetFloat(IdInterval, number) && Near(number, -1.75, 1e-6));
+        CHECK(settings.GetLong(IdInterval, value) && (-1 == value));
+        CHECK(settings.Set(IdInterval, ".140"));
+        CHECK(settings.GetFloat(IdInterval, number) && Near(number, 0.14, 1e-6));
+
+        // Integer commands take no fraction, invalid text is kept but is not numeric
+        CHECK(false == settings.Set(IdRange, "1.5"));
+        CHECK("1.5" == settings.GetText(IdRange));
+        CHECK(false == settings.GetLong(IdRange, value));
+        CHECK(false == settings.Set(IdNMEADBT, "on"));
+        CHECK(false == settings.GetLong(IdNMEADBT, value));
+        CHECK(false == settings.Set(IdRange, ""));
+
+        CHECK(settings.Set(IdVersion, "1.05"));
+        CHECK("1.05" == settings.GetText(IdVersion));
+        CHECK(false == settings.GetFloat(IdVersion, number));
+
+        // Ids out of range are refused
+        const EchosounderCommandIds invalid = static_cast<EchosounderCommandIds>(EchosounderCommandCount);
+        CHECK(false == settings.Set(invalid, "1"));
+        CHECK(true == settings.GetText(invalid).empty());
+        CHECK(false == settings.GetLong(invalid, value));
+        CHECK(ValueNone == settings.GetType(invalid));
+    }
+
+    void TestSettingsDirty()
+    {
+        SettingsStore settings(DualEchosounderCommands);
+        const uint64_t range = uint64_t(1) << IdRange;
+        const uint64_t gain = uint64_t(1) << IdGainL;
+
+        CHECK(0 == settings.GetDirty());
+
+        settings.Set(IdRange, "30000");
+        settings.Set(IdGainL, "0.140");
+
+        // Staged value is dirty only while it differs from the confirmed one
+        CHECK(settings.Stage(IdRange, "20000"));
+        CHECK(range == settings.GetDirty());
+        CHECK(settings.Stage(IdGainL, "1.5"));
+        CHECK((range | gain) == settings.GetDirty());
+        CHECK(settings.Stage(IdRange, "30000"));
+        CHECK(gain == settings.GetDirty());
+
+        // Confirmed value clears the entry
+        CHECK(settings.Set(IdGainL, "1.5"));
+        CHECK(0 == settings.GetDirty());
+
+        // Numbers are compared by value, other text as it is
+        CHECK(settings.Set(IdGainL, "0.140"));
+        CHECK(true == settings.Matches(IdGainL, "0.14"));
+        CHECK(false == settings.Matches(IdGainL, "0.15"));
+        CHECK(true == settings.Matches(IdRange, "+30000"));
+        CHECK(false == settings.Matches(IdRange, "30001"));
+        CHECK(settings.Set(IdVersion, "1.05"));
+        CHECK(true == settings.Matches(IdVersion, "1.05"));
+        CHECK(false == settings.Matches(IdVersion, "1.050"));
+    }
+}
+
+int main()
+{
+    TestSettingsValues();
+    TestSettingsDirty();
+
+    return TestResult();
+}
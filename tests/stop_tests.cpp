@@ -0,0 +1,68 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Stop tests.
+// Stops the running simulator by a single break-in, with and without streaming mode
+// and with garbage in its output, and checks the echosounder takes commands afterwards.
+
+#include <cstdint>
+#include <string>
+
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define STOP_LIMIT_US 500000
+#define CYCLES 5
+
+namespace
+{
+    void TestStop(const std::string &Simulator, const std::vector<std::string> &Options, bool Streaming)
+    {
+        SimulatorProcess sim(Simulator, Options);
+        CHECK(false == sim.GetPath().empty());
+
+        SingleEchosounder sonar(sim.Open());
+        CHECK(sonar.IsDetected());
+
+        if (false != Streaming)
+        {
+            CHECK(sonar.StartStreaming(1U << 16));
+        }
+
+        for (int i = 0; i < CYCLES; i++)
+        {
+            uint8_t buffer[256];
+
+            sonar.Start();
+            CHECK(sonar.IsRunning());
+            CHECK(sonar.ReadData(buffer, sizeof(buffer), 2000) > 0);
+
+            sonar.Stop();
+            CHECK(false == sonar.IsRunning());
+
+            // Break-in is answered at once, the full detection would take longer
+            const int64_t latency = sonar.GetStopLatency();
+            CHECK((latency >= 0) && (latency < STOP_LIMIT_US));
+
+            const std::string range = (0 == (i & 1)) ? "20000" : "30000";
+            CHECK(sonar.SetValue(IdRange, range));
+            CHECK(range == sonar.GetValue(IdRange));
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestStop(argv[1], { "--rate", "20" }, false);
+    TestStop(argv[1], { "--rate", "50" }, true);
+    TestStop(argv[1], { "--rate", "50", "--garbage", "0.2" }, false);
+
+    return TestResult();
+}
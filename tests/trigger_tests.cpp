@@ -0,0 +1,82 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Triggered acquisition tests.
+// Fires single pings on the dual frequency simulator and checks their records and latency,
+// and that the single frequency echosounder without #pingonce refuses to arm.
+
+#include <cstdint>
+#include <string>
+
+#include "DualEchosounder.h"
+#include "SingleEchosounder.h"
+
+#include "SimulatorProcess.h"
+#include "TestCheck.h"
+
+#define PINGS 10
+#define PING_LIMIT_US 1000000
+
+namespace
+{
+    void TestTriggerUnsupported(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--rate", "50" });
+        SingleEchosounder sonar(sim.Open());
+        EchosounderPing ping;
+
+        CHECK(false == sonar.ArmTrigger());
+        CHECK(false == sonar.IsTriggerArmed());
+        CHECK(2 == sonar.Trigger(ping));
+    }
+
+    void TestTrigger(const std::string &Simulator)
+    {
+        SimulatorProcess sim(Simulator, { "--dual", "--rate", "50" });
+        DualEchosounder sonar(sim.Open());
+        EchosounderPing ping;
+
+        CHECK(sonar.IsDetected());
+        CHECK(2 == sonar.Trigger(ping));
+
+        CHECK(sonar.ArmTrigger());
+        CHECK(sonar.IsTriggerArmed());
+
+        // Echosounder is back at the command prompt after every ping
+        for (int i = 0; i < PINGS; i++)
+        {
+            CHECK(1 == sonar.Trigger(ping));
+            CHECK(ping.count > 0);
+            CHECK((ping.latency_us > 0) && (ping.latency_us < PING_LIMIT_US));
+            CHECK(false == sonar.IsRunning());
+        }
+
+        CHECK(sonar.SetValue(IdRange, "20000"));
+        CHECK(1 == sonar.Trigger(ping));
+
+        // Continuous output again after disarming
+        CHECK(sonar.DisarmTrigger());
+        CHECK(false == sonar.IsTriggerArmed());
+
+        uint8_t buffer[256];
+
+        sonar.Start();
+        CHECK(sonar.IsRunning());
+        CHECK(sonar.ReadData(buffer, sizeof(buffer), 2000) > 0);
+        sonar.Stop();
+        CHECK(false == sonar.IsRunning());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s SIMULATOR\n", argv[0]);
+        return 1;
+    }
+
+    TestTriggerUnsupported(argv[1]);
+    TestTrigger(argv[1]);
+
+    return TestResult();
+}
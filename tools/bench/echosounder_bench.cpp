@@ -0,0 +1,524 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Echosounder API benchmark.
+// Measures control path latencies and data path throughput against a port,
+// by default against echosounder_sim started from the same directory, or
+// parsing throughput of a recording played back as fast as possible, and
+// prints the results as JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Echosounder.h"
+#include "SingleEchosounder.h"
+#include "DualEchosounder.h"
+#include "PosixTransport.h"
+#include "ReplayTransport.h"
+#include "NmeaParser.h"
+
+#if !defined(BENCH_GIT_COMMIT)
+#define BENCH_GIT_COMMIT "unknown"
+#endif
+
+namespace
+{
+    struct Options
+    {
+        std::string port;
+        std::string sim;
+        std::string replay;
+        bool dual;
+        uint32_t baudrate;
+        int iterations;
+        double duration_s;
+        double sim_rate_hz;
+
+        Options() :
+            dual(false),
+            baudrate(115200U),
+            iterations(20),
+            duration_s(5.0),
+            sim_rate_hz(200.0)
+        {
+
+        }
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double MicrosecondsSince(Clock::time_point Begin)
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - Begin).count();
+    }
+
+    std::string LatencyJson(std::vector<double> Samples)
+    {
+        char text[256];
+
+        if (true == Samples.empty())
+        {
+            return "null";
+        }
+
+        std::sort(Samples.begin(), Samples.end());
+
+        double sum = 0.0;
+        for (double sample : Samples)
+        {
+            sum += sample;
+        }
+
+        const auto percentile = [&Samples](double p)
+        {
+            const std::size_t index = static_cast<std::size_t>(p * static_cast<double>(Samples.size() - 1) + 0.5);
+            return Samples[index];
+        };
+
+        snprintf(text, sizeof(text),
+                 "{\"count\": %zu, \"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f, \"mean\": %.1f}",
+                 Samples.size(), Samples.front(), percentile(0.50), percentile(0.90), percentile(0.99), Samples.back(),
+                 sum / static_cast<double>(Samples.size()));
+
+        return text;
+    }
+
+    /**
+    *   Starts the simulator and returns its pseudo-terminal path, empty string in case of failure
+    */
+    std::string StartSimulator(const Options &BenchOptions, pid_t &Pid)
+    {
+        int fds[2];
+
+        if (0 != pipe(fds))
+        {
+            return "";
+        }
+
+        const std::string rate = std::to_string(BenchOptions.sim_rate_hz);
+
+        Pid = fork();
+
+        if (0 == Pid)
+        {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+
+            if (false != BenchOptions.dual)
+            {
+                execl(BenchOptions.sim.c_str(), BenchOptions.sim.c_str(), "--dual", "--rate", rate.c_str(), static_cast<char *>(nullptr));
+            }
+            else
+            {
+                execl(BenchOptions.sim.c_str(), BenchOptions.sim.c_str(), "--rate", rate.c_str(), static_cast<char *>(nullptr));
+            }
+
+            _exit(127);
+        }
+
+        close(fds[1]);
+
+        std::string path;
+        char ch;
+
+        while ((1 == read(fds[0], &ch, 1)) && ('\n' != ch))
+        {
+            path.push_back(ch);
+        }
+
+        close(fds[0]);
+
+        return path;
+    }
+
+    void Usage(const char *Name)
+    {
+        fprintf(stderr,
+                "Usage: %s [--port PATH | --sim PATH | --replay PATH] [--dual] [--baudrate N] [--iterations N] [--duration S] [--sim-rate HZ]\n"
+                "  --port PATH      benchmark given port instead of starting the simulator\n"
+                "  --sim PATH       simulator executable, default echosounder_sim next to this program\n"
+                "  --replay PATH    only measure parsing of a recording (EchosounderStartRecording path)\n"
+                "  --dual           use dual frequency echosounder\n"
+                "  --iterations N   samples per control path operation (default 20)\n"
+                "  --duration S     seconds per data path measurement (default 5)\n"
+                "  --sim-rate HZ    simulator ping rate (default 200)\n",
+                Name);
+    }
+
+    struct Throughput
+    {
+        double bytes_per_s;
+        double sentences_per_s;
+    };
+
+    /**
+    *   Feeds typical echosounder output through NmeaParser on this thread
+    */
+    Throughput MeasureParser(double DurationS)
+    {
+        const std::string sample =
+            "$SDDBT,48.1,f,14.67,M,8.0,F*37\r\n"
+            "$SDDPT,14.67,0.0*53\r\n"
+            "$SDEMA,14.67,62*70\r\n"
+            "$SDMTW,15.1,C*01\r\n"
+            "$SDXDR,A,1.3,D,PTCH,A,0.4,D,ROLL,C,15.1,C,TEMP*5A\r\n"
+            "$SDZDA,123456.78,17,10,2026,00,00*6F\r\n";
+
+        std::string input;
+        while (input.size() < 65536U)
+        {
+            input += sample;
+        }
+
+        NmeaParser parser;
+        uint64_t bytes = 0;
+        uint64_t sentences = 0;
+
+        const auto begin = Clock::now();
+        const auto end = begin + std::chrono::microseconds(static_cast<int64_t>(DurationS * 1e6));
+
+        while (Clock::now() < end)
+        {
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(input.data());
+            std::size_t size = input.size();
+
+            while (size > 0)
+            {
+                bool complete = false;
+                const std::size_t consumed = parser.Feed(data, size, complete);
+
+                sentences += (false != complete) ? 1U : 0U;
+                data += consumed;
+                size -= consumed;
+            }
+
+            bytes += input.size();
+        }
+
+        const double elapsed = MicrosecondsSince(begin) / 1e6;
+        Throughput result = { static_cast<double>(bytes) / elapsed, static_cast<double>(sentences) / elapsed };
+
+        return result;
+    }
+
+    Throughput MeasureReadData(Echosounder &Sounder, double DurationS)
+    {
+        uint8_t buffer[4096];
+        uint64_t bytes = 0;
+        uint64_t sentences = 0;
+
+        const auto begin = Clock::now();
+        const auto end = begin + std::chrono::microseconds(static_cast<int64_t>(DurationS * 1e6));
+
+        while (Clock::now() < end)
+        {
+            const std::size_t br = Sounder.ReadData(buffer, sizeof(buffer), 100);
+
+            bytes += br;
+            sentences += static_cast<uint64_t>(std::count(buffer, buffer + br, static_cast<uint8_t>('\n')));
+        }
+
+        const double elapsed = MicrosecondsSince(begin) / 1e6;
+        Throughput result = { static_cast<double>(bytes) / elapsed, static_cast<double>(sentences) / elapsed };
+
+        return result;
+    }
+
+    /**
+    *   Plays a recording as fast as possible through ReadData() and takes the parsed records
+    */
+    Throughput MeasureReplay(Echosounder &Sounder, ReplayTransport &Replay, uint64_t &Bytes, uint64_t &Records)
+    {
+        uint8_t buffer[4096];
+        EchosounderNmeaRecord record;
+
+        Bytes = 0;
+        Records = 0;
+
+        const auto begin = Clock::now();
+        Replay.Play();
+
+        while (false == Replay.IsFinished())
+        {
+            Bytes += Sounder.ReadData(buffer, sizeof(buffer), 0);
+
+            while (false != Sounder.ReadRecord(record))
+            {
+                Records++;
+            }
+        }
+
+        // Records parsed by the last read
+        while (false != Sounder.ReadRecord(record))
+        {
+            Records++;
+        }
+
+        const double elapsed = MicrosecondsSince(begin) / 1e6;
+        Throughput result = { static_cast<double>(Bytes) / elapsed, static_cast<double>(Records) / elapsed };
+
+        return result;
+    }
+
+    int RunReplay(const Options &BenchOptions)
+    {
+        std::shared_ptr<ReplayTransport> replay;
+        std::unique_ptr<Echosounder> sounder;
+
+        try
+        {
+            replay = std::make_shared<ReplayTransport>(BenchOptions.replay, 0.0);
+
+            if (false != BenchOptions.dual)
+            {
+                sounder.reset(new DualEchosounder(replay, nullptr));
+            }
+            else
+            {
+                sounder.reset(new SingleEchosounder(replay, nullptr));
+            }
+        }
+        catch (const std::exception &e)
+        {
+            fprintf(stderr, "Can not replay %s: %s\n", BenchOptions.replay.c_str(), e.what());
+            return 1;
+        }
+
+        uint64_t bytes = 0;
+        uint64_t records = 0;
+        const Throughput parsing = MeasureReplay(*sounder, *replay, bytes, records);
+
+        printf("{\n");
+        printf("  \"library\": \"echosounderapi\",\n");
+        printf("  \"commit\": \"%s\",\n", BENCH_GIT_COMMIT);
+        printf("  \"model\": \"%s\",\n", (false != BenchOptions.dual) ? "dual" : "single");
+        printf("  \"replay\": \"%s\",\n", BenchOptions.replay.c_str());
+        printf("  \"throughput\": {\n");
+        printf("    \"replay\": {\"bytes\": %llu, \"records\": %llu, \"bytes_per_s\": %.1f, \"records_per_s\": %.1f}\n",
+               static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(records), parsing.bytes_per_s, parsing.sentences_per_s);
+        printf("  }\n");
+        printf("}\n");
+
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasvalue = (i + 1) < argc;
+
+        if (("--port" == arg) && (false != hasvalue))
+        {
+            options.port = argv[++i];
+        }
+        else if (("--sim" == arg) && (false != hasvalue))
+        {
+            options.sim = argv[++i];
+        }
+        else if (("--replay" == arg) && (false != hasvalue))
+        {
+            options.replay = argv[++i];
+        }
+        else if ("--dual" == arg)
+        {
+            options.dual = true;
+        }
+        else if (("--baudrate" == arg) && (false != hasvalue))
+        {
+            options.baudrate = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (("--iterations" == arg) && (false != hasvalue))
+        {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (("--duration" == arg) && (false != hasvalue))
+        {
+            options.duration_s = std::atof(argv[++i]);
+        }
+        else if (("--sim-rate" == arg) && (false != hasvalue))
+        {
+            options.sim_rate_hz = std::atof(argv[++i]);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (false == options.replay.empty())
+    {
+        return RunReplay(options);
+    }
+
+    pid_t simpid = -1;
+
+    if (true == options.port.empty())
+    {
+        if (true == options.sim.empty())
+        {
+            const std::string self = argv[0];
+            const std::size_t slash = self.rfind('/');
+            options.sim = ((std::string::npos == slash) ? std::string(".") : self.substr(0, slash)) + "/echosounder_sim";
+        }
+
+        options.port = StartSimulator(options, simpid);
+
+        if (true == options.port.empty())
+        {
+            fprintf(stderr, "Can not start simulator %s\n", options.sim.c_str());
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Echosounder> sounder;
+    std::vector<double> open_us;
+
+    try
+    {
+        const auto begin = Clock::now();
+        std::shared_ptr<ITransport> transport = std::make_shared<PosixTransport>(options.port, options.baudrate);
+
+        if (false != options.dual)
+        {
+            sounder.reset(new DualEchosounder(transport));
+        }
+        else
+        {
+            sounder.reset(new SingleEchosounder(transport));
+        }
+
+        open_us.push_back(MicrosecondsSince(begin));
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "Can not open %s: %s\n", options.port.c_str(), e.what());
+    }
+
+    if ((nullptr == sounder) || (false == sounder->IsDetected()))
+    {
+        fprintf(stderr, "Echosounder is not detected on %s\n", options.port.c_str());
+
+        if (simpid > 0)
+        {
+            kill(simpid, SIGTERM);
+            waitpid(simpid, nullptr, 0);
+        }
+
+        return 1;
+    }
+
+    std::vector<double> detect_us;
+    std::vector<double> setvalue_us;
+    std::vector<double> getsettings_us;
+    std::vector<double> start_us;
+    std::vector<double> stop_us;
+
+    for (int i = 0; i < options.iterations; i++)
+    {
+        auto begin = Clock::now();
+        sounder->Detect();
+        detect_us.push_back(MicrosecondsSince(begin));
+
+        begin = Clock::now();
+        sounder->SetValue(EchosounderCommandIds::IdRange, (0 == (i % 2)) ? "10000" : "20000");
+        setvalue_us.push_back(MicrosecondsSince(begin));
+
+        begin = Clock::now();
+        sounder->GetSettings();
+        getsettings_us.push_back(MicrosecondsSince(begin));
+
+        begin = Clock::now();
+        sounder->Start();
+        start_us.push_back(MicrosecondsSince(begin));
+
+        begin = Clock::now();
+        sounder->Stop();
+        stop_us.push_back(MicrosecondsSince(begin));
+    }
+
+    // Single ping mode is available on dual frequency echosounders only
+    std::vector<double> trigger_us;
+    std::vector<double> ping_us;
+
+    if (false != sounder->ArmTrigger())
+    {
+        EchosounderPing ping;
+
+        for (int i = 0; i < options.iterations; i++)
+        {
+            const auto begin = Clock::now();
+
+            if (1 == sounder->Trigger(ping))
+            {
+                trigger_us.push_back(MicrosecondsSince(begin));
+                ping_us.push_back(static_cast<double>(ping.latency_us));
+            }
+        }
+
+        sounder->DisarmTrigger();
+    }
+
+    sounder->Start();
+    const Throughput direct = MeasureReadData(*sounder, options.duration_s);
+
+    sounder->StartStreaming(1U << 20);
+    const Throughput streaming = MeasureReadData(*sounder, options.duration_s);
+    const uint64_t overrun = sounder->GetOverrunBytes();
+    sounder->StopStreaming();
+
+    sounder->Stop();
+
+    const Throughput parser = MeasureParser(options.duration_s);
+
+    printf("{\n");
+    printf("  \"library\": \"echosounderapi\",\n");
+    printf("  \"commit\": \"%s\",\n", BENCH_GIT_COMMIT);
+    printf("  \"model\": \"%s\",\n", (false != options.dual) ? "dual" : "single");
+    printf("  \"port\": \"%s\",\n", options.port.c_str());
+    printf("  \"simulated\": %s,\n", (simpid > 0) ? "true" : "false");
+    printf("  \"iterations\": %d,\n", options.iterations);
+    printf("  \"latency_us\": {\n");
+    printf("    \"open\": %s,\n", LatencyJson(open_us).c_str());
+    printf("    \"detect\": %s,\n", LatencyJson(detect_us).c_str());
+    printf("    \"set_value\": %s,\n", LatencyJson(setvalue_us).c_str());
+    printf("    \"get_settings\": %s,\n", LatencyJson(getsettings_us).c_str());
+    printf("    \"start\": %s,\n", LatencyJson(start_us).c_str());
+    printf("    \"stop\": %s,\n", LatencyJson(stop_us).c_str());
+    printf("    \"trigger\": %s,\n", LatencyJson(trigger_us).c_str());
+    printf("    \"trigger_to_result\": %s\n", LatencyJson(ping_us).c_str());
+    printf("  },\n");
+    printf("  \"throughput\": {\n");
+    printf("    \"duration_s\": %.1f,\n", options.duration_s);
+    printf("    \"read_data\": {\"bytes_per_s\": %.1f, \"sentences_per_s\": %.1f},\n", direct.bytes_per_s, direct.sentences_per_s);
+    printf("    \"read_data_streaming\": {\"bytes_per_s\": %.1f, \"sentences_per_s\": %.1f, \"overrun_bytes\": %llu},\n",
+           streaming.bytes_per_s, streaming.sentences_per_s, static_cast<unsigned long long>(overrun));
+    printf("    \"nmea_parser\": {\"bytes_per_s\": %.1f, \"sentences_per_s\": %.1f}\n", parser.bytes_per_s, parser.sentences_per_s);
+    printf("  }\n");
+    printf("}\n");
+
+    sounder.reset();
+
+    if (simpid > 0)
+    {
+        kill(simpid, SIGTERM);
+        waitpid(simpid, nullptr, 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,727 @@
+// Copyright (c) EofE Ultrasonics Co., Ltd., 2024
+//
+// Echosounder firmware simulator.
+// Opens a pseudo-terminal and emulates the command interface and NMEA output of
+// a single or dual frequency echosounder, so the library can be exercised without hardware.
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    enum ValueKind
+    {
+        KindInteger,
+        KindFloat
+    };
+
+    struct SimParameter
+    {
+        const char *command;
+        const char *info_name;
+        const char *unit;
+        ValueKind kind;
+        double min_value;
+        double max_value;
+        const char *value;
+    };
+
+    // Parameters as reported by #info, unit is printed after the value inside brackets
+    const SimParameter SingleParameters[] =
+    {
+        { "#range",      "#range",      "mm",   KindInteger, 100,   100000,     "50000" },
+        { "#interval",   "#interval",   "sec",  KindFloat,   0.05,  100,        "0.1" },
+        { "#txlength",   "#txlength",   "uks",  KindInteger, 1,     1000,       "50" },
+        { "#gain",       "#gain",       "dB",   KindFloat,   -60,   60,         "0.0" },
+        { "#tvgmode",    "#tvgmode",    "",     KindInteger, 0,     4,          "1" },
+        { "#tvgabs",     "#tvgabs",     "dB/m", KindFloat,   0,     10,         "0.140" },
+        { "#tvgsprd",    "#tvgsprd",    "",     KindFloat,   0,     100,        "15.0" },
+        { "#sound",      "#sound",      "mps",  KindInteger, 1300,  1700,       "1500" },
+        { "#deadzone",   "#deadzone",   "mm",   KindInteger, 0,     100000,     "300" },
+        { "#threshold",  "#threshold",  "%",    KindInteger, 0,     100,        "10" },
+        { "#offset",     "#offset",     "mm",   KindInteger, 0,     100000,     "0" },
+        { "#medianflt",  "#medianflt",  "",     KindInteger, 0,     100,        "2" },
+        { "#movavgflt",  "#movavgflt",  "",     KindInteger, 0,     100,        "1" },
+        { "#nmearate",   "#outrate",    "sec",  KindFloat,   0,     100,        "0.0" },
+        { "#nmeadbt",    "#nmeadbt",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeadpt",    "#nmeadpt",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeadptoff", "#nmeadptoff", "m",    KindFloat,   -100,  100,        "0.0" },
+        { "#nmeadpzero", "#nmeadpzero", "",     KindInteger, 0,     1,          "1" },
+        { "#nmeamtw",    "#nmeamtw",    "",     KindInteger, 0,     1,          "1" },
+        { "#altprec",    "#altprec",    "",     KindInteger, 1,     4,          "3" },
+        { "#nmeaxdr",    "#nmeaxdr",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeaema",    "#nmeaema",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeazda",    "#nmeazda",    "",     KindInteger, 0,     1,          "0" },
+        { "#output",     "#output",     "",     KindInteger, 0,     10,         "3" },
+        { "#time",       "#time",       "",     KindInteger, 0,     4294967295.0, "0" },
+        { "#syncextern", "#syncextern", "",     KindInteger, 0,     1,          "0" },
+        { "#syncextmod", "#syncextmod", "",     KindInteger, 0,     1,          "1" },
+        { "#syncoutpol", "#syncoutpol", "",     KindInteger, 0,     1,          "1" },
+    };
+
+    const SimParameter DualParameters[] =
+    {
+        { "#range",      "#range",      "mm",   KindInteger, 100,   100000,     "50000" },
+        { "#rangeh",     "#rangeh",     "mm",   KindInteger, 100,   100000,     "50000" },
+        { "#rangel",     "#rangel",     "mm",   KindInteger, 100,   100000,     "50000" },
+        { "#interval",   "#interval",   "sec",  KindFloat,   0.05,  100,        "1.0" },
+        { "#pingonce",   "#pingonce",   "",     KindInteger, 0,     1,          "0" },
+        { "#txlength",   "#txlength",   "uks",  KindInteger, 1,     1000,       "50" },
+        { "#txlengthh",  "#txlengthh",  "uks",  KindInteger, 1,     1000,       "50" },
+        { "#txlengthl",  "#txlengthl",  "uks",  KindInteger, 1,     1000,       "100" },
+        { "#txpower",    "#txpower",    "dB",   KindFloat,   -60,   0,          "0.0" },
+        { "#gain",       "#gain",       "dB",   KindFloat,   -60,   60,         "0.0" },
+        { "#gainh",      "#gainh",      "dB",   KindFloat,   -60,   60,         "0.0" },
+        { "#gainl",      "#gainl",      "dB",   KindFloat,   -60,   60,         "0.0" },
+        { "#tvgmode",    "#tvgmode",    "",     KindInteger, 0,     4,          "1" },
+        { "#tvgabs",     "#tvgabs",     "dB/m", KindFloat,   0,     10,         "0.140" },
+        { "#tvgabsh",    "#tvgabsh",    "dB/m", KindFloat,   0,     10,         "0.140" },
+        { "#tvgabsl",    "#tvgabsl",    "dB/m", KindFloat,   0,     10,         "0.060" },
+        { "#tvgsprd",    "#tvgsprd",    "",     KindFloat,   0,     100,        "15.0" },
+        { "#tvgsprdh",   "#tvgsprdh",   "",     KindFloat,   0,     100,        "15.0" },
+        { "#tvgsprdl",   "#tvgsprdl",   "",     KindFloat,   0,     100,        "15.0" },
+        { "#attn",       "#attn",       "uks",  KindInteger, 0,     1000,       "0" },
+        { "#attnh",      "#attnh",      "uks",  KindInteger, 0,     1000,       "0" },
+        { "#attnl",      "#attnl",      "uks",  KindInteger, 0,     1000,       "0" },
+        { "#sound",      "#sound",      "mps",  KindInteger, 1300,  1700,       "1500" },
+        { "#deadzone",   "#deadzone",   "mm",   KindInteger, 0,     100000,     "300" },
+        { "#deadzoneh",  "#deadzoneh",  "mm",   KindInteger, 0,     100000,     "300" },
+        { "#deadzonel",  "#deadzonel",  "mm",   KindInteger, 0,     100000,     "500" },
+        { "#threshold",  "#threshold",  "%",    KindInteger, 0,     100,        "10" },
+        { "#thresholdh", "#thresholdh", "%",    KindInteger, 0,     100,        "10" },
+        { "#thresholdl", "#thresholdl", "%",    KindInteger, 0,     100,        "10" },
+        { "#offset",     "#offset",     "mm",   KindInteger, 0,     100000,     "0" },
+        { "#offseth",    "#offseth",    "mm",   KindInteger, 0,     100000,     "0" },
+        { "#offsetl",    "#offsetl",    "mm",   KindInteger, 0,     100000,     "0" },
+        { "#medianflt",  "#medianflt",  "",     KindInteger, 0,     100,        "2" },
+        { "#movavgflt",  "#movavgflt",  "",     KindInteger, 0,     100,        "1" },
+        { "#nmeadbt",    "#nmeadbt",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeadpt",    "#nmeadpt",    "",     KindInteger, 0,     1,          "0" },
+        { "#nmeamtw",    "#nmeamtw",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeaxdr",    "#nmeaxdr",    "",     KindInteger, 0,     1,          "1" },
+        { "#nmeaema",    "#nmeaema",    "",     KindInteger, 0,     1,          "0" },
+        { "#nmeazda",    "#nmeazda",    "",     KindInteger, 0,     1,          "0" },
+        { "#outrate",    "#nmearate",   "sec",  KindFloat,   0,     100,        "0.0" },
+        { "#nmeadptoff", "#nmeadptoff", "m",    KindFloat,   -100,  100,        "0.0" },
+        { "#nmeadpzero", "#nmeadpzero", "",     KindInteger, 0,     1,          "1" },
+        { "#output",     "#output",     "",     KindInteger, 0,     10,         "3" },
+        { "#altprec",    "#altprec",    "",     KindInteger, 1,     4,          "3" },
+        { "#samplfreq",  "#samplfreq",  "",     KindInteger, 0,     999999,     "0" },
+        { "#time",       "#time",       "",     KindInteger, 0,     4294967295.0, "0" },
+        { "#syncextern", "#syncextern", "",     KindInteger, 0,     1,          "0" },
+        { "#syncextmod", "#syncextmod", "",     KindInteger, 0,     1,          "1" },
+        { "#syncoutpol", "#syncoutpol", "",     KindInteger, 0,     1,          "1" },
+        { "#anlgmode",   "#anlgmode",   "",     KindInteger, 0,     1,          "0" },
+        { "#anlgrate",   "#anlgrate",   "V/m",  KindFloat,   0,     10,         "0.100" },
+        { "#anlgmax",    "#anlgmax",    "",     KindInteger, 1,     4,          "4" },
+    };
+
+    const char *const FirmwareVersion = "1.05";
+    const long HighFrequencyHz = 200000;
+    const long LowFrequencyHz = 30000;
+
+    enum WorkMode
+    {
+        WorkHigh,
+        WorkLow,
+        WorkDual
+    };
+
+    struct Options
+    {
+        bool dual;
+        double rate_hz;
+        int latency_ms;
+        double garbage;
+        std::string link;
+        double drift_ppm;
+
+        Options() :
+            dual(false),
+            rate_hz(0.0),
+            latency_ms(0),
+            garbage(0.0),
+            drift_ppm(0.0)
+        {
+
+        }
+    };
+
+    volatile sig_atomic_t terminate_requested = 0;
+
+    void OnSignal(int)
+    {
+        terminate_requested = 1;
+    }
+
+    void Usage(const char *name)
+    {
+        fprintf(stderr,
+                "Usage: %s [--dual] [--rate HZ] [--latency MS] [--garbage P] [--drift PPM] [--link PATH]\n"
+                "  --dual        emulate dual frequency echosounder (default single)\n"
+                "  --rate HZ     ping rate while running, default is 1 / #interval\n"
+                "  --latency MS  delay before every command response\n"
+                "  --garbage P   probability per ping to inject a burst of random bytes\n"
+                "  --drift PPM   device clock runs faster than the host by PPM parts per million\n"
+                "  --link PATH   create symlink PATH to the pseudo-terminal\n",
+                name);
+    }
+
+    class Simulator
+    {
+        int master_fd_;
+        Options options_;
+
+        std::vector<SimParameter> parameters_;
+        std::vector<std::string> values_;
+
+        bool running_;
+        WorkMode work_mode_;
+        std::string line_;
+
+        std::chrono::steady_clock::time_point next_ping_;
+        uint64_t ping_counter_;
+
+        // Device clock, set by #time: host UTC + offset, drifting since the last #time
+        int64_t time_offset_us_;
+        int64_t time_set_us_;
+
+        std::mt19937 random_;
+
+    public:
+
+        Simulator(int MasterFd, const Options &SimOptions) :
+            master_fd_(MasterFd),
+            options_(SimOptions),
+            running_(false),
+            work_mode_(WorkHigh),
+            ping_counter_(0),
+            time_offset_us_(0),
+            time_set_us_(HostUs()),
+            random_(12345U)
+        {
+            if (false != options_.dual)
+            {
+                parameters_.assign(std::begin(DualParameters), std::end(DualParameters));
+            }
+            else
+            {
+                parameters_.assign(std::begin(SingleParameters), std::end(SingleParameters));
+            }
+
+            for (const auto &parameter : parameters_)
+            {
+                values_.push_back(parameter.value);
+            }
+        }
+
+        void Run()
+        {
+            uint8_t buffer[256];
+
+            while (0 == terminate_requested)
+            {
+                int timeoutms = 100;
+
+                if (false != running_)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(next_ping_ - now).count();
+                    timeoutms = (left > 0) ? static_cast<int>(left) : 0;
+                }
+
+                struct pollfd pfd = { master_fd_, POLLIN, 0 };
+                const int result = poll(&pfd, 1, timeoutms);
+
+                if ((result > 0) && (0 != (pfd.revents & POLLIN)))
+                {
+                    const ssize_t br = read(master_fd_, buffer, sizeof(buffer));
+
+                    for (ssize_t i = 0; i < br; i++)
+                    {
+                        OnByte(buffer[i]);
+                    }
+                }
+
+                if ((false != running_) && (std::chrono::steady_clock::now() >= next_ping_))
+                {
+                    Ping();
+                    next_ping_ += PingPeriod();
+
+                    // Single ping mode returns to the command prompt after the ping
+                    if (false != IsEnabled("#pingonce"))
+                    {
+                        running_ = false;
+                        Send("\r\n>");
+                    }
+                }
+            }
+        }
+
+    private:
+
+        void Send(const std::string &Text)
+        {
+            std::size_t written = 0;
+
+            while (written < Text.size())
+            {
+                const ssize_t bw = write(master_fd_, Text.data() + written, Text.size() - written);
+
+                if (bw > 0)
+                {
+                    written += static_cast<std::size_t>(bw);
+                }
+                else if ((bw < 0) && (EINTR != errno) && (EAGAIN != errno))
+                {
+                    break;
+                }
+            }
+        }
+
+        void OnByte(uint8_t Ch)
+        {
+            if (('\r' == Ch) || ('\n' == Ch))
+            {
+                const std::string line = line_;
+                line_.clear();
+                OnLine(line);
+            }
+            else if (line_.size() < 256)
+            {
+                line_.push_back(static_cast<char>(Ch));
+            }
+        }
+
+        void OnLine(const std::string &Line)
+        {
+            if (false != running_)
+            {
+                // Any input stops the ping loop
+                running_ = false;
+                Send("\r\n>");
+                return;
+            }
+
+            if (true == Line.empty())
+            {
+                Send("\r\n>");
+                return;
+            }
+
+            if (options_.latency_ms > 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(options_.latency_ms));
+            }
+
+            const std::size_t space = Line.find(' ');
+            const std::string command = Line.substr(0, space);
+            const std::string argument = (std::string::npos == space) ? "" : Line.substr(space + 1);
+
+            Send(Execute(command, argument));
+        }
+
+        std::string Execute(const std::string &Command, const std::string &Argument)
+        {
+            if ("#go" == Command)
+            {
+                running_ = true;
+                next_ping_ = std::chrono::steady_clock::now();
+                return "OK go\r\n";
+            }
+
+            if ("#info" == Command)
+            {
+                return Info() + "OK\r\n\r\n>";
+            }
+
+            if ("#speed" == Command)
+            {
+                return "115200\r\nOK\r\n\r\n>";
+            }
+
+            if ("#version" == Command)
+            {
+                return std::string(" S/W Ver: ") + FirmwareVersion + " (sim)\r\nOK\r\n\r\n>";
+            }
+
+            if (false != options_.dual)
+            {
+                if (("#setfh" == Command) || ("#setfl" == Command) || ("#setfd" == Command))
+                {
+                    work_mode_ = ("#setfh" == Command) ? WorkHigh : (("#setfl" == Command) ? WorkLow : WorkDual);
+                    return "OK\r\n\r\n>";
+                }
+
+                if ("#getfh" == Command)
+                {
+                    return "High Frequency: " + std::to_string(HighFrequencyHz) + "Hz\r\nOK\r\n\r\n>";
+                }
+
+                if ("#getfl" == Command)
+                {
+                    return "Low Frequency: " + std::to_string(LowFrequencyHz) + "Hz\r\nOK\r\n\r\n>";
+                }
+
+                if ("#getf" == Command)
+                {
+                    return GetFrequencies() + "OK\r\n\r\n>";
+                }
+            }
+
+            for (std::size_t i = 0; i < parameters_.size(); i++)
+            {
+                if (Command == parameters_[i].command)
+                {
+                    if (false == IsValidArgument(parameters_[i], Argument))
+                    {
+                        return "Invalid argument\r\n\r\n>";
+                    }
+
+                    values_[i] = Argument;
+
+                    if ("#time" == Command)
+                    {
+                        // Whole seconds are set at the moment the command is received
+                        time_set_us_ = HostUs();
+                        time_offset_us_ = std::strtoll(Argument.c_str(), nullptr, 10) * 1000000LL - time_set_us_;
+                    }
+
+                    return "OK\r\n\r\n>";
+                }
+            }
+
+            return "Invalid command\r\n\r\n>";
+        }
+
+        static bool IsValidArgument(const SimParameter &Parameter, const std::string &Argument)
+        {
+            if (true == Argument.empty())
+            {
+                return false;
+            }
+
+            char *end = nullptr;
+            const double value = std::strtod(Argument.c_str(), &end);
+
+            if ((nullptr == end) || ('\0' != *end))
+            {
+                return false;
+            }
+
+            if ((KindInteger == Parameter.kind) && (std::string::npos != Argument.find('.')))
+            {
+                return false;
+            }
+
+            return (value >= Parameter.min_value) && (value <= Parameter.max_value);
+        }
+
+        std::string Info() const
+        {
+            std::string result = "\r\n Echosounder simulator\r\n";
+            result += std::string(" S/W Ver: ") + FirmwareVersion + " (sim)\r\n";
+
+            for (std::size_t i = 0; i < parameters_.size(); i++)
+            {
+                const SimParameter &parameter = parameters_[i];
+                std::string value = values_[i];
+
+                if (0 != strlen(parameter.unit))
+                {
+                    value += std::string(" ") + parameter.unit;
+                }
+
+                result += std::string(" - ") + parameter.info_name + " [ " + value + " ] " + (parameter.info_name + 1) + "\r\n";
+            }
+
+            return result;
+        }
+
+        std::string GetFrequencies() const
+        {
+            std::string high = "High Frequency: " + std::to_string(HighFrequencyHz) + "Hz";
+            std::string low = "Low Frequency: " + std::to_string(LowFrequencyHz) + "Hz";
+
+            if (WorkDual != work_mode_)
+            {
+                ((WorkHigh == work_mode_) ? high : low) += " (Active)";
+            }
+            else
+            {
+                high += " (Active)";
+                low += " (Active)";
+            }
+
+            return high + "\r\n" + low + "\r\n";
+        }
+
+        const std::string &Value(const char *Command) const
+        {
+            static const std::string empty;
+
+            for (std::size_t i = 0; i < parameters_.size(); i++)
+            {
+                if (0 == strcmp(Command, parameters_[i].command))
+                {
+                    return values_[i];
+                }
+            }
+
+            return empty;
+        }
+
+        bool IsEnabled(const char *Command) const
+        {
+            return "1" == Value(Command);
+        }
+
+        static int64_t HostUs()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        int64_t DeviceUs() const
+        {
+            const int64_t now = HostUs();
+
+            return now + time_offset_us_ + static_cast<int64_t>(static_cast<double>(now - time_set_us_) * options_.drift_ppm * 1e-6);
+        }
+
+        std::chrono::microseconds PingPeriod() const
+        {
+            double period_s = std::atof(Value("#interval").c_str());
+
+            if (options_.rate_hz > 0.0)
+            {
+                period_s = 1.0 / options_.rate_hz;
+            }
+
+            if (period_s <= 0.0)
+            {
+                period_s = 0.1;
+            }
+
+            return std::chrono::microseconds(static_cast<int64_t>(period_s * 1e6));
+        }
+
+        static std::string Sentence(const std::string &Body)
+        {
+            uint8_t checksum = 0;
+
+            for (std::size_t i = 1; i < Body.size(); i++)
+            {
+                checksum ^= static_cast<uint8_t>(Body[i]);
+            }
+
+            char tail[8];
+            snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+
+            return Body + tail;
+        }
+
+        std::string ChannelOutput(const char *Talker, double DepthM) const
+        {
+            char body[128];
+            std::string result;
+
+            if (false != IsEnabled("#nmeadbt"))
+            {
+                snprintf(body, sizeof(body), "$%sDBT,%.1f,f,%.2f,M,%.1f,F", Talker, DepthM * 3.28084, DepthM, DepthM * 0.546807);
+                result += Sentence(body);
+            }
+
+            if (false != IsEnabled("#nmeadpt"))
+            {
+                snprintf(body, sizeof(body), "$%sDPT,%.2f,%.1f", Talker, DepthM, std::atof(Value("#nmeadptoff").c_str()));
+                result += Sentence(body);
+            }
+
+            if (false != IsEnabled("#nmeaema"))
+            {
+                snprintf(body, sizeof(body), "$%sEMA,%.2f,%d", Talker, DepthM, 40 + static_cast<int>(ping_counter_ % 50));
+                result += Sentence(body);
+            }
+
+            return result;
+        }
+
+        void Ping()
+        {
+            ping_counter_++;
+
+            const double t = static_cast<double>(ping_counter_) * 0.05;
+            const double depth = 12.0 + 3.0 * std::sin(t);
+            const double temperature = 15.0 + 0.5 * std::sin(t * 0.1);
+
+            std::string output;
+            char body[128];
+
+            if ((false == options_.dual) || (WorkDual != work_mode_))
+            {
+                output += ChannelOutput("SD", (WorkLow == work_mode_) ? depth + 0.3 : depth);
+            }
+            else
+            {
+                output += ChannelOutput("SH", depth);
+                output += ChannelOutput("SL", depth + 0.3);
+            }
+
+            if (false != IsEnabled("#nmeamtw"))
+            {
+                snprintf(body, sizeof(body), "$SDMTW,%.1f,C", temperature);
+                output += Sentence(body);
+            }
+
+            if (false != IsEnabled("#nmeaxdr"))
+            {
+                snprintf(body, sizeof(body), "$SDXDR,A,%.1f,D,PTCH,A,%.1f,D,ROLL,C,%.1f,C,TEMP", 1.5 * std::sin(t), 0.8 * std::cos(t), temperature);
+                output += Sentence(body);
+            }
+
+            if (false != IsEnabled("#nmeazda"))
+            {
+                const int64_t us = DeviceUs();
+                const time_t seconds = static_cast<time_t>(us / 1000000LL);
+                struct tm utc;
+                gmtime_r(&seconds, &utc);
+
+                snprintf(body, sizeof(body), "$SDZDA,%02d%02d%02d.%02d,%02d,%02d,%04d,00,00",
+                         utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>((us % 1000000LL) / 10000LL),
+                         utc.tm_mday, utc.tm_mon + 1, utc.tm_year + 1900);
+                output += Sentence(body);
+            }
+
+            if ((options_.garbage > 0.0) && (std::uniform_real_distribution<double>(0.0, 1.0)(random_) < options_.garbage))
+            {
+                const std::size_t position = std::uniform_int_distribution<std::size_t>(0, output.size())(random_);
+                const std::size_t length = std::uniform_int_distribution<std::size_t>(1, 32)(random_);
+                std::string garbage;
+
+                for (std::size_t i = 0; i < length; i++)
+                {
+                    // '>' is left out, it would be taken for the command prompt
+                    char ch = static_cast<char>(std::uniform_int_distribution<int>(0x20, 0x7E)(random_));
+                    garbage.push_back(('>' == ch) ? '?' : ch);
+                }
+
+                output.insert(position, garbage);
+            }
+
+            Send(output);
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasvalue = (i + 1) < argc;
+
+        if ("--dual" == arg)
+        {
+            options.dual = true;
+        }
+        else if (("--rate" == arg) && (false != hasvalue))
+        {
+            options.rate_hz = std::atof(argv[++i]);
+        }
+        else if (("--latency" == arg) && (false != hasvalue))
+        {
+            options.latency_ms = std::atoi(argv[++i]);
+        }
+        else if (("--garbage" == arg) && (false != hasvalue))
+        {
+            options.garbage = std::atof(argv[++i]);
+        }
+        else if (("--drift" == arg) && (false != hasvalue))
+        {
+            options.drift_ppm = std::atof(argv[++i]);
+        }
+        else if (("--link" == arg) && (false != hasvalue))
+        {
+            options.link = argv[++i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if ((master_fd < 0) || (0 != grantpt(master_fd)) || (0 != unlockpt(master_fd)))
+    {
+        perror("posix_openpt");
+        return 1;
+    }
+
+    const std::string slave_path = ptsname(master_fd);
+
+    // Keep the slave side open, so the master does not see hang up between client connections,
+    // and switch it to raw mode so the line discipline does not echo or translate anything
+    const int slave_fd = open(slave_path.c_str(), O_RDWR | O_NOCTTY);
+
+    if (slave_fd < 0)
+    {
+        perror("open slave");
+        return 1;
+    }
+
+    struct termios options_tty;
+    tcgetattr(slave_fd, &options_tty);
+    cfmakeraw(&options_tty);
+    tcsetattr(slave_fd, TCSANOW, &options_tty);
+
+    if (false == options.link.empty())
+    {
+        unlink(options.link.c_str());
+
+        if (0 != symlink(slave_path.c_str(), options.link.c_str()))
+        {
+            perror("symlink");
+            return 1;
+        }
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    printf("%s\n", slave_path.c_str());
+    fflush(stdout);
+
+    Simulator simulator(master_fd, options);
+    simulator.Run();
+
+    if (false == options.link.empty())
+    {
+        unlink(options.link.c_str());
+    }
+
+    close(slave_fd);
+    close(master_fd);
+
+    return 0;
+}